@@ -0,0 +1,684 @@
+#!env python3
+# -*- coding: utf-8 -*-
+# NexStar AUX bus simulator
+# This code is under GPL 3.0 license
+#
+# Simulates the azimuth (0x10) and altitude (0x11) motor controllers and the
+# few other devices on the AUX bus of a NexStar Evolution, so that the aux,
+# pc and hc drivers in xmtel and the nexstarevo.py library can be run and
+# timed without a mount.
+#
+# Two endpoints are offered at the same time:
+#
+#  * a pseudo terminal speaking like a hand controller on its serial port:
+#    0x50 pass-through packets answered by the requested number of data
+#    bytes and '#', or native 0x3b frames as on the PC/AUX port,
+#    with the timing of a 9600 baud line;
+#  * a TCP port (2000 by default) speaking like the SkyQLink WiFi module:
+#    native 0x3b frames, every frame on the bus is sent to every client,
+#    so the commands come back as echoes before their replies.
+#
+# The command set and the reply formats follow analysis/cmds and the
+# captures in analysis/*.raw.  Units that the captures do not settle are
+# marked below.
+#
+# Example:
+#
+#   python3 auxsim.py --link /tmp/nexstar -v
+#
+# then set telserial = /tmp/nexstar (or 127.0.0.1:2000) in prefs.tel.
+#
+# A reply can be lost on purpose to test the recovery of a driver:
+#
+#   python3 auxsim.py --link /tmp/nexstar --drop 0xee:4
+#
+# answers every command except the fourth request for the limits state.
+# A reply can also be held back past the deadline of the driver:
+#
+#   python3 auxsim.py --link /tmp/nexstar --late 0x01:6
+#
+# answers the sixth position query --late-by seconds after the command,
+# and the replies behind it on the serial line wait for it.
+#
+#   python3 auxsim.py --check
+#
+# checks that the goto rate reported by MC_GET_MAXRATE is the rate at
+# which each axis slews, and exits with the number of failed checks.
+
+from __future__ import division, print_function
+
+import argparse
+import heapq
+import math
+import os
+import pty
+import selectors
+import socket
+import struct
+import sys
+import time
+import tty
+
+
+MC_AZM=0x10
+MC_ALT=0x11
+
+STEPS=2**24     # Encoder counts per turn
+
+# Move rates for MC_MOVE_POS/NEG in degrees per second.
+# The top rates are limited by the max rate of the controller.
+MOVE_RATES = {
+    0 : 0.0,
+    1 : 1/60,
+    2 : 2/60,
+    3 : 5/60,
+    4 : 15/60,
+    5 : 30/60,
+    6 : 1.0,
+    7 : 2.0,
+    8 : 5.0,
+    9 : 10.0,
+}
+
+# Preset 16-bit guide rates used by the hand controller, arcsec/s
+SIDEREAL=15.041067
+PRESET_RATES = {
+    0xffff : SIDEREAL,              # sidereal
+    0xfffe : 15.0,                  # solar
+    0xfffd : 14.685,                # lunar
+}
+
+# Fixed replies taken from the captures
+VERSION=b'\x07\x0a\x10\x0d'
+MC_0x05=b'\x16\x87'
+
+
+def checksum(msg):
+    return ((~sum([c for c in bytes(msg)]) + 1) ) & 0xFF
+
+
+def frame(src, dst, mid, data=b''):
+    body=bytes([len(data)+3, src, dst, mid])+bytes(data)
+    return b'\x3b'+body+bytes([checksum(body)])
+
+
+def unpack_int(d):
+    return int.from_bytes(bytes(d), 'big')
+
+
+def pack_int3(v):
+    return (int(v) % STEPS).to_bytes(3, 'big')
+
+
+def signed(c):
+    '''
+    Map counts to the signed range [-2**23, 2**23).
+    '''
+    c%=STEPS
+    return c-STEPS if c>=STEPS//2 else c
+
+
+class Axis:
+    '''
+    One motor controller. Position is kept in encoder counts as a float,
+    velocity in counts per second.
+    '''
+
+    def __init__(self, ident, maxrate, accel):
+        self.ident=ident
+        self.pos=0.0
+        self.vel=0.0
+        self.mode='idle'        # idle, goto, move or guide
+        self.target=0.0
+        self.slow=False
+        self.move_rate=0.0      # counts/s, signed
+        self.guide_rate=0.0     # counts/s, signed
+        # MC_GET_MAXRATE returns two 16-bit values in milli-degrees per
+        # second. The captures show 3984 and 4500. The second is the goto
+        # rate that MC_SET_MAXRATE sets; the first is kept as captured.
+        self.maxrate=[3984, 4500]
+        self.maxrate_enabled=1
+        self.limit_rate=maxrate*STEPS/360
+        self.accel=accel*STEPS/360
+        self.approach=0 if ident==MC_AZM else 1
+        self.backlash=[0, 0]
+        self.cordwrap=False
+        self.cordwrap_pos=0x7fffff
+        self.limits=0
+        self.last=time.monotonic()
+
+    def top_rate(self):
+        '''
+        Fastest slew in counts/s.
+        '''
+        if self.maxrate_enabled :
+            return min(self.limit_rate, self.maxrate[1]/1000*STEPS/360)
+        return self.limit_rate
+
+    def maxrate_reply(self):
+        '''
+        MC_GET_MAXRATE reply. The second value is the goto rate the axis
+        slews at, which the mechanical limit may hold below the one set.
+        The aux driver seeds its fast slew rate from it.
+        '''
+        rate=min(round(self.top_rate()*360/STEPS*1000), 0xffff)
+        return struct.pack('!HH', self.maxrate[0], rate)
+
+    def slewing(self):
+        return self.mode=='goto'
+
+    def update(self, now):
+        '''
+        Integrate the motion up to the time now.
+        '''
+        dt=now-self.last
+        self.last=now
+        if dt<=0 :
+            return
+        if self.mode=='goto' :
+            self._goto_step(dt)
+        else :
+            want=self.move_rate if self.mode=='move' else self.guide_rate
+            self._approach_rate(want, dt)
+            self.pos=(self.pos+self.vel*dt) % STEPS
+
+    def _approach_rate(self, want, dt):
+        dv=self.accel*dt
+        if abs(want-self.vel)<=dv :
+            self.vel=want
+        else :
+            self.vel+=math.copysign(dv, want-self.vel)
+
+    def _goto_step(self, dt):
+        # Trapezoidal profile along the shorter way to the target
+        togo=signed(self.target-self.pos)
+        vmax=self.top_rate()
+        if self.slow :
+            vmax=min(vmax, MOVE_RATES[6]*STEPS/360)
+        # Fastest speed from which we can still stop at the target
+        vstop=math.sqrt(2*self.accel*abs(togo))
+        want=math.copysign(min(vmax, vstop), togo)
+        self._approach_rate(want, dt)
+        step=self.vel*dt
+        if abs(togo)<1 or (abs(step)>=abs(togo) and step*togo>0) :
+            self.pos=self.target % STEPS
+            self.vel=0.0
+            self.mode='guide'
+        else :
+            self.pos=(self.pos+step) % STEPS
+
+    def goto(self, target, slow):
+        self.target=target
+        self.slow=slow
+        self.mode='goto'
+
+    def move(self, rate, sign):
+        deg=min(MOVE_RATES.get(rate, 0.0), self.top_rate()*360/STEPS)
+        self.move_rate=sign*deg*STEPS/360
+        self.mode='move' if rate else 'guide'
+
+    def guide(self, data, sign):
+        if len(data)==2 :
+            v=unpack_int(data)
+            arcsec=PRESET_RATES.get(v, 0.0)
+        else :
+            # 24-bit guide rates in 1/1024 arcsec per second
+            arcsec=unpack_int(data[:3])/1024
+        self.guide_rate=sign*arcsec/1296000*STEPS
+        if self.mode=='idle' :
+            self.mode='guide'
+
+
+class Bus:
+    '''
+    The devices on the AUX bus and their replies.
+    '''
+
+    def __init__(self, args):
+        self.verbose=args.verbose
+        self.axes={
+            MC_AZM: Axis(MC_AZM, args.maxrate, args.accel),
+            MC_ALT: Axis(MC_ALT, args.maxrate, args.accel),
+        }
+        self.voltage=args.voltage
+        # Replies lost on the bus, as {message id: [count of the request]}
+        self.drops={}
+        self.seen={}
+        for d in args.drop :
+            mid, _, n=d.partition(':')
+            self.drops.setdefault(int(mid, 0), []).append(int(n or '1'))
+        # Replies held back, and the delay added to the last reply
+        self.lates={}
+        for d in args.late :
+            mid, _, n=d.partition(':')
+            self.lates.setdefault(int(mid, 0), []).append(int(n or '1'))
+        self.late_by=args.late_by
+        self.delay=0.0
+
+    def update(self, now):
+        for a in self.axes.values():
+            a.update(now)
+
+    def command(self, src, dst, mid, data):
+        '''
+        Execute a command and return the reply frame or None if no device
+        answers at this address.
+        '''
+        self.update(time.monotonic())
+        self.delay=0.0
+        if dst in self.axes :
+            r=self.mc_command(self.axes[dst], mid, data)
+        else :
+            r=self.other_command(dst, mid, data)
+        if r is None :
+            return None
+        self.seen[mid]=self.seen.get(mid, 0)+1
+        if self.seen[mid] in self.drops.get(mid, []) :
+            if self.verbose :
+                print('%02x->%02x [%02x] %s -> reply dropped' % (src, dst,
+                      mid, bytes(data).hex()), file=sys.stderr)
+            return None
+        if self.seen[mid] in self.lates.get(mid, []) :
+            self.delay=self.late_by
+        if self.verbose :
+            print('%02x->%02x [%02x] %s -> %s%s' % (src, dst, mid,
+                  bytes(data).hex(), r[1].hex(),
+                  ' late' if self.delay else ''), file=sys.stderr)
+        rmid, rdata=r
+        return frame(dst, src, rmid, rdata)
+
+    def mc_command(self, ax, mid, data):
+        if mid==0x01 :
+            return mid, pack_int3(round(ax.pos))
+        elif mid==0x02 or mid==0x17 :
+            ax.goto(unpack_int(data[:3]), mid==0x17)
+        elif mid==0x04 :
+            ax.pos=float(unpack_int(data[:3]))
+            ax.vel=0.0
+            ax.mode='guide'
+        elif mid==0x05 :
+            return mid, MC_0x05
+        elif mid==0x06 :
+            ax.guide(data, +1)
+        elif mid==0x07 :
+            ax.guide(data, -1)
+        elif mid==0x0b :
+            pass
+        elif mid==0x10 or mid==0x11 :
+            ax.backlash[mid-0x10]=unpack_int(data[:1])
+        elif mid==0x13 :
+            return mid, b'\x00' if ax.slewing() else b'\xff'
+        elif mid==0x18 :
+            return mid, b'\x00'
+        elif mid==0x19 :
+            pass
+        elif mid==0x20 :
+            ax.maxrate[1]=unpack_int(data[:2])
+        elif mid==0x21 :
+            return mid, ax.maxrate_reply()
+        elif mid==0x22 :
+            ax.maxrate_enabled=unpack_int(data[:1])
+        elif mid==0x23 :
+            return mid, bytes([ax.maxrate_enabled])
+        elif mid==0x24 :
+            ax.move(unpack_int(data[:1]), +1)
+        elif mid==0x25 :
+            ax.move(unpack_int(data[:1]), -1)
+        elif mid==0x38 :
+            ax.cordwrap=True
+        elif mid==0x39 :
+            ax.cordwrap=False
+        elif mid==0x3a :
+            ax.cordwrap_pos=unpack_int(data[:3])
+        elif mid==0x3b :
+            return mid, b'\xff' if ax.cordwrap else b'\x00'
+        elif mid==0x3c :
+            return mid, pack_int3(ax.cordwrap_pos)
+        elif mid==0x40 or mid==0x41 :
+            return mid, bytes([ax.backlash[mid-0x40]])
+        elif mid==0xee :
+            return mid, bytes([ax.limits])
+        elif mid==0xef :
+            ax.limits=unpack_int(data[:1])
+        elif mid==0xfc :
+            return mid, bytes([ax.approach])
+        elif mid==0xfd :
+            ax.approach=unpack_int(data[:1])
+        elif mid==0xfe :
+            return mid, VERSION
+        else :
+            # Unsupported commands are refused with 0xf0 and the command id
+            return 0xf0, bytes([mid])
+        return mid, b''
+
+    def other_command(self, dst, mid, data):
+        if dst==0xb6 :
+            if mid==0x10 :
+                return mid, b'\x02\x02'+struct.pack('!i', int(self.voltage*1e6))
+            if mid==0x18 :
+                return mid, bytes(data[:2]) if data else b'\x07\xd0'
+        elif dst==0xb7 or dst==0xbf :
+            if mid==0x10 :
+                return mid, bytes(data[-1:]) if data else b'\x00'
+        elif dst in (0xb0, 0xb4, 0xb5) :
+            if mid==0xfe :
+                return mid, VERSION
+        return None
+
+
+class Link:
+    '''
+    One endpoint with its own timing. Output is released through a heap of
+    (time, link, bytes) events kept by the simulator.
+    '''
+
+    def __init__(self, sim, fd, name, baud=None, latency=0.0):
+        self.sim=sim
+        self.fd=fd
+        self.name=name
+        self.baud=baud
+        self.latency=latency
+        self.busy=0.0           # Time the outgoing line is free again
+        self.buf=b''
+
+    def line_time(self, n):
+        return 10*n/self.baud if self.baud else 0.0
+
+    def send(self, data, t):
+        start=max(t, self.busy)
+        self.busy=start+self.line_time(len(data))
+        self.sim.schedule(self.busy, self, data)
+
+    def write(self, data):
+        try :
+            os.write(self.fd, data)
+        except OSError :
+            pass
+
+
+class SerialLink(Link):
+    '''
+    Hand controller serial port or PC/AUX port on a pseudo terminal.
+    '''
+
+    def feed(self, data, now):
+        self.buf+=data
+        while self.buf :
+            b=self.buf
+            if b[0]==0x50 :
+                if len(b)<8 :
+                    break
+                pkt, self.buf=b[:8], b[8:]
+                self.passthrough(pkt, now)
+            elif b[0]==0x3b :
+                if len(b)<2 or len(b)<b[1]+3 :
+                    break
+                n=b[1]+3
+                f, self.buf=b[:n], b[n:]
+                self.native(f, now)
+            else :
+                self.buf=b[1:]
+
+    def passthrough(self, pkt, now):
+        n, dst, mid=pkt[1], pkt[2], pkt[3]
+        data=pkt[4:4+n-1]
+        nreply=pkt[7]
+        # The command reaches the hand controller, which relays it on the
+        # bus and waits for the reply before answering
+        t=now+self.line_time(len(pkt))+self.latency
+        r=self.sim.bus.command(0x0d, dst, mid, data)
+        if r is None :
+            return
+        self.sim.broadcast(frame(0x0d, dst, mid, data), self)
+        self.sim.broadcast(r, self)
+        reply=r[5:-1][:nreply].ljust(nreply, b'\x00')
+        self.send(reply+b'#', t+self.sim.bus.delay)
+
+    def native(self, f, now):
+        if checksum(f[1:-1])!=f[-1] :
+            return
+        src, dst, mid, data=f[2], f[3], f[4], f[5:-1]
+        t=now+self.line_time(len(f))
+        # The bus echoes what we sent
+        self.send(f, t)
+        r=self.sim.bus.command(src, dst, mid, data)
+        self.sim.broadcast(f, self)
+        if r is not None :
+            self.send(r, t+self.latency+self.sim.bus.delay)
+            self.sim.broadcast(r, self, t+self.latency+self.sim.bus.delay)
+
+
+class NetLink(Link):
+    '''
+    Client of the WiFi module on TCP.
+    '''
+
+    def feed(self, data, now):
+        self.buf+=data
+        while self.buf :
+            b=self.buf
+            if b.startswith(b'$$$') :
+                self.buf=b[3:]
+                self.send(b'CMD\r\n', now)
+            elif b.startswith(b'exit\r') :
+                self.buf=b[b.find(b'\r')+1:].lstrip(b'\n')
+                self.send(b'EXIT\r\n', now)
+            elif b[0]==0x3b :
+                if len(b)<2 or len(b)<b[1]+3 :
+                    break
+                n=b[1]+3
+                f, self.buf=b[:n], b[n:]
+                self.native(f, now)
+            elif b'$$$'.startswith(b[:3]) or b'exit\r'.startswith(b[:5]) :
+                break
+            else :
+                self.buf=b[1:]
+
+    def native(self, f, now):
+        if checksum(f[1:-1])!=f[-1] :
+            return
+        src, dst, mid, data=f[2], f[3], f[4], f[5:-1]
+        r=self.sim.bus.command(src, dst, mid, data)
+        self.sim.broadcast(f, None, now)
+        if r is not None :
+            self.sim.broadcast(r, None, now+self.latency+self.sim.bus.delay)
+
+    def write(self, data):
+        try :
+            self.fd.sendall(data)
+        except OSError :
+            self.sim.drop(self)
+
+
+class Simulator:
+
+    def __init__(self, args):
+        self.args=args
+        self.bus=Bus(args)
+        self.sel=selectors.DefaultSelector()
+        self.events=[]
+        self.seq=0
+        self.links=[]
+        self.net=[]
+
+    def schedule(self, t, link, data):
+        self.seq+=1
+        heapq.heappush(self.events, (t, self.seq, link, data))
+
+    def broadcast(self, data, origin, t=None):
+        '''
+        Copy bus traffic to every TCP client except the origin.
+        '''
+        if t is None :
+            t=time.monotonic()
+        for l in self.net :
+            if l is not origin :
+                l.send(data, t)
+
+    def drop(self, link):
+        if link in self.net :
+            self.net.remove(link)
+            try :
+                self.sel.unregister(link.fd)
+            except (KeyError, ValueError) :
+                pass
+            link.fd.close()
+            if self.args.verbose :
+                print('Client %s disconnected' % link.name, file=sys.stderr)
+
+    def open_pty(self):
+        m, s=pty.openpty()
+        tty.setraw(s)
+        name=os.ttyname(s)
+        self.slave=s
+        if self.args.link :
+            try :
+                os.unlink(self.args.link)
+            except OSError :
+                pass
+            os.symlink(name, self.args.link)
+            name='%s -> %s' % (self.args.link, name)
+        l=SerialLink(self, m, name, self.args.baud, self.args.latency)
+        self.links.append(l)
+        self.sel.register(m, selectors.EVENT_READ, l)
+        print('Serial port: %s' % name, file=sys.stderr)
+
+    def open_tcp(self):
+        s=socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        s.bind((self.args.host, self.args.port))
+        s.listen(4)
+        s.setblocking(False)
+        self.sel.register(s, selectors.EVENT_READ, None)
+        print('AUX over TCP: %s:%d' % (self.args.host, self.args.port),
+              file=sys.stderr)
+
+    def accept(self, srv):
+        c, addr=srv.accept()
+        c.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        l=NetLink(self, c, '%s:%d' % addr[:2], None, self.args.net_latency)
+        self.net.append(l)
+        self.sel.register(c, selectors.EVENT_READ, l)
+        if self.args.verbose :
+            print('Client %s connected' % l.name, file=sys.stderr)
+
+    def run(self):
+        if not self.args.no_pty :
+            self.open_pty()
+        if self.args.port :
+            self.open_tcp()
+        tick=0.01
+        while True :
+            now=time.monotonic()
+            while self.events and self.events[0][0]<=now :
+                _, _, link, data=heapq.heappop(self.events)
+                link.write(data)
+            wait=tick
+            if self.events :
+                wait=min(wait, max(0.0, self.events[0][0]-now))
+            for key, _ in self.sel.select(wait) :
+                if key.data is None :
+                    self.accept(key.fileobj)
+                    continue
+                link=key.data
+                try :
+                    if isinstance(link, NetLink) :
+                        d=link.fd.recv(4096)
+                    else :
+                        d=os.read(link.fd, 4096)
+                except OSError :
+                    d=b''
+                if not d :
+                    if isinstance(link, NetLink) :
+                        self.drop(link)
+                    continue
+                link.feed(d, time.monotonic())
+            self.bus.update(time.monotonic())
+
+
+def check(args):
+    '''
+    Check that the fast goto rate read from MC_GET_MAXRATE, as the aux
+    driver reads it, is the rate at which each axis slews a quarter turn.
+    Returns the number of failed checks.
+    '''
+    cases=(
+        ('default', []),
+        ('max rate set to 3000', [(0x20, b'\x0b\xb8')]),
+        ('max rate disabled', [(0x22, b'\x00')]),
+    )
+    failed=0
+    for name, setup in cases :
+        bus=Bus(args)
+        for ident, ax in sorted(bus.axes.items()) :
+            for mid, data in setup :
+                bus.mc_command(ax, mid, data)
+            seeded=unpack_int(bus.mc_command(ax, 0x21, b'')[1][2:4])/1000
+            t=ax.last
+            bus.mc_command(ax, 0x02, pack_int3(ax.pos+STEPS//4))
+            top=0.0
+            while ax.slewing() :
+                t+=0.01
+                ax.update(t)
+                top=max(top, abs(ax.vel)*360/STEPS)
+            ok=abs(top-seeded)<0.001
+            failed+=not ok
+            print('%-24s axis %02x  seeded %7.3f  slews %7.3f deg/s  %s' %
+                  (name, ident, seeded, top, 'ok' if ok else 'FAILED'))
+    return failed
+
+
+def main():
+    p=argparse.ArgumentParser(description='NexStar AUX bus simulator')
+    p.add_argument('--host', default='127.0.0.1',
+                   help='address for the TCP endpoint')
+    p.add_argument('--port', type=int, default=2000,
+                   help='TCP port, 0 to disable (default 2000)')
+    p.add_argument('--no-pty', action='store_true',
+                   help='do not open the serial endpoint')
+    p.add_argument('--link', default=None,
+                   help='symlink to create for the pseudo terminal')
+    p.add_argument('--baud', type=int, default=9600,
+                   help='serial line speed (default 9600)')
+    p.add_argument('--latency', type=float, default=0.02,
+                   help='hand controller and motor reply latency in s')
+    p.add_argument('--net-latency', type=float, default=0.005,
+                   help='WiFi module reply latency in s')
+    p.add_argument('--maxrate', type=float, default=4.0,
+                   help='mechanical slew limit in deg/s')
+    p.add_argument('--accel', type=float, default=2.0,
+                   help='acceleration in deg/s^2')
+    p.add_argument('--voltage', type=float, default=12.4,
+                   help='battery voltage reported')
+    p.add_argument('--drop', action='append', default=[],
+                   metavar='MID[:N]',
+                   help='lose the reply to the Nth command with this '
+                   'message id (first by default), may be repeated')
+    p.add_argument('--late', action='append', default=[],
+                   metavar='MID[:N]',
+                   help='hold back the reply to the Nth command with this '
+                   'message id (first by default), may be repeated')
+    p.add_argument('--late-by', type=float, default=3.0,
+                   help='delay of a held back reply in s (default 3)')
+    p.add_argument('-v', '--verbose', action='store_true')
+    p.add_argument('--check', action='store_true',
+                   help='check the reported goto rate against the slew '
+                   'and exit')
+    args=p.parse_args()
+    if args.check :
+        sys.exit(check(args))
+    sim=Simulator(args)
+    try :
+        sim.run()
+    except KeyboardInterrupt :
+        pass
+    finally :
+        if args.link :
+            try :
+                os.unlink(args.link)
+            except OSError :
+                pass
+
+
+if __name__ == '__main__':
+    main()
@@ -298,7 +298,7 @@ class NexStarScope:
     '''
     #TODO: Describe the API
     
-    def __init__(self, addr=None, port=2000, verbose=False):
+    def __init__(self, addr=None, port=2000, verbose=False, listen=True):
         if addr is None:
             self.ip, self.port = detect_scope(verbose)
         else :
@@ -309,6 +309,12 @@ class NexStarScope:
         self.startup=True
         self.me=targets['APP']
         self.verb=verbose
+        # Passive listening: the mainboard repeats all AUX traffic on every
+        # port, so replies to the HC or another app update our state too.
+        self.listen=listen
+        self.heard=0
+        self.pos_time={MC_ALT:0.0, MC_AZM:0.0}
+        self.slew_time={MC_ALT:0.0, MC_AZM:0.0}
         self.connected=False
         self.slew_azm=False
         self.slew_alt=False
@@ -326,6 +332,11 @@ class NexStarScope:
             0x01 : NexStarScope.get_position,
             0x13 : NexStarScope.slew_done,
         }
+        # Commands to the motors seen on the bus, ours or anyone else's
+        self._mc_cmd_handlers = {
+            0x02 : NexStarScope.goto_started,
+            0x17 : NexStarScope.goto_started,
+        }
         self.handlers = {
             MC_ALT : self._mc_handlers,
             MC_AZM : self._mc_handlers,
@@ -380,14 +391,33 @@ class NexStarScope:
             self.alt = unpack_int3(data)
         if src == MC_AZM :
             self.azm = unpack_int3(data)
+        self.pos_time[src]=time.monotonic()
+        if dst!=self.me :
+            self.heard+=1
         self.dbg(repr_pos(self.alt, self.azm))
         
         
     def slew_done(self, data, src, dst):
+        if len(data)<1 : return
         if src == MC_ALT :
             self.slew_alt = data==b'\x00'
         if src == MC_AZM :
             self.slew_azm = data==b'\x00'
+        self.slew_time[src]=time.monotonic()
+
+
+    def goto_started(self, data, src, dst):
+        if dst == MC_ALT :
+            self.slew_alt = True
+        if dst == MC_AZM :
+            self.slew_azm = True
+
+
+    def fresh(self, stamps, ax, age):
+        '''
+        True if the axis state was heard on the bus within age seconds.
+        '''
+        return time.monotonic() - stamps[targets[ax]] < age
 
 
     def get_voltage(self, data, src, dst):
@@ -611,11 +641,13 @@ class NexStarScope:
                 await self.queue_cmd(dst='BAT', cmd='GET_VOLTAGE')
                 k = 15
             else : k-=1
+            # Skip the polls another controller has just made for us
             for trg in 'ALT', 'AZM' :
-                await self.queue_cmd(dst=trg, cmd='MC_GET_POSITION')
-            if self.slew_alt:
+                if not self.fresh(self.pos_time, trg, sleep/2):
+                    await self.queue_cmd(dst=trg, cmd='MC_GET_POSITION')
+            if self.slew_alt and not self.fresh(self.slew_time, 'ALT', sleep/2):
                 await self.queue_cmd(dst='ALT', cmd='MC_SLEW_DONE')
-            if self.slew_azm:
+            if self.slew_azm and not self.fresh(self.slew_time, 'AZM', sleep/2):
                 await self.queue_cmd(dst='AZM', cmd='MC_SLEW_DONE')
             await asyncio.sleep(sleep)
             
@@ -669,14 +701,24 @@ class NexStarScope:
     def handle_msg(self,msg):
         s,d,mid,dat=parse_msg(msg)
         trg=s if d in ctrlid else d
-        if  d!=self.me:
-            # Ignore this is just an echo
-            self.dbg('I',end='')
-        else :
+        if d==self.me :
             try :
                 return self.handlers[trg][mid](self,dat,s,d)
             except KeyError :
                 self.dbg('No handler for:', print_command(msg))
+        elif not self.listen :
+            # Ignore this is just an echo
+            self.dbg('I',end='')
+        elif s in (MC_ALT, MC_AZM) :
+            # A motor answering someone else
+            handler=self._mc_handlers.get(mid)
+            if handler is not None :
+                return handler(self,dat,s,d)
+        elif d in (MC_ALT, MC_AZM) :
+            # A command to a motor, our echo or another controller's
+            handler=self._mc_cmd_handlers.get(mid)
+            if handler is not None :
+                return handler(self,dat,s,d)
 
 
     async def goto(self, alt, azm, fast=True, wait=True):
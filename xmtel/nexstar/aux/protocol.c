@@ -8,8 +8,8 @@
 /*                                                                            */
 /* John Kielkopf (kielkopf@louisville.edu)                                    */
 /*                                                                            */
-/* Date: July 1, 2012                                                         */
-/* Version: 6.0                                                               */
+/* Date: October 16, 2026                                                     */
+/* Version: 6.1                                                               */
 /*                                                                            */
 /* History:                                                                   */
 /*                                                                            */
@@ -83,6 +83,29 @@
 /*   Version 6.0                                                              */
 /*     Updated version to match xmtel                                         */
 /*     Leapsecond incremented in protocol.h                                   */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 6.1                                                              */
+/*     Request engine keeps several AUX commands in flight                    */
+/*     Both drives are commanded and queried without waiting on each other    */
+/*     GetTel reads both encoders in one round trip as a single sample        */
+/*     Persistent receive buffer with a resynchronizing AUX framer            */
+/*     Serial input is no longer flushed before each command                  */
+/*     Link waits use the shared epoll transport with microsecond deadlines   */
+/*     Native AUX frames over TCP to a SkyQLink or Evolution WiFi module      */
+/*     Round trip histograms and link statistics written on SIGUSR1           */
+/*     Track and limit commands return at once and complete from the loop     */
+/*     Positions and slew states heard on a native link spare our own polls   */
+/*     Encoder samples carry a time context used through the pointing model   */
+/*     GoToCoords refuses targets below the horizon mask                      */
+/*     Encoder to mount coordinate mapping separated from GetTel and GoTo     */
+/*     Encoder counts kept as exact fixed-point angles mapped from a table    */
+/*     Alt-az mounts track on both axes with streamed guide rates             */
+/*     Gotos lead the target by a slew time model refined from each slew      */
+/*     Two phase gotos with a slow final approach that settle on the encoders */
+/*     Satellite passes from two-line elements tracked with a PID rate loop   */
+/*     GEM slews take the side of the pier and route with the shortest        */
+/*       predicted time that is safe, and stop on the way only when needed    */
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -94,12 +117,20 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/timerfd.h>
 #include <fcntl.h>
 #include <termios.h>
 #include <math.h>
+#include <signal.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include "protocol.h"
-
-#define NULL_PTR(x) (x *)0
+#include "transport.h"
+#include "algorithms.h"
+#include "satellite.h"
 
 #ifndef TRUE
 #define TRUE 1
@@ -135,6 +166,7 @@ void StartTrack(void);
 void CenterGuide(double centerra, double centerdec, 
   int raflag, int decflag, int pmodel);
 void StopTrack(void);
+int  TrackSatellite(char *line1, char *line2);
 void FullStop(void);
 
 /* Coordinates */
@@ -142,6 +174,10 @@ void FullStop(void);
 void GetTel(double *telra, double *teldec, int pmodel);
 int  GoToCoords(double newRA, double newDec, int pmodel);
 int  CheckGoTo(double desRA, double desDec, int pmodel);
+int  EncoderToEquatorial(auxangle encoderaz, auxangle encoderalt, 
+  double *telha0, double *teldec0);
+int  EquatorialToEncoder(double telha0, double teldec0, 
+  auxangle *encoderaz, auxangle *encoderalt);
 
 /* Slew limits */
 
@@ -196,15 +232,100 @@ extern void HorizontalToEquatorial(double az, double alt, double *ha, double *de
 
 static int slewRate;                  /* Rate for slew request in StartSlew */
 static int slewphase = 0;             /* Slew sequence counter */
-static double telencoderalt = 0.;     /* Global encoder angle updated by GetTel */
-static double telencoderaz = 0.;      /* Global encoder angle updated by GetTel */
-static double switchalt = 0.;         /* Global encoder angle of switch position */
-static double switchaz = 0.;          /* Global encoder angle of switch position */
+static auxangle telencoderalt = 0;   /* Global encoder angle updated by GetTel */
+static auxangle telencoderaz = 0;    /* Global encoder angle updated by GetTel */
+static auxangle switchalt = 0;       /* Global encoder angle of switch position */
+static auxangle switchaz = 0;        /* Global encoder angle of switch position */
+
+/* Alt-az tracking engine */
+
+static int trackfd = -1;             /* Timer for rate updates or -1 */
+static int tracking = FALSE;         /* Guide rates are being streamed */
+static int tracktarget = FALSE;      /* A goto has set the next target */
+static int trackpmodel = RAW;        /* Pointing model of the last goto */
+static double trackra = 0.;          /* Target ra in hours */
+static double trackdec = 0.;         /* Target dec in degrees */
+static double trackrate[2];          /* Last azimuth and altitude rates sent */
+static int tracksatellite = FALSE;   /* The rates follow a satellite pass */
+static satpass satellitepass;        /* Pass in mount azimuth and altitude */
+static double satstart = 0.;         /* Time in utc seconds the pass is joined */
+static double saterrorutc = 0.;      /* Time of the last error or 0 */
+static double saterror[2];           /* Last azimuth and altitude errors */
+static double satintegral[2];        /* Integrated errors in arcsec s */
+
+static void TrackStart(void);
+static void TrackStop(void);
+static int  TrackTimer(double hz);
+static void TrackTick(int fd, void *arg);
+static void TrackUpdate(void);
+static void TrackRate(int dest, double rate);
+static void SatelliteUpdate(void);
+
+/* Slew time model for each kind of goto and axis */
+
+typedef struct
+{
+  double rate;                /* Top rate in deg/s */
+  double accel;               /* Acceleration in deg/s^2 */
+  double latency;             /* Seconds added to every slew */
+  double sw, sd, st;          /* Decayed sums of weight, distance and time */
+  double sdd, sdt;            /*   over measured slews that reached the rate */
+} auxslew;
+
+static auxslew auxslews[2][2];       /* Slow and fast gotos on both axes */
+static int slewkind = 0;             /* Kind of the goto in progress */
+static double slewdistance[2];       /* Degrees to go on each axis or 0 */
+static struct timeval slewstart;     /* Time the goto was sent */
+static struct timeval slewseen[2];   /* Last time each axis was slewing */
+static int slewapproach[2] = {1, 1}; /* Direction of the final approach */
+static auxangle slewsettled[2];      /* Encoder angles of the last sample */
+static double slewsettleutc = 0.;    /* Time of that sample or 0 */
+static int slewcordwrap = FALSE;     /* Azimuth drive keeps off its cord wrap */
+static auxangle slewcordpos = 0;     /* Encoder angle of the cord wrap */
+
+static void SlewModelReset(void);
+static double SlewTime(int kind, int axis, double distance);
+static void SlewStarted(int kind, auxangle encoderaz, auxangle encoderalt);
+static void SlewPolled(int axis, int slewing);
+static void SlewLearn(int kind, int axis, double distance, double seconds);
+static double SlewTravel(int axis, auxangle from, auxangle to);
+static double SlewCovered(int kind, int axis, double distance, double t);
+static double SlewPlan(auxangle *from, auxangle *target, auxangle *leg,
+  int *kind);
+static double SlewPlanGem(auxangle *target, auxangle *leg, int *kind,
+  int *detour);
+static int SlewReachable(auxangle *target);
+static int SlewSafe(int kind, auxangle *from, auxangle *to);
+static void SlewSend(int kind, auxangle encoderaz, auxangle encoderalt);
+static int SlewSettled(void);
+
+/* Fixed-point encoder angles */
+
+#define AUXHALFTURN    (AUXTURN/2)
+#define AUXQUARTERTURN (AUXTURN/4)
+
+/* Encoder zero points and sense for each mounting indexed by telmount */
+
+typedef struct
+{
+  auxangle ha0;               /* Hour angle at zero counts */
+  auxangle dec0;              /* Declination at zero counts */
+  int equatorial;             /* TRUE for polar and declination axes */
+  int pierflip;               /* TRUE if the OTA may be either side of the pier */
+} auxmount;
 
-/* NexStar calibration data */
+static auxmount auxmounts[] =
+{
+  { 0, 0, FALSE, FALSE },                            /* ALTAZ */
+  { 0, 0, TRUE, FALSE },                             /* EQFORK */
+  { -AUXQUARTERTURN, AUXQUARTERTURN, TRUE, TRUE }    /* GEM */
+};
 
-static double altcountperdeg = ALTCOUNTPERDEG;
-static double azcountperdeg  = AZCOUNTPERDEG;
+static auxangle AuxWrap(int count);
+static auxangle AuxDegrees(double degrees);
+static auxangle AuxHours(double hours);
+static auxangle AuxUnpack(unsigned char *data);
+static void AuxPack(auxangle angle, char *data);
 
 
 /* Files */
@@ -224,11 +345,134 @@ char *rotatefile;
 static int TelPortFD;
 static int TelConnectFlag = FALSE;
 
-typedef fd_set telfds;
 
-static int readn(int fd, char *ptr, int nbytes, int sec);
-static int writen(int fd, char *ptr, int nbytes);
-static int telstat(int fd,int sec,int usec);
+/* AUX request engine                                                        */
+/*                                                                           */
+/* Commands are submitted to a small table of requests in flight and the     */
+/* replies are collected as they arrive.  A request is complete when its     */
+/* reply has been matched by destination and message id, or failed when its  */
+/* deadline passes.  The caller may wait on the status or be called back.    */
+/*                                                                           */
+/* A request that fails at its deadline keeps its slot for a while longer    */
+/* so that a late reply is recognized and consumed instead of being taken    */
+/* as the reply to the next request.  Pass-through replies are known only by */
+/* their order, so there a failure retires every request in flight, and no   */
+/* new command is sent until the line has been quiet for the held slots.     */
+
+#define AUXPENDING  1         /* Request sent and waiting for a reply */
+#define AUXDONE     0         /* Reply received */
+#define AUXFAILED  -1         /* No valid reply before the deadline */
+
+/* Statistics for one destination and message id */
+
+typedef struct auxstat
+{
+  int dest;                   /* AUX destination id */
+  int msgid;                  /* AUX message id */
+  unsigned long sent;         /* Commands sent */
+  unsigned long replies;      /* Replies received in time */
+  unsigned long timeouts;     /* Deadlines missed */
+  unsigned long late;         /* Replies received after the deadline */
+  unsigned long shortreplies; /* Native replies with fewer bytes than asked */
+  unsigned long txbytes;      /* Bytes of commands on the wire */
+  unsigned long rxbytes;      /* Bytes of replies on the wire */
+  long minrtt;                /* Shortest round trip in microseconds */
+  long maxrtt;                /* Longest round trip in microseconds */
+  double sumrtt;              /* Sum of round trips for the mean */
+  unsigned int hist[AUXHISTBUCKETS];  /* Round trip histogram */
+} auxstat;
+
+typedef struct auxrequest
+{
+  int inuse;                  /* Slot is occupied */
+  int expired;                /* Failed and waiting only for a late reply */
+  int dest;                   /* AUX destination id */
+  int msgid;                  /* AUX message id */
+  int nreply;                 /* Number of data bytes expected in the reply */
+  char *reply;                /* Caller buffer for the reply data or NULL */
+  int *status;                /* Caller status flag or NULL */
+  unsigned long seq;          /* Submission order */
+  struct timeval deadline;    /* Time by which the reply must arrive */
+  struct timeval sent;        /* Time the command was written or zero */
+  auxstat *stat;              /* Statistics for this command */
+  void (*done)(struct auxrequest *req, char *data, int ndata);
+  void *arg;                  /* Caller data for the completion callback */
+} auxrequest;
+
+typedef void (*auxcallback)(auxrequest *req, char *data, int ndata);
+
+static auxrequest auxtable[AUXWINDOW];  /* Requests in flight */
+static int auxpending = 0;              /* Number of requests in flight */
+static unsigned long auxseq = 0;        /* Submission counter */
+static int auxnative = FALSE;           /* Link carries native AUX frames */
+static unsigned char auxtx[256];        /* Commands waiting to be written */
+static int auxntx = 0;                  /* Number of bytes in auxtx */
+static unsigned char auxrx[4096];       /* Received bytes */
+static int auxfirst = 0;                /* First byte in auxrx not yet framed */
+static int auxnrx = 0;                  /* Number of bytes not yet framed */
+static int auxskipped = 0;              /* Bytes discarded while resyncing */
+
+/* Drive state heard on the link from any controller's traffic */
+
+typedef struct auxaxis
+{
+  auxangle position;          /* Last encoder angle reported */
+  struct timeval positiontime;  /* Time it was read or zero */
+  int slewing;                /* Last slew state reported or commanded */
+  struct timeval slewtime;    /* Time it was read or zero */
+} auxaxis;
+
+static auxaxis auxheard[2];             /* Azimuth and altitude drives */
+static unsigned long auxharvested = 0;  /* Replies to others put to use */
+static unsigned long auxspared = 0;     /* Queries answered from auxheard */
+
+/* Moment of the encoder sample behind the last GetTel */
+
+static timecontext telsample;
+
+/* Link statistics since ConnectTel */
+
+static auxstat auxstats[AUXSTATMAX];    /* Per command statistics */
+static int auxnstats = 0;               /* Entries used in auxstats */
+static struct timeval auxconnected;     /* Time of connection */
+static struct timeval auxreadtime;      /* Time of the last read */
+static double auxblocked = 0.;          /* Seconds callers waited on replies */
+static unsigned long auxtxbytes = 0;    /* Bytes written */
+static unsigned long auxrxbytes = 0;    /* Bytes read */
+static unsigned long auxwrites = 0;     /* Writes to the link */
+static unsigned long auxreads = 0;      /* Reads from the link */
+static unsigned long auxwritefail = 0;  /* Writes that failed */
+static unsigned long auxdropped = 0;    /* Bytes dropped by the framer */
+static unsigned long auxforeign = 0;    /* Frames between other devices */
+static unsigned long auxunmatched = 0;  /* Replies to us with no request */
+static volatile sig_atomic_t auxstatsrequest = 0;  /* Set by SIGUSR1 */
+
+static int  AuxSubmit(int dest, int msgid, char *data, int ndata,
+  char *reply, int nreply, int *status, auxcallback done, void *arg);
+static int  AuxPump(long usec);
+static void AuxFlush(void);
+static void AuxClose(void);
+static int  AuxOpenNetwork(char *address);
+static void AuxFrame(void);
+static void AuxInput(int fd, void *arg);
+static void AuxWait(int *status);
+static void AuxDrain(void);
+static int  AuxCommand(int dest, int msgid, char *data, int ndata,
+  char *reply, int nreply);
+static int  AuxSend(int dest, int msgid, char *data, int ndata, char *what);
+static void AuxAcknowledged(auxrequest *req, char *data, int ndata);
+static void AuxObserve(int src, int dst, int msgid, unsigned char *data,
+  int ndata);
+static int  AuxHeard(struct timeval *when);
+static int  AuxGetPosition(auxangle *encoderaz, auxangle *encoderalt,
+  timecontext *sample);
+static auxstat *AuxStat(int dest, int msgid);
+static void AuxStatRecord(auxstat *stat, long rtt);
+static long AuxStatPercentile(auxstat *stat, double fraction);
+static void AuxStatsReset(void);
+static void AuxStatsWrite(FILE *fp);
+static void AuxStatsSave(void);
+static void AuxStatsSignal(int sig);
 
 /* End of prototype and variable definitions */
 
@@ -272,25 +516,11 @@ void ConnectTel(void)
 {  
   struct termios tty;
   
-  /* Packet to request version of azimuth motor driver */
-  
-  char sendstr[] = { 0x50, 0x01, 0x10, 0xfe, 0x00, 0x00, 0x00, 0x02 };
-      
-  /* Packet format:              */
-  /*   preamble                  */
-  /*   packet length             */
-  /*   destination               */
-  /*   message id                */
-  /*   three message bytes       */
-  /*   number of response bytes  */
-   
-  char returnstr[32];
+  /* Replies to the request for the version of each motor driver */
   
-  /* Packet format:              */
-  /*   response bytes if any     */
-  /*   #                         */
+  char azversion[2], altversion[2];
+  int azstatus, altstatus;
   
-  int numRead;
   int limits, flag;
   
   if(TelConnectFlag != FALSE)
@@ -302,75 +532,97 @@ void ConnectTel(void)
   
   /* TelPortFD = open("/dev/ttyS0",O_RDWR); */
   
-  TelPortFD = open(telserial,O_RDWR);
-  if(TelPortFD == -1)
+  if (telserial[0] != '/')
   {
-    fprintf(stderr,"Serial port not available ... \n");
-    return;
+  
+    /* Native AUX frames to a WiFi module on the network */
+    
+    TelPortFD = AuxOpenNetwork(telserial);
+    if(TelPortFD == -1)
+    {
+      fprintf(stderr,"Network link %s not available ... \n", telserial);
+      return;
+    }
+    auxnative = TRUE;
+  }
+  else
+  {
+  
+    /* Hand controller pass-through on a serial port */
+    
+    TelPortFD = open(telserial,O_RDWR);
+    if(TelPortFD == -1)
+    {
+      fprintf(stderr,"Serial port not available ... \n");
+      return;
+    }
+  
+    tcgetattr(TelPortFD,&tty);
+    cfsetospeed(&tty, (speed_t) B9600);
+    cfsetispeed(&tty, (speed_t) B9600);
+    tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;
+    tty.c_iflag =  IGNBRK;
+    tty.c_lflag = 0;
+    tty.c_oflag = 0;
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 5;
+    tty.c_iflag &= ~(IXON|IXOFF|IXANY);
+    tty.c_cflag &= ~(PARENB | PARODD);
+    tcsetattr(TelPortFD, TCSANOW, &tty);
+
+    /* Start with an empty line */
+
+    tcflush(TelPortFD,TCIOFLUSH);
+    auxnative = FALSE;
   }
   
-  tcgetattr(TelPortFD,&tty);
-  cfsetospeed(&tty, (speed_t) B9600);
-  cfsetispeed(&tty, (speed_t) B9600);
-  tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;
-  tty.c_iflag =  IGNBRK;
-  tty.c_lflag = 0;
-  tty.c_oflag = 0;
-  tty.c_cflag |= CLOCAL | CREAD;
-  tty.c_cc[VMIN] = 1;
-  tty.c_cc[VTIME] = 5;
-  tty.c_iflag &= ~(IXON|IXOFF|IXANY);
-  tty.c_cflag &= ~(PARENB | PARODD);
-  tcsetattr(TelPortFD, TCSANOW, &tty);
+  auxntx = 0;
+  auxfirst = 0;
+  auxnrx = 0;
+  auxskipped = 0;
+  memset(auxheard, 0, sizeof(auxheard));
+  AuxStatsReset();
+
+  /* Link statistics are saved on request with SIGUSR1 */
 
-  /* Flush the input (read) buffer */
+  signal(SIGUSR1, AuxStatsSignal);
 
-  tcflush(TelPortFD,TCIOFLUSH);
+  /* Traffic that arrives between commands is framed from the event loop */
 
-  /* Test connection by asking for version of azimuth motor */
+  TransportWatch(TelPortFD, AuxInput, NULL);
 
-  writen(TelPortFD,sendstr,8);
-  numRead=readn(TelPortFD,returnstr,3,2);
+  /* Test connection by asking for the version of both motors at once */
+
+  AuxSubmit(AUXAZM, 0xfe, NULL, 0, azversion, 2, &azstatus, NULL, NULL);
+  AuxSubmit(AUXALT, 0xfe, NULL, 0, altversion, 2, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
   
-  if (numRead == 3) 
+  if (azstatus == AUXDONE) 
   {
     fprintf(stderr,"RA/Azimuth ");
-    fprintf(stderr,"controller version %d.%d ", returnstr[0], returnstr[1]);
+    fprintf(stderr,"controller version %d.%d ", azversion[0], azversion[1]);
     fprintf(stderr,"connected \n");    
   }
   else
   {
     fprintf(stderr,"RA/Azimuth drive not responding ...\n");
+    AuxClose();
     return;
   }  
-
-  /* Test connection by asking for version of altitude motor */
-  
-  sendstr[2] = 0x11;
-
-  /* Flush the input buffer */
-
-  tcflush(TelPortFD,TCIOFLUSH);
-  
-  /* Send the request */
-  
-  writen(TelPortFD,sendstr,8);
-  numRead=readn(TelPortFD,returnstr,3,2);
-  
-  /* Add null terminator to simplify handling the return data */
-  
-  returnstr[numRead] = '\0';
    
-  if (numRead == 3) 
+  if (altstatus == AUXDONE) 
   { 
     fprintf(stderr,"Declination/Altitude ");
-    fprintf(stderr,"controller version %d.%d ", returnstr[0], returnstr[1]);
+    fprintf(stderr,"controller version %d.%d ", altversion[0], altversion[1]);
     fprintf(stderr,"connected\n");    
     TelConnectFlag = TRUE;
   }
   else
   {
     fprintf(stderr,"Declination/altitude drive not responding ...\n");
+    AuxClose();
     return;
   }  
    
@@ -382,14 +634,18 @@ void ConnectTel(void)
   flag = SetLimits(limits);
   usleep(500000);  
   flag = GetLimits(&limits);
-  
+
+  /* Start the slew time model from the top rates of the drives */
+
+  SlewModelReset();
+
   /* Set global switch angles for a GEM OTA over the pier pointing at pole   */
   /* They correspond to ha ~ -6 hr and dec ~ +90 deg for northern telescope  */
   /* They correspond to ha ~ +6 hr and dec ~ -90 deg for southern telescope  */
   /* Non-zero values work better in goto routines on nexstar                 */
       
-  switchaz = 1.; 
-  switchalt = -1.0;
+  switchaz = AuxDegrees(1.); 
+  switchalt = AuxDegrees(-1.);
   
   /* Hardcoded defaults for homeha and homedec are overridden by prefs */
   /* GEM: over the pier pointing at the pole */
@@ -435,6 +691,7 @@ void ConnectTel(void)
     else
     {
       fprintf(stderr,"Telescope mounting must be GEM, EQFORK, or ALTAZ\n");
+      AuxClose();
       return;
     }
   } 
@@ -447,6 +704,7 @@ void ConnectTel(void)
   if (flag != TRUE)
   {
     fprintf(stderr,"Initial telescope pointing request was out of range ... \n");
+    AuxClose();
     return;
   }
    
@@ -462,10 +720,6 @@ void ConnectTel(void)
   fprintf(stderr, "Mount now reading Dec: %lf\n", homedec);
   
   fprintf(stderr, "The telescope is running ...\n\n");
-    
-  /* Flush the input buffer in case there is something left from startup */
-
-  tcflush(TelPortFD,TCIOFLUSH);
 
 }
 
@@ -498,7 +752,13 @@ void SetRate(int newRate)
 void StartSlew(int direction)
 {
   char slewCmd[] = { 0x50, 0x02, 0x11, 0x24, 0x09, 0x00, 0x00, 0x00 };
-  char inputstr[2048];
+  
+  /* A manual slew ends tracking of the last target and timing of a goto */
+  
+  TrackStop();
+  tracktarget = FALSE;
+  slewdistance[0] = 0.;
+  slewdistance[1] = 0.;
   
   if(direction == NORTH)
     {
@@ -525,21 +785,12 @@ void StartSlew(int direction)
       slewCmd[4] = slewRate;
     }
 
-  writen(TelPortFD,slewCmd,8);
-
   /* Look for '#' acknowledgement of request*/
 
-  for (;;) 
+  if ( AuxCommand(slewCmd[2], slewCmd[3], slewCmd + 4, 1, NULL, 0) != 0 )
   {
-    if ( readn(TelPortFD,inputstr,1,1) ) 
-    {
-      if (inputstr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope slew control\n");
-    }
-  }   
+    fprintf(stderr,"No acknowledgement from telescope slew control\n");
+  }
 }
 
 
@@ -548,7 +799,6 @@ void StartSlew(int direction)
 void StopSlew(int direction)
 {
   char slewCmd[] = { 0x50, 0x02, 0x11, 0x24, 0x00, 0x00, 0x00, 0x00 };
-  char inputstr[2048];
   
   if(direction == NORTH)
     {
@@ -571,30 +821,30 @@ void StopSlew(int direction)
       slewCmd[3] = 0x24;
     }
 
-  tcflush(TelPortFD,TCIOFLUSH);
-
-  writen(TelPortFD,slewCmd,8);
-
   /* Look for '#' acknowledgement of request*/
 
-  for (;;) 
+  if ( AuxCommand(slewCmd[2], slewCmd[3], slewCmd + 4, 1, NULL, 0) != 0 )
   {
-    if ( readn(TelPortFD,inputstr,1,1) ) 
-    {
-      if (inputstr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope slew control\n");
-    }
-  }  
+    fprintf(stderr,"No acknowledgement from telescope slew control\n");
+  }
 }
 
 void DisconnectTel(void)
 {
   /* printf("DisconnectTel\n"); */
   if(TelConnectFlag == TRUE)
-    close(TelPortFD);
+  {
+    TrackStop();
+    if (trackfd >= 0)
+    {
+      TransportUnwatch(trackfd);
+      close(trackfd);
+      trackfd = -1;
+    }
+    AuxDrain();
+    AuxStatsSave();
+    AuxClose();
+  }
   TelConnectFlag = FALSE;
 }
 
@@ -605,31 +855,22 @@ void DisconnectTel(void)
 
 int SetTelEncoders(double setha, double setdec)
 {
-  /* Packet to set ha/azimuth drive  */
+  /* Data bytes for the commands to set each drive */
 
-  char sendstr[] = { 0x50, 0x04, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00 };
-  
-  /* Packet for return string */
-  
-  char returnstr[32];
-    
-  /* Count registers */
+  char azdata[3], altdata[3];
   
-  int azcount, azcount0, azcount1, azcount2;
-  int altcount, altcount0, altcount1, altcount2;
+  /* Completion status of each command */
   
-  /* Used to count number of characters read in the return packet */
-  
-  int numread; 
+  int azstatus, altstatus;
   
   /* Temporary variables for altitude and azimuth in degrees */
   
   double altnow, aznow; 
   
-  /* Temporary variables for real encoder readings in degrees */
+  /* Encoder angles for this position */
   
-  double encoderalt = 0.;
-  double encoderaz = 0.;
+  auxangle encoderalt = 0;
+  auxangle encoderaz = 0;
   
   /* Test ha and dec for valid range */
   
@@ -666,169 +907,186 @@ int SetTelEncoders(double setha, double setdec)
   /* Sign of encolder scales assumed:                          */
   /* Dec or Alt -- increase from equator to mount pole         */ 
   /* HA or Az   -- increase from east to west                  */
-  /* Counts wrap signed 24-bit integer where 16777216 is 2^24  */
     
-  if (telmount == GEM)
+  if (!EquatorialToEncoder(setha, setdec, &encoderaz, &encoderalt))
   {
-
-    /* Flip signs if sited below the equator */
-    
-    if (SiteLatitude < 0.)
-    {
-      setdec = -1.*setdec;
-      setha = -1.*setha;
-    }
+    return(0);
+  }
+  
+  /* Set RA/Azimuth and Dec/Altitude encoders to this position together */
     
-    /* Encoder az increases as this resigned ha increases */
-    /* Zero point is with telescope over the pier pointed at pole */     
-        
-    if (setha == 0.)
-    { 
-      /* OTA looking at meridian */
-      /* This is ambiguous unless we know which side of the pier it is on */
-      /* Assume telescope was on the west side looking east */
-      /*   and was moved to point to the meridian with the OTA west of pier */
-      
-      fprintf(stderr,"Warning: assuming OTA is west of pier.\n");
-      encoderaz = 90.;
-      encoderalt = setdec - 90.;
-    }
-    else if (setha == -6.)
-    {
-      /* OTA looking east */
-      encoderaz = 0.;
-      encoderalt = setdec - 90.;
-    }
-    else if (setha == 6.)
-    {
-      /* OTA looking west */
-      encoderaz = 0.;
-      encoderalt = 90. - setdec;
-    }    
-    else if ((setha > -12.) && ( setha < -6.))
-    { 
-      /* OTA east of pier looking below the pole */
-      encoderaz = setha*15. + 90.;
-      encoderalt = setdec - 90.;
-    }
-    else if ((setha > -6.) && ( setha < 0.))
-    { 
-      /* OTA west of pier looking east */
-      encoderaz = setha*15. + 90.;
-      encoderalt = setdec - 90.;
-    }
-    else if ((setha > 0.) && ( setha <= 6.))
-    { 
-      /*OTA east of pier looking west */
-      encoderaz = setha*15. - 90.;
-      encoderalt = 90. - setdec;
-    }
-    else if ((setha > 6.) && ( setha < 12.))
-    { 
-      /* OTA west of pier looking below the pole */
-      encoderaz = setha*15. - 90.;
-      encoderalt = 90. - setdec;
-    }    
-    else
-    {
-      fprintf(stderr,"German equatorial outside limits\n");
-      return(0);      
-    }
+  AuxPack(encoderaz, azdata);
+  AuxPack(encoderalt, altdata);
+
+  AuxSubmit(AUXAZM, 0x04, azdata, 3, NULL, 0, &azstatus, NULL, NULL);
+  AuxSubmit(AUXALT, 0x04, altdata, 3, NULL, 0, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
+
+  return(1);
+}
+
+/* Fixed-point encoder angles                                         */
+/* A turn is AUXTURN counts.  Angles are kept signed from minus half  */
+/* a turn to just under half a turn, so that integer sums and         */
+/* differences followed by AuxWrap wrap exactly as the drive counters */
+
+static auxangle AuxWrap(int count)
+{
+  return( ((count & (AUXTURN - 1)) ^ AUXHALFTURN) - AUXHALFTURN );
+}
+
+
+/* Nearest encoder angle for an angle in degrees */
+
+static auxangle AuxDegrees(double degrees)
+{
+  return( AuxWrap((int) floor(degrees*(AUXTURN/360.) + 0.5)) );
+}
+
+
+/* Nearest encoder angle for an angle in hours */
 
-    encoderaz = encoderaz*azcountperdeg;
-    encoderalt = encoderalt*altcountperdeg;            
+static auxangle AuxHours(double hours)
+{
+  return( AuxWrap((int) floor(hours*(AUXTURN/24.) + 0.5)) );
+}
+
+
+/* Encoder angle from the 3 bytes of a drive position, high byte first */
+
+static auxangle AuxUnpack(unsigned char *data)
+{
+  return( AuxWrap((data[0] << 16) | (data[1] << 8) | data[2]) );
+}
+
+
+/* The 3 bytes of a drive position for an encoder angle */
+
+static void AuxPack(auxangle angle, char *data)
+{
+  unsigned int count;
+  
+  count = ((unsigned int) angle) & (AUXTURN - 1);
+  data[0] = (char) (count >> 16);
+  data[1] = (char) ((count >> 8) & 0xff);
+  data[2] = (char) (count & 0xff);
+}
+
+
+/* Convert encoder angles to mount hour angle and declination          */
+/* Requires access to global telmount                                 */
+/* GEM encoders zero for OTA over pier pointed at pole                */
+/* Returns FALSE for an unknown mounting                              */
+
+int EncoderToEquatorial(auxangle encoderaz, auxangle encoderalt, 
+  double *telha0, double *teldec0)
+{
+  auxmount *mount;
+  auxangle ha, dec;
+  double az, alt;
+  
+  if ( (telmount < ALTAZ) || (telmount > GEM) )
+  {
+    fprintf(stderr,"Unknown mounting type\n");  
+    return(FALSE);
   }
-  else if (telmount == EQFORK)
+  mount = &auxmounts[telmount];
+  
+  if (!mount->equatorial)
   {
-    
-    /* Flip signs for the southern sky */
-    
-    if (SiteLatitude < 0.)
-    {
-      setdec = -1.*setdec;
-      setha = -1.*setha;
-    }
-
-    if ((setha > -6.) && ( setha < 6.))
-    { 
-      encoderaz = setha*15.;
-      encoderalt = setdec;
-      encoderaz = encoderaz*azcountperdeg;
-      encoderalt = encoderalt*altcountperdeg;       
-    }
-    else
-    {
-      fprintf(stderr,"Equatorial fork outside valid HA range\n");
-      return(0);      
-    }
-  }  
-  else if (telmount == ALTAZ)
+    az = encoderaz*(360./AUXTURN);
+    alt = encoderalt*(360./AUXTURN);
+    HorizontalToEquatorial(az, alt, telha0, teldec0);
+    *telha0 = Map12(*telha0);
+    return(TRUE);
+  }
+  
+  ha = AuxWrap(encoderaz + mount->ha0);
+  dec = AuxWrap(encoderalt + mount->dec0);
+  
+  /* A declination beyond a pole is seen from the other side of the pier */
+  
+  if (dec > AUXQUARTERTURN)
   {
-    encoderaz = aznow*azcountperdeg;
-    encoderalt = altnow*altcountperdeg;
+    dec = AUXHALFTURN - dec;
+    ha = AuxWrap(ha + AUXHALFTURN);
   }
-  else
+  else if (dec < -AUXQUARTERTURN)
   {
-    fprintf(stderr,"Unknown mount type\n");
-    return(0);
-  }   
-    
-  azcount = encoderaz;
-  if (azcount < 0)
+    dec = -AUXHALFTURN - dec;
+    ha = AuxWrap(ha + AUXHALFTURN);
+  }
+  
+  /* Flip signs for the southern sky */
+  
+  if (SiteLatitude < 0.)
   {
-    azcount = 16777217 + azcount;
+    dec = -dec;
+    ha = AuxWrap(-ha);
   }
+  
+  *telha0 = ha*(24./AUXTURN);
+  *teldec0 = dec*(360./AUXTURN);
+  
+  return(TRUE);
+}
+
+
+/* Convert mount hour angle and declination to encoder angles         */
+/* Requires access to global telmount                                 */
+/* A GEM OTA is west of the pier for targets east of the meridian     */
+/*   and on the meridian, and east of the pier for targets west of it */
+/* Returns FALSE for an unknown mounting                              */
 
-  altcount = encoderalt;
-  if (altcount < 0)
+int EquatorialToEncoder(double telha0, double teldec0, 
+  auxangle *encoderaz, auxangle *encoderalt)
+{
+  auxmount *mount;
+  auxangle ha, dec;
+  double az, alt;
+  
+  if ( (telmount < ALTAZ) || (telmount > GEM) )
+  {
+    fprintf(stderr,"Unknown mounting type\n");  
+    return(FALSE);
+  }
+  mount = &auxmounts[telmount];
+  
+  if (!mount->equatorial)
   {
-    altcount = 16777217 + altcount;
+    EquatorialToHorizontal(telha0, teldec0, &az, &alt);
+    *encoderaz = AuxDegrees(az);
+    *encoderalt = AuxDegrees(alt);
+    return(TRUE);
   }
 
-  /* Parse each of the 3 bytes of the counters */
+  ha = AuxHours(telha0);
+  dec = AuxDegrees(teldec0);
     
-  azcount0  = azcount  / 65536;
-  azcount   = azcount  % 65536;
-  azcount1  = azcount  / 256;
-  azcount2  = azcount  % 256;
-  altcount0 = altcount / 65536;
-  altcount  = altcount % 65536;
-  altcount1 = altcount / 256;
-  altcount2 = altcount % 256;
-  
-  /* Set RA/Azimuth encoder to this position */
-    
-  sendstr[1] = 0x04;
-  sendstr[2] = 0x10;
-  sendstr[3] = 0x04;
-  sendstr[4] = (unsigned short) azcount0;
-  sendstr[5] = (unsigned short) azcount1;
-  sendstr[6] = (unsigned short) azcount2;
-
-  tcflush(TelPortFD,TCIOFLUSH);
+  /* Flip signs for the southern sky */
   
-  writen(TelPortFD,sendstr,8);
-  numread=readn(TelPortFD,returnstr,1,2);
+  if (SiteLatitude < 0.)
+  {
+    dec = -dec;
+    ha = AuxWrap(-ha);
+  }
   
-  /* Set Dec/Altitude encoder to this position */
-    
-  sendstr[1] = 0x04;
-  sendstr[2] = 0x11;
-  sendstr[3] = 0x04;
-  sendstr[4] = (unsigned short) altcount0;
-  sendstr[5] = (unsigned short) altcount1;
-  sendstr[6] = (unsigned short) altcount2;
-
-  tcflush(TelPortFD,TCIOFLUSH);
-    
-  writen(TelPortFD,sendstr,8);
-  numread=readn(TelPortFD,returnstr,1,2);
+  /* West of the meridian look from the other side of the pier */
   
-  tcflush(TelPortFD,TCIOFLUSH);
-
-  return(1);
+  if ( mount->pierflip && (ha > 0) )
+  {
+    dec = AUXHALFTURN - dec;
+    ha = AuxWrap(ha + AUXHALFTURN);
+  }
+  
+  *encoderaz = AuxWrap(ha - mount->ha0);
+  *encoderalt = AuxWrap(dec - mount->dec0);
+  
+  return(TRUE);
 }
 
+
 /* Read the mount encoders                                            */
 /* Requires access to global telmount                                 */
 /* Save encoder angle readings in global telencoder variables         */
@@ -840,211 +1098,40 @@ int SetTelEncoders(double setha, double setdec)
 void GetTel(double *telra, double *teldec, int pmodel)
 {  
    
-  /* Packet preset to request HA/Azimuth counts */
-
-  char sendstr[] = { 0x50, 0x01, 0x10, 0x01, 0x00, 0x00, 0x00, 0x03 };
-  char returnstr[32];
-  int azcount = 0; 
-  int altcount = 0;
-  double encoderaz = 0.;
-  double encoderalt = 0.;
+  auxangle encoderaz = 0;
+  auxangle encoderalt = 0;
+  double lst = 0.;
+  timecontext sample, *saved;
   double telha0 = 0.;
   double teldec0 = 0.;
   double telra0 = 0.;
   double telra1 = 0.;
   double teldec1 = 0.;
-  int numRead = 0;
-  static int count0, count1, count2;
-
-  /* Packet to request RA/Azimuth */
-  
-  sendstr[2] = 0x10;
-  
-  /* Flush the input buffer */
-  
-  tcflush(TelPortFD,TCIOFLUSH);
-  
-  /* Send the request */
-
-  writen(TelPortFD,sendstr,8);
-  numRead=readn(TelPortFD,returnstr,4,2);
-
-  if (numRead == 4) 
-  {         
-    count0 = (unsigned char) returnstr[0];
-    count1 = (unsigned char) returnstr[1];
-    count2 = (unsigned char) returnstr[2];
-    azcount = 256*256*count0 + 256*count1 + count2;
-    if (azcount > 8388608)
-    {
-      azcount = -(16777217 - azcount);
-    }
-    encoderaz = (double) azcount;
-  }
-
-  /* Packet to request Dec/Altitude */
-  
-  sendstr[2] = 0x11;
-
-  /* Flush the input buffer */
-  
-  tcflush(TelPortFD,TCIOFLUSH);
 
-  /* Send the request */
-  
-  writen(TelPortFD,sendstr,8);
-  numRead=readn(TelPortFD,returnstr,4,2);
-  
-  if (numRead == 4) 
-  {     
-    count0 = (unsigned char) returnstr[0];
-    count1 = (unsigned char) returnstr[1];
-    count2 = (unsigned char) returnstr[2];
-    altcount = 256*256*count0 + 256*count1 + count2;
-    
-    if (altcount > 8388608)
-    {
-      altcount = -(16777217 - altcount);
-    }   
-    encoderalt = (double) altcount;
-  }  
+  /* Read both encoders as one sample with the moment it was taken */
   
-  /* Convert counts to degrees for both azimuth and altitude encoders */
-  
-  encoderaz = encoderaz / azcountperdeg;
-  encoderalt = encoderalt / altcountperdeg;
+  AuxGetPosition(&encoderaz, &encoderalt, &sample);
+  lst = sample.lst;
+  telsample = sample;
   
   /* Transform encoder readings to mount ha, ra and dec */
-  /* GEM encoders zero for OTA over pier pointed at pole */
-  
-  if (telmount == GEM)
-  {
-    if ( encoderaz == 0. ) 
-    {
-      if ( encoderalt < 0.)
-      {
-        telha0 = -6.;
-        teldec0 = 90. + encoderalt;
-      }
-      else
-      {
-        telha0 = +6.;
-        teldec0 = 90. - encoderalt;
-      }
-    }
-    else if ( encoderaz == -90. )
-    {
-      if ( encoderalt < 0.)
-      {
-        telha0 = 0.;
-        teldec0 = 90. + encoderalt;
-      }
-      else
-      {
-        telha0 = -12.;
-        teldec0 = 90. - encoderalt;
-      }    
-    }
-    else if ( encoderaz == 90. )
-    {
-      if ( encoderalt > 0.)
-      {
-        telha0 = 0.;
-        teldec0 = 90. - encoderalt;
-      }
-      else
-      {
-        telha0 = -12.;
-        teldec0 = 90. + encoderalt;
-      }    
-    }   
-    else if ((encoderaz > -180. ) && (encoderaz < -90.))
-    {
-      teldec0 = 90. - encoderalt;
-      telha0 = Map12(6. + encoderaz/15.);  
-    }
-    else if ((encoderaz > -90. ) && (encoderaz < 0.))
-    {
-      teldec0 = 90. - encoderalt;
-      telha0 = Map12(6. + encoderaz/15.);  
-    }    
-    else if ((encoderaz > 0. ) && (encoderaz < 90.))
-    {
-      teldec0 = 90. + encoderalt;
-      telha0 = Map12(-6. + encoderaz/15.);  
-    }    
-    else if ((encoderaz > 90. ) && (encoderaz < 180.))
-    {
-      teldec0 = 90. + encoderalt;
-      telha0 = Map12(-6. + encoderaz/15.);  
-    }   
-    else
-    {
-      fprintf(stderr,"German equatorial ha encoder out of range\n");      
-      teldec0 = 0.;
-      telha0 = 0.;
-    }   
-    
-    /* Flip signs for the southern sky */
-    
-    if (SiteLatitude < 0.)
-    {
-      teldec0 = -1.*teldec0;
-      telha0 = -1.*telha0;
-    }
-        
-    telra0 = Map24(LSTNow() - telha0);
-  }
-    
-  else if (telmount == EQFORK)
-  {
-    teldec0 = encoderalt;
-    telha0 = Map12(encoderaz/15.);
-    
-    /* Flip signs for the southern sky */
-    
-    if (SiteLatitude < 0.)
-    {
-      teldec0 = -1.*teldec0;
-      telha0 = -1.*telha0;
-    }
-        
-    telra0 = Map24(LSTNow() - telha0);    
-  }
   
-  else if (telmount == ALTAZ)
-  {
-    HorizontalToEquatorial(encoderaz, encoderalt, &telha0, & teldec0);
-    telha0 = Map12(telha0);
-    telra0 = Map24(LSTNow() - telha0);   
-  }
-
-  else
+  if (!EncoderToEquatorial(encoderaz, encoderalt, &telha0, &teldec0))
   {
-    fprintf(stderr,"Unknown mounting type\n");  
     *telra=0.;
     *teldec=0.;
-    telencoderaz = 0.;
-    telencoderalt = 0.;
+    telencoderaz = 0;
+    telencoderalt = 0;
     return;
   }
-    
-  /* Handle special case if not already treated where dec is beyond a pole */
-  
-  if (teldec0 > 90.)
-  {
-    teldec0 = 180. - teldec0;
-    telra0 = Map24(telra0 + 12.);
-  }
-  else if (teldec0 < -90.)
-  {
-    teldec0 = -180. - teldec0;
-    telra0 = Map24(telra0 + 12.);
-  }
+  telra0 = Map24(lst - telha0);
     
   /* Apply pointing model to the coordinates that are reported by the telescope */
+  /* The model works at the moment of the encoder sample */
   
+  saved = TimeUse(&sample);
   PointingFromTel(&telra1, &teldec1, telra0, teldec0, pmodel);
+  TimeUse(saved);
       
   /* Return corrected values */
 
@@ -1077,28 +1164,26 @@ void GetTel(double *telra, double *teldec, int pmodel)
 
 int GoToCoords(double newra, double newdec, int pmodel)
 {
-  char sendstr[] = { 0x50, 0x04, 0x10, 0x17, 0x00, 0x00, 0x00, 0x00 };
-  char returnstr[32];
-  int azcount, azcount0, azcount1, azcount2;
-  int altcount, altcount0, altcount1, altcount2;
-  int numread; 
+  int kind = 0;
+  int detour = FALSE;
+  int i;
   double newha, newalt, newaz;
-  double newha0, newalt0, newaz0;
+  double newha0;
   double newra0, newdec0;
   double newra1, newdec1;
   double nowha0, nowra0, nowdec0;
-  double encoderalt = 0.;
-  double encoderaz = 0.;
-     
-  /* Select fast slew command if needed */
-  /* Note:  may place large inertial load on the gear train */
-  
-  if( SLEWFAST )
-  {
-    sendstr[3] = 0x02;
-  }
+  double lead;
+  auxangle target[2], leg[2], from[2];
+  auxangle encoderalt = 0;
+  auxangle encoderaz = 0;
+  timecontext now, arrival, *saved;
         
-  newha = LSTNow() - newra;
+  /* Test the target and find its mount coordinates at one moment */
+  
+  TimeClock(&now);
+  saved = TimeUse(&now);
+  
+  newha = now.lst - newra;
   newha = Map12(newha);
   
   /* Convert HA and Dec to Alt and Az */
@@ -1106,250 +1191,98 @@ int GoToCoords(double newra, double newdec, int pmodel)
   
   EquatorialToHorizontal(newha, newdec, &newaz, &newalt);
   
-  /* Check altitude limit */
+  /* Check altitude limit and the local horizon */
   
-  if (newalt < MINTARGETALT)
+  if ( (newalt < MINTARGETALT) || (newalt < HorizonAltitude(newaz)) )
   {
     fprintf(stderr,"Target is below the telescope horizon\n");
     slewphase = 0;
+    TimeUse(saved);
     return(0);
   }
   
   /* Target request is valid */
   /* Find the best path to target */
     
-  /* Mount coordinates for the target */
+  /* Tracking will hold this target when the slew is done */
   
-  newra1 = newra;
-  newdec1 = newdec;
-  PointingToTel(&newra0,&newdec0,newra1,newdec1,pmodel);  
-  newha0 = LSTNow() - newra0;
-  newha0 = Map12(newha0);
-  EquatorialToHorizontal(newha0, newdec0, &newaz0, &newalt0);
+  trackra = newra;
+  trackdec = newdec;
+  trackpmodel = pmodel;
+  tracktarget = TRUE;
+  
+  TimeUse(saved);
   
   /* Stop all mount motion in preparation for a slew */
   
   FullStop();  
 
   /* Get current mount coordinates */
+  /* The hour angle is referred to the moment the encoders were read */
   
   GetTel(&nowra0, &nowdec0, RAW);
-  nowha0 = LSTNow() - nowra0;
+  nowha0 = telsample.lst - nowra0;
   nowha0 = Map12(nowha0);
           
-  /* Prepare encoder counts for a new slew */
-
-  /* German equatorial */
-
-  if (telmount == GEM)
+  /* Prepare encoder counts for a new slew                            */
+  /* Aim at the target as it will be when the slower axis arrives and */
+  /*   iterate since the place on arrival changes the time to slew    */
+  /* The next leg may be a fast goto to the standoff of the target    */
+  /*   or on a GEM to a waypoint on the way                           */
+
+  TimeClock(&now);
+  lead = 0.;
+  for (i = 0; i < SLEWLEAD; i++)
   {
+    TimeAt(&arrival, now.utc + lead);
+    saved = TimeUse(&arrival);
+    newra1 = newra;
+    newdec1 = newdec;
+    PointingToTel(&newra0,&newdec0,newra1,newdec1,pmodel);  
+    newha0 = arrival.lst - newra0;
+    newha0 = Map12(newha0);
+    TimeUse(saved);
     
-    /* Flip signs for the southern sky */
-    
-    if (SiteLatitude < 0.)
+    if (!EquatorialToEncoder(newha0, newdec0, &target[0], &target[1]))
     {
-      newdec0 = -1.*newdec0;
-      newha0 = -1.*newha0;
+      return(0);
     }
     
-    if ((newha0 >= -12.) && ( newha0 < -6.))
-    { 
-      slewphase = 1;
-      encoderaz = newha0*15. + 180.;
-      encoderalt = newdec0;
-    }
-    else if ((newha0 >= -6.) && ( newha0 <= 0.))
-    { 
-      slewphase = 1;
-      encoderaz = newha0*15. + 180.;
-      encoderalt = newdec0;
-    }
-    else if ((newha0 > 0.) && ( newha0 <= 6.))
-    { 
-      slewphase = 1;
-      encoderaz = newha0*15.;
-      encoderalt = 180. - newdec0;
-    }
-    else if ((newha0 > 6.) && ( newha0 <= 12.))
-    { 
-      slewphase = 1;
-      encoderaz = newha0*15.;
-      encoderalt = 180. - newdec0;
-    }    
-    else
-    {
-      fprintf(stderr,"German equatorial slew request error\n");
-      return(0);      
-    }
-
-    if (newha0 == 0.)
-    { 
-      /* OTA looking at meridian */
-      /* This is ambiguous unless we know which side of the pier it is on */
-      /* Assume telescope was on the west side looking east */
-      /*   and was moved to point to the meridian with the OTA west of pier */
-      slewphase = 1;
-      fprintf(stderr,"Warning: assuming OTA is west of pier.\n");
-      encoderaz = 90.;
-      encoderalt = newdec0 - 90.;
-    }
-    else if (newha0 == -6.)
-    {
-      /* OTA looking east */
-      slewphase = 1;
-      encoderaz = 0.;
-      encoderalt = newdec0 - 90.;
-    }
-    else if (newha0 == 6.)
-    {
-      /* OTA looking west */
-      slewphase = 1;
-      encoderaz = 0.;
-      encoderalt = 90. - newdec0;
-    }    
-    else if ((newha0 > -12.) && ( newha0 < -6.))
-    { 
-      /* OTA east of pier looking below the pole */
-      slewphase = 1;
-      encoderaz = newha0*15. + 90.;
-      encoderalt = newdec0 - 90.;
-    }
-    else if ((newha0 > -6.) && ( newha0 < 0.))
-    { 
-      /* OTA west of pier looking east */
-      slewphase = 1;
-      encoderaz = newha0*15. + 90.;
-      encoderalt = newdec0 - 90.;
-    }
-    else if ((newha0 > 0.) && ( newha0 <= 6.))
-    { 
-      /*OTA east of pier looking west */
-      slewphase = 1;
-      encoderaz = newha0*15. - 90.;
-      encoderalt = 90. - newdec0;
-    }
-    else if ((newha0 > 6.) && ( newha0 < 12.))
-    { 
-      /* OTA west of pier looking below the pole */
-      slewphase = 1;
-      encoderaz = newha0*15. - 90.;
-      encoderalt = 90. - newdec0;
-    }    
-    else
+    
+    /* German equatorial */
+    /* Choose the side of the pier and whether to stop on the way */
+    
+    if (telmount == GEM)
     {
-      fprintf(stderr,"German equatorial slew request outside limits\n");
-      return(0);      
+      lead = SlewPlanGem(target, leg, &kind, &detour);
     }
-
-    /* Tests for safe slew based on encoder readings would go here */
-        
-    /* Test need for two-segment slew for changes of more than 90 degrees */
-    
-    if ((fabs(telencoderalt - encoderalt) > 90.1) || 
-      (fabs(telencoderaz - encoderaz) > 90.1))
+    else
     {
-      
-      /* Slew request of more than 90 degrees on one axis */
-      
-      if ( fabs(telencoderalt) > 10. )
-      {
-        
-        /* Telescope currently more than 10 degrees from the pole in dec */
-        /* Set new target to switch position */
-        
-        encoderalt = switchalt;
-        encoderaz = switchaz;
-        slewphase = 2;
-      }  
+      from[0] = telencoderaz;
+      from[1] = telencoderalt;
+      lead = SlewPlan(from, target, leg, &kind);
     }
-            
-    encoderalt = encoderalt*altcountperdeg;
-    encoderaz = encoderaz*azcountperdeg;     
   }
+  encoderaz = leg[0];
+  encoderalt = leg[1];
   
-  /* Equatorial fork */
+  /* A fast leg to the standoff is followed by the slow approach */
+  /* A leg to a waypoint is followed by a new plan from there    */
   
-  if (telmount == EQFORK)
+  if ( detour || (SLEWTWOPHASE && (kind == 1)) )
   {
-    slewphase = 1;
-    encoderaz = newha0*15.;
-    encoderalt = newdec0;
-
-    /* Tests for safe slew based on encoder readings would go here */
-
-    encoderalt = encoderalt*altcountperdeg;
-    encoderaz = encoderaz*azcountperdeg;       
+    slewphase = 2;
   }
-  
-  /* Alt-az fork */
-  
-  if (telmount == ALTAZ)
+  else
   {
     slewphase = 1;
-    encoderaz = newaz0;
-    encoderalt = newalt0;
-
-    /* Tests for safe slew based on encoder readings would go here */
-
-    encoderaz = encoderaz*azcountperdeg;
-    encoderalt = encoderalt*altcountperdeg;
   }
-        
-  /* Convert encoder angle readings to encoder counter readings */
-
-  azcount = encoderaz;
-  if (azcount < 0)
-  {
-    azcount = 16777217 + azcount;
-  }
-
-  altcount = encoderalt;
-  if (altcount < 0)
-  {
-    altcount = 16777217 + altcount;
-  }
-
-  /* Prepare NexStar commands                  */
-  /* Parse each of the 3 bytes of the counters */
-    
-  azcount0  = azcount  / 65536;
-  azcount   = azcount  % 65536;
-  azcount1  = azcount  / 256;
-  azcount2  = azcount  % 256;
-  altcount0 = altcount / 65536;
-  altcount  = altcount % 65536;
-  altcount1 = altcount / 256;
-  altcount2 = altcount % 256;
-  
-  /* Send command to go to new RA/Azimuth */
-    
-  sendstr[1] = 0x04;
-  sendstr[2] = 0x10;
-  sendstr[3] = 0x17;
-  sendstr[4] = (unsigned short) azcount0;
-  sendstr[5] = (unsigned short) azcount1;
-  sendstr[6] = (unsigned short) azcount2;
-
-  tcflush(TelPortFD,TCIOFLUSH);
-  
-  writen(TelPortFD,sendstr,8);
-  numread=readn(TelPortFD,returnstr,1,2);
   
-  /* Send command to go to new Dec/Altitude */
-    
-  sendstr[1] = 0x04;
-  sendstr[2] = 0x11;
-  sendstr[3] = 0x17;
-  sendstr[4] = (unsigned short) altcount0;
-  sendstr[5] = (unsigned short) altcount1;
-  sendstr[6] = (unsigned short) altcount2;
-
-  tcflush(TelPortFD,TCIOFLUSH);
+  /* Tests for safe slew on the other mountings would go here */
+        
+  /* Send commands to go to new RA/Azimuth and Dec/Altitude */
     
-  writen(TelPortFD,sendstr,8);
-  numread=readn(TelPortFD,returnstr,1,2);
-  
-  tcflush(TelPortFD,TCIOFLUSH);
+  SlewSend(kind, encoderaz, encoderalt);
   
   /* A slew is in progress */
 
@@ -1364,28 +1297,43 @@ int GoToCoords(double newra, double newdec, int pmodel)
 
 int GetSlewStatus(void)
 {
-  char sendstr[] = { 0x50, 0x01, 0x10, 0x13, 0x00, 0x00, 0x00, 0x01 };
-  char returnstr[32];
-  int numread;
+  char azdone[1], altdone[1];
+  int azstatus, altstatus;
+  int azslewing, altslewing;
+  
+  /* Use the slew state just heard on the link if there is one */
+  
+  if ( AuxHeard(&auxheard[0].slewtime) && AuxHeard(&auxheard[1].slewtime) )
+  {
+    auxspared += 2;
+    SlewPolled(0, auxheard[0].slewing);
+    SlewPolled(1, auxheard[1].slewing);
+    return ( (auxheard[0].slewing || auxheard[1].slewing) ? 1 : 0 );
+  }
     
-  /* Query azimuth drive first */
+  /* Query both drives at once */
+  
+  AuxSubmit(AUXAZM, 0x13, NULL, 0, azdone, 1, &azstatus, NULL, NULL);
+  AuxSubmit(AUXALT, 0x13, NULL, 0, altdone, 1, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
+
+  /* A drive that is still slewing reports zero */
+  
+  azslewing = ( (azstatus == AUXDONE) && (azdone[0] == 0) );
+  altslewing = ( (altstatus == AUXDONE) && (altdone[0] == 0) );
   
-  sendstr[2]=0x10;
-  tcflush(TelPortFD,TCIOFLUSH);
-  writen(TelPortFD,sendstr,8);
-  numread=readn(TelPortFD,returnstr,2,2);
-  if ( returnstr[0] == 0 ) 
+  if (azstatus == AUXDONE)
   {
-     return(1);
+    SlewPolled(0, azslewing);
   }
   
-  /* Query altitude drive if azimuth drive is not slewing */
+  if (altstatus == AUXDONE)
+  {
+    SlewPolled(1, altslewing);
+  }
   
-  sendstr[2]=0x11;
-  tcflush(TelPortFD,TCIOFLUSH);
-  writen(TelPortFD,sendstr,8);
-  numread=readn(TelPortFD,returnstr,2,2);
-  if ( returnstr[0] == 0 ) 
+  if ( azslewing || altslewing ) 
   {
      return(1);
   }
@@ -1394,561 +1342,2746 @@ int GetSlewStatus(void)
 }
 
 
-/* Test whether the destination was reached                  */
-/* Initiate the next segment if slewphase is greater than 1  */
-/* Reset slewphase when goto has finished a segment          */
-/* Return value is                                           */
-/*   0 -- goto in progress                                   */
-/*   1 -- goto complete within tolerance                     */
-/*   2 -- goto complete but outside tolerance                */
-
-int CheckGoTo(double desRA, double desDec, int pmodel)
+/* Slew time model                                                           */
+/*                                                                           */
+/* A goto on one axis accelerates to its top rate, runs at that rate, and    */
+/* slows down to stop on the target.  Over a distance d with top rate v and  */
+/* acceleration a it takes                                                   */
+/*                                                                           */
+/*   t = 2 sqrt(d/a)    if d < v^2/a and the top rate is not reached         */
+/*   t = d/v + v/a      otherwise                                            */
+/*                                                                           */
+/* plus a latency for the command and the settling of the drive.  The end   */
+/* of a slew is taken halfway between the last poll that saw the axis       */
+/* slewing and the first that did not.  Slews that reached the top rate are */
+/* fitted with a straight line in distance, with earlier slews weighted     */
+/* down by SLEWFORGET, to find the rate and the latency.  Other slews, or   */
+/* too few distances to fit, adjust only the latency.                       */
+
+static void SlewModelReset(void)
 {
-  double telra1, teldec1;
-  double errorRA, errorDec, nowRA, nowDec;
-  double tolra, toldec;
-
-  /* Is the telescope slewing? */
-    
-  if ( GetSlewStatus() == 1 )
+  char azmax[4], altmax[4];
+  char azdir[1], altdir[1];
+  int azstatus, altstatus;
+  int kind, axis, millidegrees;
+  
+  memset(auxslews, 0, sizeof(auxslews));
+  for (axis = 0; axis < 2; axis++)
   {
-    /* One or more axes remain in motion */
-    /* Try again later */
-    
-    return(0);
+    for (kind = 0; kind < 2; kind++)
+    {
+      auxslews[kind][axis].rate = (kind == 1) ? SLEWFASTRATE : SLEWSLOWRATE;
+      auxslews[kind][axis].accel = SLEWACCEL;
+      auxslews[kind][axis].latency = SLEWLATENCY;
+    }
+    slewdistance[axis] = 0.;
   }
   
-  /* Was this a two-phase slew? */
+  /* MC_GET_MAXRATE answers each drive with two 16 bit values in          */
+  /*   millidegrees per second, most significant byte first.  The second  */
+  /*   is the fast goto rate set by MC_SET_MAXRATE at which the drive     */
+  /*   slews, and is read for both drives.  The first is not used.        */
   
-  if ( slewphase == 2 )
+  AuxSubmit(AUXAZM, 0x21, NULL, 0, azmax, 4, &azstatus, NULL, NULL);
+  AuxSubmit(AUXALT, 0x21, NULL, 0, altmax, 4, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
+  
+  if (azstatus == AUXDONE)
   {
-        
-    /* Reset the slew phase and continue to the destination */
-    
-    slewphase = 0;    
-    
-    /* Go to the original destination */
-    /* GoToCoords will change slewphase to 1 */
-        
-    GoToCoords(desRA, desDec, pmodel);
-        
-    /* Return a flag indicating a new goto operation is in progress */
-    
-    return(0);
+    millidegrees = ((unsigned char) azmax[2] << 8) | (unsigned char) azmax[3];
+    if (millidegrees > 0)
+    {
+      auxslews[1][0].rate = millidegrees/1000.;
+    }
   }
-  else if ( slewphase == 1 )
-  {    
-      
-    /* No axes are moving. Insure that tracking is started again. */
-    
-    StartTrack();
-    
-    /* Where are we now? */
-  
-    GetTel(&nowRA, &nowDec, pmodel);
-
-    /* Compare to destination with pre-defined tolerances */
-     
-    telra1 = desRA;
-    teldec1 = desDec;
-        
-    /* RA slew tolerance in hours */
-    
-    tolra = SLEWTOLRA;
-    
-    /* Dec slew tolerance in degrees */
-    
-    toldec = SLEWTOLDEC;
-
-    /* What is the absolute value of the pointing error? */
-  
-    /* Magnitude of RA pointing error in hours */
-    
-    errorRA = fabs(nowRA - telra1);
-    
-    /* Magnitude of Dec pointing error in degrees */
-    
-    errorDec = fabs(nowDec - teldec1);
   
-    /* Compare and notify whether we are within tolerance */
-
-    if( ( errorRA > tolra ) || ( errorDec > toldec ) )
+  if (altstatus == AUXDONE)
+  {
+    millidegrees = ((unsigned char) altmax[2] << 8) | (unsigned char) altmax[3];
+    if (millidegrees > 0)
     {
-      /* Result of slew is outside acceptable tolerance */
-      /* Signal the calling routine that another goto may be needed */
-    
-      slewphase = 0;
-      return(2);
+      auxslews[1][1].rate = millidegrees/1000.;
     }
-  }    
-  else
+  }
+  
+  /* MC_GET_APPROACH answers 0 for a final approach in the positive sense */
+  
+  slewapproach[0] = 1;
+  slewapproach[1] = 1;
+  AuxSubmit(AUXAZM, 0xfc, NULL, 0, azdir, 1, &azstatus, NULL, NULL);
+  AuxSubmit(AUXALT, 0xfc, NULL, 0, altdir, 1, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
+  
+  if ( (azstatus == AUXDONE) && (azdir[0] != 0) )
   {
-    /* Unexpected slew phase */
-    /* Reset and return success without a test */
-    /* This should clear errors and enable another slew request from the UI */
-    /* Better would be to flag an error but that might have unintended consequences */
+    slewapproach[0] = -1;
+  }
   
-    slewphase = 0;    
-  } 
-  return(1); 
+  if ( (altstatus == AUXDONE) && (altdir[0] != 0) )
+  {
+    slewapproach[1] = -1;
+  }
+  
+  /* MC_POLL_CORDWRAP answers 0xff when the azimuth drive will not cross */
+  /*   the position given by MC_GET_CORDWRAP_POS in a goto               */
+  
+  slewcordwrap = FALSE;
+  AuxSubmit(AUXAZM, 0x3b, NULL, 0, azdir, 1, &azstatus, NULL, NULL);
+  AuxSubmit(AUXAZM, 0x3c, NULL, 0, azmax, 3, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
+  
+  if ( (azstatus == AUXDONE) && (altstatus == AUXDONE) && (azdir[0] != 0) )
+  {
+    slewcordwrap = TRUE;
+    slewcordpos = AuxUnpack((unsigned char *) azmax);
+  }
 }
 
-/* Coordinates and time */
 
-/* Synchronize remote telescope to this UTC */
+/* Predicted seconds for a goto of this kind over distance degrees on an axis */
 
-int SyncTelToUTC(double newutc)
+static double SlewTime(int kind, int axis, double distance)
 {
-  return 0;
+  auxslew *model;
+  double t;
+  
+  model = &auxslews[kind][axis];
+  distance = fabs(distance);
+  if (distance*model->accel < model->rate*model->rate)
+  {
+    t = 2.*sqrt(distance/model->accel);
+  }
+  else
+  {
+    t = distance/model->rate + model->rate/model->accel;
+  }
+  return (t + model->latency);
 }
 
-/* Synchronize remote telescope to this observatory location  */
 
-int SyncTelToLocation(double newlong, double newlat, double newalt)
+/* Start timing a goto from the current encoder angles to these */
+
+static void SlewStarted(int kind, auxangle encoderaz, auxangle encoderalt)
 {
-  return 0;
+  slewkind = kind;
+  slewdistance[0] = fabs(SlewTravel(0, telencoderaz, encoderaz));
+  slewdistance[1] = fabs(SlewTravel(1, telencoderalt, encoderalt));
+  gettimeofday(&slewstart, NULL);
+  slewseen[0] = slewstart;
+  slewseen[1] = slewstart;
+  slewsettleutc = 0.;
 }
 
-/* Synchronize remote telescope to this local sidereal time  */
 
-int SyncTelToLST(double newlst)
+/* Note the slew state of an axis and learn from the slew when it has ended */
+
+static void SlewPolled(int axis, int slewing)
 {
-  return 0;
+  struct timeval now;
+  double seen, ended;
+  
+  if (slewdistance[axis] == 0.)
+  {
+    return;
+  }
+  
+  gettimeofday(&now, NULL);
+  if (slewing)
+  {
+    slewseen[axis] = now;
+    return;
+  }
+  
+  seen = (slewseen[axis].tv_sec - slewstart.tv_sec) + 
+    1.e-6*(slewseen[axis].tv_usec - slewstart.tv_usec);
+  ended = (now.tv_sec - slewstart.tv_sec) + 
+    1.e-6*(now.tv_usec - slewstart.tv_usec);
+  
+  /* Polls too far apart do not time the slew */
+  
+  if (ended - seen < SLEWPOLL)
+  {
+    SlewLearn(slewkind, axis, slewdistance[axis], 0.5*(seen + ended));
+  }
+  slewdistance[axis] = 0.;
 }
 
-/* Start sidereal tracking                                                    */
-/* StartTrack is aware of the latitude and will set the direction accordingly */
-/* Call StartTrack at least once after the driver has the latitude            */
 
-void StartTrack(void)
+/* Refine the model of a kind of goto on an axis from one measured slew */
+
+static void SlewLearn(int kind, int axis, double distance, double seconds)
 {
+  auxslew *model;
+  double residual, mean, var, cov, rate;
   
-  char slewCmd[] = { 0x50, 0x03, 0x10, 0x06, 0xff, 0x0ff, 0x00, 0x00 };
-  
-  /* 0x50 is pass through code */
-  /* 0x03 is number of data bytes including msgId */
-  /* 0x10 is the destId for the ra drive, or 0x11 for declination */
-  /* 0x06 is the msgId to set a positive drive rate */
-  /* 0xff is the first of two data bytes for the sidereal drive rate */
-  /* 0xff is the second of two data bytes for the sidereal drive rate */
-  /* 0x00 is a null byte */
-  /* 0x00 is a request to send no data back other than the # ack */
-
-  char inputstr[2048];
+  model = &auxslews[kind][axis];
+  residual = seconds - SlewTime(kind, axis, distance);
   
-  /* Test for southern hemisphere */
-  /* Set negative drive rate if we're south of the equator */
-
-  if ( SiteLatitude < 0. )
+  if (distance*model->accel >= model->rate*model->rate)
   {
-    slewCmd[3] = 0x07;
+  
+    /* The axis reached its top rate and the time is linear in distance */
+    
+    model->sw = SLEWFORGET*model->sw + 1.;
+    model->sd = SLEWFORGET*model->sd + distance;
+    model->st = SLEWFORGET*model->st + seconds;
+    model->sdd = SLEWFORGET*model->sdd + distance*distance;
+    model->sdt = SLEWFORGET*model->sdt + distance*seconds;
+    
+    mean = model->sd/model->sw;
+    var = model->sdd/model->sw - mean*mean;
+    cov = model->sdt/model->sw - mean*model->st/model->sw;
+    
+    if ( (var > SLEWSPREAD*SLEWSPREAD) && (cov > 0.) )
+    {
+    
+      /* Fit the rate from the slope and the latency from the intercept */
+      /* A single fit changes the rate by no more than a factor of two  */
+      
+      rate = var/cov;
+      if (rate > 2.*model->rate)
+      {
+        rate = 2.*model->rate;
+      }
+      else if (rate < 0.5*model->rate)
+      {
+        rate = 0.5*model->rate;
+      }
+      model->rate = rate;
+      model->latency = (model->st - model->sd/rate)/model->sw - 
+        rate/model->accel;
+      if (model->latency < 0.)
+      {
+        model->latency = 0.;
+      }
+      return;
+    }
   }
   
-  tcflush(TelPortFD,TCIOFLUSH);
+  /* Otherwise the error of the prediction goes into the latency */
   
-  writen(TelPortFD,slewCmd,8);
+  model->latency += (1. - SLEWFORGET)*residual;
+  if (model->latency < 0.)
+  {
+    model->latency = 0.;
+  }
+}
 
-  /* Look for '#' acknowledgement of request */
 
-  for (;;) 
+/* Signed degrees a drive turns in a goto between these encoder angles     */
+/* The shorter way round unless the azimuth drive would cross its cord wrap */
+
+static double SlewTravel(int axis, auxangle from, auxangle to)
+{
+  auxangle step, wrap;
+  
+  step = AuxWrap(to - from);
+  if ( (axis == 0) && slewcordwrap )
   {
-    if ( readn(TelPortFD,inputstr,1,1) ) 
+    wrap = AuxWrap(slewcordpos - from);
+    if ( (step > 0) && (wrap > 0) && (wrap < step) )
     {
-      if (inputstr[0] == '#')
-      {
-        break;
-      } 
+      step -= AUXTURN;
     }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope sidereal track request\n");
+    else if ( (step < 0) && (wrap < 0) && (wrap > step) )
+    {
+      step += AUXTURN;
     }
-  }  
-} 
+  }
+  return ( step/((axis == 0) ? AZCOUNTPERDEG : ALTCOUNTPERDEG) );
+}
 
-/* Use high resolution encoder to improve tracking */
 
-void CenterGuide(double centerra, double centerdec, 
-  int raflag, int decflag, int pmodel)
+/* Predicted signed degrees covered t seconds into a goto of this kind */
+/* The profile of SlewTime with its latency spent before the start     */
+
+static double SlewCovered(int kind, int axis, double distance, double t)
 {
+  auxslew *model;
+  double d, ta, tb, s;
+  
+  model = &auxslews[kind][axis];
+  d = fabs(distance);
+  t -= model->latency;
+  if (d*model->accel < model->rate*model->rate)
+  {
+    ta = sqrt(d/model->accel);
+    tb = ta;
+  }
+  else
+  {
+    ta = model->rate/model->accel;
+    tb = d/model->rate;
+  }
+  
+  if (t <= 0.)
+  {
+    s = 0.;
+  }
+  else if (t < ta)
+  {
+    s = 0.5*model->accel*t*t;
+  }
+  else if (t < tb)
+  {
+    s = 0.5*model->accel*ta*ta + model->accel*ta*(t - ta);
+  }
+  else if (t < ta + tb)
+  {
+    s = d - 0.5*model->accel*(ta + tb - t)*(ta + tb - t);
+  }
+  else
+  {
+    s = d;
+  }
+  return ( (distance < 0.) ? -s : s );
 }
 
-/* Stop tracking if it is running */
 
-void StopTrack(void)
+/* Plan the next leg of a goto from these encoder angles to the target      */
+/* With SLEWTWOPHASE an axis that is not already within twice the standoff   */
+/*   on the approach side of the target makes a fast leg to the standoff of  */
+/*   both axes, and otherwise the slow approach goes to the target           */
+/* Returns the predicted seconds to reach the target and sets the angles     */
+/*   and the kind of goto of the leg                                         */
+
+static double SlewPlan(auxangle *from, auxangle *target, auxangle *leg,
+  int *kind)
 {
+  auxangle now[2], standoff, togo;
+  double t, lead;
+  int axis;
   
-  char slewCmd[] = { 0x50, 0x03, 0x10, 0x06, 0x00, 0x00, 0x00, 0x00 };
-  
-  /* 0x50 is pass through code */
-  /* 0x03 is number of data bytes including msgId */
-  /* 0x10 is the destId for the ra drive */
-  /* 0x06 is the msgId to set a positive drive rate */
-  /* 0x00 is the first of two data bytes for the drive rate */
-  /* 0x00 is the second of two data bytes for the drive rate */
-  /* 0x00 is a null byte */
-  /* 0x00 is a request to send no data back other than the # ack */
-    
-  char inputstr[2048]; 
+  now[0] = from[0];
+  now[1] = from[1];
+  standoff = AuxDegrees(SLEWSTANDOFF);
   
-  /* Test for southern hemisphere */
-  /* Set negative drive rate if we're south of the equator */
+  *kind = ( SLEWFAST ) ? 1 : 0;
+  if ( SLEWTWOPHASE )
+  {
+    *kind = 0;
+    for (axis = 0; axis < 2; axis++)
+    {
+      togo = slewapproach[axis]*AuxWrap(target[axis] - now[axis]);
+      if ( (togo < 0) || (togo > 2*standoff) )
+      {
+        *kind = 1;
+      }
+    }
+  }
+  
+  lead = 0.;
+  for (axis = 0; axis < 2; axis++)
+  {
+    leg[axis] = target[axis];
+    if ( SLEWTWOPHASE && (*kind == 1) )
+    {
+      leg[axis] = AuxWrap(target[axis] - slewapproach[axis]*standoff);
+    }
+    t = SlewTime(*kind, axis, SlewTravel(axis, now[axis], leg[axis]));
+    if ( SLEWTWOPHASE && (*kind == 1) )
+    {
+      t += SlewTime(0, axis, SLEWSTANDOFF);
+    }
+    if (t > lead)
+    {
+      lead = t;
+    }
+  }
+  return (lead);
+}
+
+
+/* Plan the next leg of a goto on a German equatorial mounting             */
+/* The target may be taken from either side of the pier when SlewReachable  */
+/*   allows, and each side directly or by a stop at a waypoint:  the        */
+/*   declination of the target, the hour angle of the target, or the switch */
+/*   position over the pier.  The fastest plan found safe by SlewSafe wins  */
+/*   and the switch position is the last resort when none is.               */
+/* Returns the predicted seconds to reach the target, sets the angles and   */
+/*   kind of goto of the leg, and sets detour if the leg is to a waypoint   */
+
+static double SlewPlanGem(auxangle *target, auxangle *leg, int *kind,
+  int *detour)
+{
+  auxangle now[2], side[2][2], via[3][2], aim[2];
+  double t, best;
+  int s, w, k, fast;
+  
+  now[0] = telencoderaz;
+  now[1] = telencoderalt;
+  
+  /* The same place seen from the other side of the pier */
+  
+  side[0][0] = target[0];
+  side[0][1] = target[1];
+  side[1][0] = AuxWrap(target[0] + AUXHALFTURN);
+  side[1][1] = AuxWrap(-target[1]);
+  
+  fast = ( SLEWTWOPHASE || SLEWFAST ) ? 1 : 0;
+  best = -1.;
+  *detour = FALSE;
+  
+  for (s = 0; s < 2; s++)
+  {
+    if ( (s == 1) && !SlewReachable(side[s]) )
+    {
+      continue;
+    }
+    
+    t = SlewPlan(now, side[s], aim, &k);
+    if ( ((best < 0.) || (t < best)) && SlewSafe(k, now, aim) )
+    {
+      best = t;
+      leg[0] = aim[0];
+      leg[1] = aim[1];
+      *kind = k;
+      *detour = FALSE;
+    }
+    
+    via[0][0] = now[0];
+    via[0][1] = side[s][1];
+    via[1][0] = side[s][0];
+    via[1][1] = now[1];
+    via[2][0] = switchaz;
+    via[2][1] = switchalt;
+    
+    for (w = 0; w < 3; w++)
+    {
+      t = SlewTime(fast, 0, SlewTravel(0, now[0], via[w][0]));
+      if (SlewTime(fast, 1, SlewTravel(1, now[1], via[w][1])) > t)
+      {
+        t = SlewTime(fast, 1, SlewTravel(1, now[1], via[w][1]));
+      }
+      t += GEMDETOURPAUSE + SlewPlan(via[w], side[s], aim, &k);
+      if ( ((best < 0.) || (t < best)) && SlewSafe(fast, now, via[w]) && 
+        SlewSafe(k, via[w], aim) )
+      {
+        best = t;
+        leg[0] = via[w][0];
+        leg[1] = via[w][1];
+        *kind = fast;
+        *detour = TRUE;
+      }
+    }
+  }
+  
+  /* Nothing is safe from here so go over the pier as before */
+  
+  if (best < 0.)
+  {
+    t = SlewTime(fast, 0, SlewTravel(0, now[0], switchaz));
+    if (SlewTime(fast, 1, SlewTravel(1, now[1], switchalt)) > t)
+    {
+      t = SlewTime(fast, 1, SlewTravel(1, now[1], switchalt));
+    }
+    best = t + GEMDETOURPAUSE + SlewPlan(via[2], target, aim, &k);
+    leg[0] = switchaz;
+    leg[1] = switchalt;
+    *kind = fast;
+    *detour = TRUE;
+  }
+  return (best);
+}
+
+
+/* Test whether a GEM may track a target from these encoder angles     */
+/* The counterweight may rise GEMMERIDIAN above level and must leave   */
+/*   GEMMINTRACK of tracking before it gets there                      */
+
+static int SlewReachable(auxangle *target)
+{
+  auxangle limit;
+  int sense;
+  
+  limit = AUXQUARTERTURN + AuxHours(GEMMERIDIAN);
+  sense = (SiteLatitude < 0.) ? -1 : 1;
+  
+  if (abs(target[0]) > limit)
+  {
+    return(FALSE);
+  }
+  
+  if (limit - sense*target[0] < AuxHours(GEMMINTRACK))
+  {
+    return(FALSE);
+  }
+  return(TRUE);
+}
+
+
+/* Test a GEM goto of this kind for a collision at GEMSAFESTEPS moments  */
+/* The axes move on the profiles of the slew time model and the OTA must */
+/*   stay above GEMSAFEALT with the counterweight no more than           */
+/*   GEMMERIDIAN above level, or no worse than where it starts           */
+
+static int SlewSafe(int kind, auxangle *from, auxangle *to)
+{
+  auxangle at[2], limit;
+  double travel[2], t, end, ha, dec, az, alt, lowest;
+  int axis, i;
+  
+  limit = AUXQUARTERTURN + AuxHours(GEMMERIDIAN);
+  if (abs(from[0]) > limit)
+  {
+    limit = abs(from[0]);
+  }
+  
+  EncoderToEquatorial(from[0], from[1], &ha, &dec);
+  EquatorialToHorizontal(ha, dec, &az, &lowest);
+  if (lowest > GEMSAFEALT)
+  {
+    lowest = GEMSAFEALT;
+  }
+  
+  end = 0.;
+  for (axis = 0; axis < 2; axis++)
+  {
+    travel[axis] = SlewTravel(axis, from[axis], to[axis]);
+    t = SlewTime(kind, axis, travel[axis]);
+    if (t > end)
+    {
+      end = t;
+    }
+  }
+  
+  for (i = 1; i <= GEMSAFESTEPS; i++)
+  {
+    t = end*i/GEMSAFESTEPS;
+    at[0] = AuxWrap(from[0] + 
+      AuxDegrees(SlewCovered(kind, 0, travel[0], t)));
+    at[1] = AuxWrap(from[1] + 
+      AuxDegrees(SlewCovered(kind, 1, travel[1], t)));
+    
+    if (abs(at[0]) > limit)
+    {
+      return(FALSE);
+    }
+    
+    EncoderToEquatorial(at[0], at[1], &ha, &dec);
+    EquatorialToHorizontal(ha, dec, &az, &alt);
+    if (alt < lowest)
+    {
+      return(FALSE);
+    }
+  }
+  return(TRUE);
+}
+
+
+/* Send a goto of the kind of SlewPlan to the encoder angles on both axes */
+/* Both drives start without waiting for each other                       */
+/* The slew is timed to refine the slew time model                        */
+/* Note:  fast slews may place large inertial load on the gear train      */
+
+static void SlewSend(int kind, auxangle encoderaz, auxangle encoderalt)
+{
+  char azdata[3], altdata[3];
+  int azstatus, altstatus;
+  int gotocmd;
+  
+  gotocmd = (kind == 1) ? 0x02 : 0x17;
+  SlewStarted(kind, encoderaz, encoderalt);
+  AuxPack(encoderaz, azdata);
+  AuxPack(encoderalt, altdata);
+
+  AuxSubmit(AUXAZM, gotocmd, azdata, 3, NULL, 0, &azstatus, NULL, NULL);
+  AuxSubmit(AUXALT, gotocmd, altdata, 3, NULL, 0, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
+}
+
+
+/* Sample the encoders and test whether both axes have come to rest          */
+/* The speed is found from the previous sample if it is recent or else from  */
+/*   a new one taken SLEWSETTLEPOLL later                                    */
+
+static int SlewSettled(void)
+{
+  auxangle az, alt;
+  timecontext sample;
+  struct timeval start, now;
+  double wait, dt, azspeed, altspeed;
+  
+  if (!AuxGetPosition(&az, &alt, &sample))
+  {
+    slewsettleutc = 0.;
+    return (FALSE);
+  }
+  
+  dt = sample.utc - slewsettleutc;
+  if ( (slewsettleutc == 0.) || (dt > SLEWPOLL) || (dt < SLEWSETTLEPOLL) )
+  {
+  
+    /* Take the next sample after the link has been served a while */
+    
+    if ( (slewsettleutc == 0.) || (dt > SLEWPOLL) )
+    {
+      slewsettled[0] = az;
+      slewsettled[1] = alt;
+      slewsettleutc = sample.utc;
+      dt = 0.;
+    }
+    wait = SLEWSETTLEPOLL - dt;
+    gettimeofday(&start, NULL);
+    do
+    {
+      AuxPump((long) (wait*1.e6));
+      gettimeofday(&now, NULL);
+    }
+    while ( (now.tv_sec - start.tv_sec) + 
+      1.e-6*(now.tv_usec - start.tv_usec) < wait );
+    
+    if (!AuxGetPosition(&az, &alt, &sample))
+    {
+      slewsettleutc = 0.;
+      return (FALSE);
+    }
+    dt = sample.utc - slewsettleutc;
+  }
+  
+  azspeed = fabs(AuxWrap(az - slewsettled[0])/AZCOUNTPERDEG)*3600./dt;
+  altspeed = fabs(AuxWrap(alt - slewsettled[1])/ALTCOUNTPERDEG)*3600./dt;
+  slewsettled[0] = az;
+  slewsettled[1] = alt;
+  slewsettleutc = sample.utc;
+  
+  return ( (azspeed < SLEWSETTLE) && (altspeed < SLEWSETTLE) );
+}
+
+
+/* Test whether the destination was reached                  */
+/* Initiate the next segment if slewphase is greater than 1  */
+/* Reset slewphase when goto has finished a segment          */
+/* Return value is                                           */
+/*   0 -- goto in progress                                   */
+/*   1 -- goto complete within tolerance                     */
+/*   2 -- goto complete but outside tolerance                */
+
+int CheckGoTo(double desRA, double desDec, int pmodel)
+{
+  double telra1, teldec1;
+  double errorRA, errorDec, nowRA, nowDec;
+  double tolra, toldec;
+
+  /* Is the telescope slewing? */
+    
+  if ( GetSlewStatus() == 1 )
+  {
+    /* One or more axes remain in motion */
+    /* Try again later */
+    
+    return(0);
+  }
+  
+  /* Drives report a goto done before the mount has come to rest */
+  /* Wait for the encoders to settle before the next leg or test */
+  
+  if ( (slewphase > 0) && !SlewSettled() )
+  {
+    return(0);
+  }
+  
+  /* Was this one leg of a slew in several segments? */
+  
+  if ( slewphase == 2 )
+  {
+        
+    /* Reset the slew phase and continue to the destination */
+    
+    slewphase = 0;    
+    
+    /* Go to the original destination */
+    /* GoToCoords will set slewphase for the segments that remain */
+        
+    GoToCoords(desRA, desDec, pmodel);
+        
+    /* Return a flag indicating a new goto operation is in progress */
+    
+    return(0);
+  }
+  else if ( slewphase == 1 )
+  {    
+      
+    /* No axes are moving. Insure that tracking is started again. */
+    
+    StartTrack();
+    
+    /* Where are we now? */
+  
+    GetTel(&nowRA, &nowDec, pmodel);
+
+    /* Compare to destination with pre-defined tolerances */
+     
+    telra1 = desRA;
+    teldec1 = desDec;
+        
+    /* RA slew tolerance in hours */
+    
+    tolra = SLEWTOLRA;
+    
+    /* Dec slew tolerance in degrees */
+    
+    toldec = SLEWTOLDEC;
+
+    /* What is the absolute value of the pointing error? */
+  
+    /* Magnitude of RA pointing error in hours */
+    
+    errorRA = fabs(nowRA - telra1);
+    
+    /* Magnitude of Dec pointing error in degrees */
+    
+    errorDec = fabs(nowDec - teldec1);
+  
+    /* Compare and notify whether we are within tolerance */
+
+    if( ( errorRA > tolra ) || ( errorDec > toldec ) )
+    {
+      /* Result of slew is outside acceptable tolerance */
+      /* Signal the calling routine that another goto may be needed */
+    
+      slewphase = 0;
+      return(2);
+    }
+  }    
+  else
+  {
+    /* Unexpected slew phase */
+    /* Reset and return success without a test */
+    /* This should clear errors and enable another slew request from the UI */
+    /* Better would be to flag an error but that might have unintended consequences */
+  
+    slewphase = 0;    
+  } 
+  return(1); 
+}
+
+/* Coordinates and time */
+
+/* Synchronize remote telescope to this UTC */
+
+int SyncTelToUTC(double newutc)
+{
+  return 0;
+}
+
+/* Synchronize remote telescope to this observatory location  */
+
+int SyncTelToLocation(double newlong, double newlat, double newalt)
+{
+  return 0;
+}
+
+/* Synchronize remote telescope to this local sidereal time  */
+
+int SyncTelToLST(double newlst)
+{
+  return 0;
+}
+
+/* Start sidereal tracking                                                    */
+/* StartTrack is aware of the latitude and will set the direction accordingly */
+/* Call StartTrack at least once after the driver has the latitude            */
+/* An alt-az mount tracks the target of the last goto, or else the current    */
+/*   position, with guide rates on both axes                                  */
+
+void StartTrack(void)
+{
+  
+  char slewCmd[] = { 0x50, 0x03, 0x10, 0x06, 0xff, 0x0ff, 0x00, 0x00 };
+  
+  if (telmount == ALTAZ)
+  {
+    TrackStart();
+    return;
+  }
+  
+  /* 0x50 is pass through code */
+  /* 0x03 is number of data bytes including msgId */
+  /* 0x10 is the destId for the ra drive, or 0x11 for declination */
+  /* 0x06 is the msgId to set a positive drive rate */
+  /* 0xff is the first of two data bytes for the sidereal drive rate */
+  /* 0xff is the second of two data bytes for the sidereal drive rate */
+  /* 0x00 is a null byte */
+  /* 0x00 is a request to send no data back other than the # ack */
+
+  /* Test for southern hemisphere */
+  /* Set negative drive rate if we're south of the equator */
+
+  if ( SiteLatitude < 0. )
+  {
+    slewCmd[3] = 0x07;
+  }
+  
+  /* The '#' acknowledgement is collected later by the event loop */
+
+  AuxSend(slewCmd[2], slewCmd[3], slewCmd + 4, 2, "sidereal track");
+} 
+
+/* Use high resolution encoder to improve tracking */
+
+void CenterGuide(double centerra, double centerdec, 
+  int raflag, int decflag, int pmodel)
+{
+}
+
+/* Stop tracking if it is running */
+
+void StopTrack(void)
+{
+  
+  char slewCmd[] = { 0x50, 0x03, 0x10, 0x06, 0x00, 0x00, 0x00, 0x00 };
+  char rateCmd[] = { 0x00, 0x00, 0x00 };
+  
+  if (telmount == ALTAZ)
+  {
+    TrackStop();
+    AuxSend(AUXAZM, 0x06, rateCmd, 3, "azimuth track off");
+    AuxSend(AUXALT, 0x06, rateCmd, 3, "altitude track off");
+    return;
+  }
+  
+  /* 0x50 is pass through code */
+  /* 0x03 is number of data bytes including msgId */
+  /* 0x10 is the destId for the ra drive */
+  /* 0x06 is the msgId to set a positive drive rate */
+  /* 0x00 is the first of two data bytes for the drive rate */
+  /* 0x00 is the second of two data bytes for the drive rate */
+  /* 0x00 is a null byte */
+  /* 0x00 is a request to send no data back other than the # ack */
+    
+  /* Test for southern hemisphere */
+  /* Set negative drive rate if we're south of the equator */
+
+  if ( SiteLatitude < 0. )
+  {
+    slewCmd[3] = 0x07;
+  }  
+
+  /* The '#' acknowledgement is collected later by the event loop */
+  
+  AuxSend(slewCmd[2], slewCmd[3], slewCmd + 4, 2, "sidereal track off");
+}
+
+
+/* Alt-az tracking engine                                                     */
+/*                                                                            */
+/* A timer on the transport event loop calls TrackTick TRACKHZ times a        */
+/* second.  Each update reads the encoders, finds the target in mount         */
+/* azimuth and altitude at the moment of the reading through the pointing     */
+/* model, and sets each drive to the analytic rate of the target plus a       */
+/* correction that takes up the position error in TRACKTIME seconds:          */
+/*                                                                            */
+/*   daz/dt  = w (sin(lat) - cos(lat) cos(az) tan(alt))                      */
+/*   dalt/dt = w cos(lat) sin(az)                                             */
+/*                                                                            */
+/* where w is the sidereal rate and azimuth increases from north to east.     */
+/* An error larger than TRACKLOST means that the mount was moved by another   */
+/* controller, and its new position becomes the target.                       */
+
+static void TrackStart(void)
+{
+  double hz;
+  
+  if (tracking)
+  {
+    return;
+  }
+  
+  if (!TrackTimer(0.))
+  {
+    return;
+  }
+  
+  /* Without a goto target hold the current position */
+  
+  if (!tracktarget)
+  {
+    GetTel(&trackra, &trackdec, trackpmodel);
+  }
+  tracktarget = FALSE;
+  
+  /* Rates that cannot be current so that the first ones are sent */
+  
+  trackrate[0] = 2.*TRACKMAXRATE;
+  trackrate[1] = 2.*TRACKMAXRATE;
+  tracking = TRUE;
+  TrackUpdate();
+  
+  hz = TRACKHZ;
+  if (hz < 1.)
+  {
+    hz = 1.;
+  }
+  else if (hz > 10.)
+  {
+    hz = 10.;
+  }
+  TrackTimer(hz);
+}
+
+
+/* Stop the rate updates and leave the drives at the last rates sent */
+
+static void TrackStop(void)
+{
+  if (!tracking)
+  {
+    return;
+  }
+  tracking = FALSE;
+  tracksatellite = FALSE;
+  TrackTimer(0.);
+}
+
+
+/* Create the timer on the transport event loop if there is none yet */
+/* Arm it to fire hz times a second, or disarm it when hz is 0       */
+/* Returns FALSE if there is no timer                                */
+
+static int TrackTimer(double hz)
+{
+  struct itimerspec its;
+  double period;
+  
+  if (trackfd < 0)
+  {
+    trackfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if ( (trackfd >= 0) && (TransportWatch(trackfd, TrackTick, NULL) < 0) )
+    {
+      close(trackfd);
+      trackfd = -1;
+    }
+    if (trackfd < 0)
+    {
+      fprintf(stderr,"No timer for alt-az tracking\n");
+      return (FALSE);
+    }
+  }
+  
+  memset(&its, 0, sizeof(its));
+  if (hz > 0.)
+  {
+    period = 1./hz;
+    its.it_interval.tv_sec = (time_t) period;
+    its.it_interval.tv_nsec = (long) (1.e9*(period - (time_t) period));
+    its.it_value = its.it_interval;
+  }
+  timerfd_settime(trackfd, 0, &its, NULL);
+  
+  return (TRUE);
+}
+
+
+/* Timer handler on the transport event loop */
+
+static void TrackTick(int fd, void *arg)
+{
+  unsigned long long expirations;
+  
+  if (read(fd, &expirations, sizeof(expirations)) < 0)
+  {
+    return;
+  }
+  if (tracksatellite)
+  {
+    SatelliteUpdate();
+  }
+  else if (tracking)
+  {
+    TrackUpdate();
+  }
+}
+
+
+/* Read the encoders and steer both drives toward the target */
+
+static void TrackUpdate(void)
+{
+  auxangle encoderaz, encoderalt;
+  timecontext sample, *saved;
+  double ra0, dec0, ha0, az, alt;
+  double w, phi, rate[2], error[2], correction;
+  int i;
+  
+  /* An update that cannot read both axes waits for the next one */
+  
+  if (!AuxGetPosition(&encoderaz, &encoderalt, &sample))
+  {
+    return;
+  }
+  
+  /* Target in mount coordinates at the moment of the reading */
+  
+  saved = TimeUse(&sample);
+  PointingToTel(&ra0, &dec0, trackra, trackdec, trackpmodel);
+  TimeUse(saved);
+  ha0 = Map12(sample.lst - ra0);
+  EquatorialToHorizontal(ha0, dec0, &az, &alt);
+  
+  /* Position errors in arcseconds */
+  
+  error[0] = AuxWrap(AuxDegrees(az) - encoderaz)*(1296000./AUXTURN);
+  error[1] = AuxWrap(AuxDegrees(alt) - encoderalt)*(1296000./AUXTURN);
+  
+  if ( (fabs(error[0]) > 3600.*TRACKLOST) || 
+    (fabs(error[1]) > 3600.*TRACKLOST) )
+  {
+    fprintf(stderr,"Telescope was moved and tracks its new position\n");
+    EncoderToEquatorial(encoderaz, encoderalt, &ha0, &dec0);
+    ra0 = Map24(sample.lst - ha0);
+    saved = TimeUse(&sample);
+    PointingFromTel(&trackra, &trackdec, ra0, dec0, trackpmodel);
+    TimeUse(saved);
+    az = encoderaz*(360./AUXTURN);
+    alt = encoderalt*(360./AUXTURN);
+    error[0] = 0.;
+    error[1] = 0.;
+  }
+  
+  /* Analytic rates of the target in arcseconds per second */
+  
+  w = 15.*1.002737909;
+  phi = SiteLatitude*PI/180.;
+  rate[0] = w*(sin(phi) - cos(phi)*cos(az*PI/180.)*tan(alt*PI/180.));
+  rate[1] = w*cos(phi)*sin(az*PI/180.);
+  
+  for (i = 0; i < 2; i++)
+  {
+    correction = error[i]/TRACKTIME;
+    if (correction > TRACKMAXCORR)
+    {
+      correction = TRACKMAXCORR;
+    }
+    else if (correction < -TRACKMAXCORR)
+    {
+      correction = -TRACKMAXCORR;
+    }
+    rate[i] = rate[i] + correction;
+    if (rate[i] > TRACKMAXRATE)
+    {
+      rate[i] = TRACKMAXRATE;
+    }
+    else if (rate[i] < -TRACKMAXRATE)
+    {
+      rate[i] = -TRACKMAXRATE;
+    }
+  }
+  
+  TrackRate(AUXAZM, rate[0]);
+  TrackRate(AUXALT, rate[1]);
+}
+
+
+/* Send a guide rate in arcsec/s to one drive unless within the deadband */
+
+static void TrackRate(int dest, double rate)
+{
+  char data[3];
+  int i;
+  
+  i = dest - AUXAZM;
+  if (fabs(rate - trackrate[i]) < TRACKDEADBAND)
+  {
+    return;
+  }
+  
+  AuxPack((auxangle) floor(fabs(rate)*AUXRATESCALE + 0.5), data);
+  if (AuxSend(dest, (rate < 0.) ? 0x07 : 0x06, data, 3, "tracking rate") == 0)
+  {
+    trackrate[i] = rate;
+  }
+}
+
+
+/* Satellite tracking                                                         */
+/*                                                                            */
+/* The next pass of the satellite above the horizon mask is tabulated in      */
+/* mount azimuth and altitude by SatellitePass, with the nodes the azimuth    */
+/* drive cannot follow near the zenith bridged and, if the altitude axis may  */
+/* go past the zenith, the rest of the pass taken over the top.  A fast goto  */
+/* is sent to the place on the pass it can reach, and from that moment the    */
+/* timer calls SatelliteUpdate SATHZ times a second.  Each update sets the    */
+/* drives to the rate of the pass over the next interval plus                 */
+/*                                                                            */
+/*   SATKP e + SATKI (integral of e dt) + SATKD de/dt                         */
+/*                                                                            */
+/* for the error e between the pass at the time of the encoder reading and    */
+/* the encoders.  Only refraction is applied to the pass.                     */
+/*                                                                            */
+/* Returns 1 if the pass will be tracked and 0 if not                         */
+
+int TrackSatellite(char *line1, char *line2)
+{
+  satellite sat;
+  timecontext now;
+  double telra, teldec;
+  double az, alt, azrate, altrate, lead, t;
+  double countperdeg[2];
+  auxangle here[2], target[2];
+  int i, axis;
+  
+  if (telmount != ALTAZ)
+  {
+    fprintf(stderr,"Satellites are tracked only on alt-az mounts\n");
+    return(0);
+  }
+  
+  if (!SatelliteRead(line1, line2, &sat))
+  {
+    fprintf(stderr,"Satellite elements are not valid for a near Earth orbit\n");
+    return(0);
+  }
+  
+  TimeClock(&now);
+  if (!SatellitePass(&sat, now.utc, &satellitepass))
+  {
+    fprintf(stderr,"Satellite %s has no pass in the next %.0f hours\n", 
+      sat.name, SATSEARCH);
+    return(0);
+  }
+  
+  if (!TrackTimer(0.))
+  {
+    return(0);
+  }
+  
+  /* Stop all mount motion and read the encoders */
+  
+  FullStop();
+  GetTel(&telra, &teldec, RAW);
+  slewphase = 0;
+  
+  /* Meet the pass where the fast goto can reach it and iterate since */
+  /*   the place on the pass changes the time to slew                  */
+  
+  countperdeg[0] = AZCOUNTPERDEG;
+  countperdeg[1] = ALTCOUNTPERDEG;
+  here[0] = telencoderaz;
+  here[1] = telencoderalt;
+  TimeClock(&now);
+  lead = 0.;
+  for (i = 0; i < SLEWLEAD; i++)
+  {
+    satstart = now.utc + lead + SATACQUIRE;
+    if (satstart < satellitepass.rise)
+    {
+      satstart = satellitepass.rise;
+    }
+    SatellitePosition(&satellitepass, satstart, &az, &alt, &azrate, &altrate);
+    target[0] = AuxDegrees(az);
+    target[1] = AuxDegrees(alt);
+    lead = 0.;
+    for (axis = 0; axis < 2; axis++)
+    {
+      t = SlewTime(1, axis, 
+        AuxWrap(target[axis] - here[axis])/countperdeg[axis]);
+      if (t > lead)
+      {
+        lead = t;
+      }
+    }
+  }
+  
+  if (satstart >= satellitepass.set)
+  {
+    fprintf(stderr,"Satellite %s sets before the telescope can reach it\n",
+      sat.name);
+    return(0);
+  }
+  
+  SlewSend(1, target[0], target[1]);
+  
+  /* Rates that cannot be current so that the first ones are sent */
+  
+  saterrorutc = 0.;
+  satintegral[0] = 0.;
+  satintegral[1] = 0.;
+  trackrate[0] = 2.*SATMAXRATE;
+  trackrate[1] = 2.*SATMAXRATE;
+  tracktarget = FALSE;
+  tracking = TRUE;
+  tracksatellite = TRUE;
+  TrackTimer(SATHZ);
+  
+  fprintf(stderr,"Satellite %s tracked in %.0f s for %.0f s to %.1f degrees\n",
+    sat.name, satstart - now.utc, satellitepass.set - satstart, 
+    satellitepass.maxalt);
+  if (satellitepass.keyout > 0)
+  {
+    fprintf(stderr,"Keyhole bridged in %.0f s%s\n",
+      (satellitepass.keyout - satellitepass.keyin)*SATSTEP,
+      (satellitepass.flip < satellitepass.n) ? " over the zenith" : "");
+  }
+  
+  return(1);
+}
+
+
+/* Read the encoders and steer both drives along the satellite pass */
+
+static void SatelliteUpdate(void)
+{
+  auxangle encoderaz, encoderalt;
+  timecontext sample, now;
+  double az, alt, rate[2], error[2], derivative, correction, dt;
+  int i;
+  
+  if (!AuxGetPosition(&encoderaz, &encoderalt, &sample))
+  {
+    return;
+  }
+  
+  /* The goto is still on its way to meet the pass */
+  
+  if (sample.utc < satstart)
+  {
+    return;
+  }
+  
+  if (!SatellitePosition(&satellitepass, sample.utc, &az, &alt, 
+    &rate[0], &rate[1]))
+  {
+    fprintf(stderr,"Satellite pass has ended\n");
+    StopTrack();
+    return;
+  }
+  
+  /* Position errors in arcseconds at the moment of the reading */
+  
+  error[0] = AuxWrap(AuxDegrees(az) - encoderaz)*(1296000./AUXTURN);
+  error[1] = AuxWrap(AuxDegrees(alt) - encoderalt)*(1296000./AUXTURN);
+  
+  /* Rates of the pass midway to the next update */
+  
+  TimeClock(&now);
+  SatellitePosition(&satellitepass, now.utc + 0.5/SATHZ, &az, &alt, 
+    &rate[0], &rate[1]);
+  
+  dt = (saterrorutc > 0.) ? sample.utc - saterrorutc : 0.;
+  for (i = 0; i < 2; i++)
+  {
+    derivative = 0.;
+    if (dt > 0.)
+    {
+      satintegral[i] += error[i]*dt;
+      if (satintegral[i] > SATMAXINT)
+      {
+        satintegral[i] = SATMAXINT;
+      }
+      else if (satintegral[i] < -SATMAXINT)
+      {
+        satintegral[i] = -SATMAXINT;
+      }
+      derivative = (error[i] - saterror[i])/dt;
+    }
+    saterror[i] = error[i];
+    
+    correction = SATKP*error[i] + SATKI*satintegral[i] + SATKD*derivative;
+    if (correction > SATMAXCORR)
+    {
+      correction = SATMAXCORR;
+    }
+    else if (correction < -SATMAXCORR)
+    {
+      correction = -SATMAXCORR;
+    }
+    rate[i] = 3600.*rate[i] + correction;
+    if (rate[i] > SATMAXRATE)
+    {
+      rate[i] = SATMAXRATE;
+    }
+    else if (rate[i] < -SATMAXRATE)
+    {
+      rate[i] = -SATMAXRATE;
+    }
+  }
+  saterrorutc = sample.utc;
+  
+  TrackRate(AUXAZM, rate[0]);
+  TrackRate(AUXALT, rate[1]);
+}
+
+
+/* Full stop */
+
+void FullStop(void)
+
+{  
+  int i;
+  
+  if( GetSlewStatus()==1 )
+  {
+  
+    /* A goto cut short does not time the slew */
+    
+    slewdistance[0] = 0.;
+    slewdistance[1] = 0.;
+    StopSlew(NORTH);
+    StopSlew(SOUTH);
+    StopSlew(EAST);
+    StopSlew(WEST);
+    
+    /* Wait until the encoders show that the drives have come to rest */
+    
+    slewsettleutc = 0.;
+    for (i = 0; i*SLEWSETTLEPOLL < SLEWSETTLEMAX; i++)
+    {
+      if (SlewSettled())
+      {
+        break;
+      }
+    }
+  }
+  StopTrack();
+}
+
+/* Set slew limits control off or on */
+/* Returns 0 once the command is sent and 1 if it could not be sent */
+/* A missing acknowledgement is reported when its deadline passes */
+
+int SetLimits(int limits)
+{
+  int b0;
+  char limitCmd[] = { 0x50, 0x02, 0x10, 0xef, 0x00, 0x00, 0x00, 0x00 };
+
+  /* 0x50 is pass through code */
+  /* 0x02 is number of data bytes including msgId */
+  /* 0x10 is the destId for the RA drive */
+  /* 0xef is the msgId to set hardstop limits state */
+  /* 0x00 is the limits control data byte */
+  /* 0x00 is the second null data byte */
+  /* 0x00 is the third null data byte */
+  /* 0x00 is a request to send no data back other than the # ack */
+  
+  if ( limits == TRUE )
+  {
+    limitCmd[4] = 0x01;  
+    fprintf(stderr,"Limits enabled\n"); 
+  }
+  else
+  {
+    fprintf(stderr,"Limits disabled\n");   
+  }
+     
+  /* Send the command without waiting for the acknowledgement */
+  
+  b0 = 1;
+  
+  if ( AuxSend(AUXAZM, 0xef, limitCmd + 4, 1, "limits") == 0 )
+  {
+    b0 = 0;
+  }
+  return (b0);
+}
+
+
+/* Get status of slew limits control */
+
+int GetLimits(int *limits)
+{
+  char inputstr[1];
+
+  /* 0xee is the msgId to get hardstop limit state */
+  /* The reply is one byte of data and the # ack */
+         
+  /* Send the command and read a response */
+  
+  if ( AuxCommand(AUXAZM, 0xee, NULL, 0, inputstr, 1) != 1 )
+  {
+    *limits = 0;
+    return (1);
+  }
+
+  /* Mask the bytes */
+  
+  if ( (0x000EF & inputstr[0]) == 1 )
+  {
+    *limits = 1;
+  }
+  else
+  {
+    *limits = 0;
+  }
+
+  return (0);
+}
+  
+
+
+/* Control the dew and drive heaters */
+
+void Heater(int heatercmd)
+{
+  char cmdstr[256];
+  sprintf(cmdstr,"setheater %d 1>/dev/null 2>/dev/null", heatercmd);
+  system(cmdstr);   
+}
+
+/* Control the telescope fans */
+
+void Fan(int fancmd)
+{
+  char cmdstr[256];
+  sprintf(cmdstr,"setfan %d 1>/dev/null 2>/dev/null", fancmd);
+  system(cmdstr);    
+}
+
+
+/* Adjust the focus using an external routine */
+/* The routine will time out on its own and report through the status file */
+
+void Focus(int focuscmd, int focusspd)
+{
+  char cmdstr[256];
+  sprintf(cmdstr,"setfocus %d %d  1>/dev/null 2>/dev/null", focuscmd, focusspd);
+  system(cmdstr);  
+}
+
+
+/* Report the current focus reading from the status file */
+
+void GetFocus(double *telfocus)
+{
+  int nread;
+  double current_focus;
+  char cmdstr[256];
+  sprintf(cmdstr,"getfocus 1>/dev/null 2>/dev/null");
+  system(cmdstr);  
+  
+  focusfile = (char*) malloc (MAXPATHLEN);
+  strcpy(focusfile,FOCUSFILE);
+  fp_focus = fopen(focusfile, "r");
+  if (fp_focus == NULL)
+  {
+    return;
+  }
+  
+  nread = fscanf(fp_focus, "%lg", &current_focus);
+  fclose(fp_focus);
+  
+  if (nread !=0)
+  {
+    *telfocus = current_focus;
+  }
+  
+  return;  
+}
+
+
+/* Adjust the rotation */
+
+void Rotate(int rotatecmd, int rotatespd)
+{
+  char cmdstr[256];
+  sprintf(cmdstr,"setrotate %d %d  1>/dev/null 2>/dev/null", rotatecmd, rotatespd);
+  system(cmdstr);
+}
+
+/* Report the rotation setting */
+
+void GetRotate(double *telrotate)
+{
+  int nread;
+  double current_rotate;
+  char cmdstr[256];
+  sprintf(cmdstr,"getrotate 1>/dev/null 2>/dev/null");
+  system(cmdstr);  
+  
+  rotatefile = (char*) malloc (MAXPATHLEN);
+  strcpy(rotatefile,ROTATEFILE);
+  fp_rotate = fopen(rotatefile, "r");
+  if (fp_rotate == NULL)
+  {
+    *telrotate = 0.;
+    return;
+  }
+  
+  nread = fscanf(fp_rotate, "%lg", &current_rotate);
+  fclose(fp_rotate);
+  
+  if (nread !=0)
+  {
+    *telrotate = current_rotate;
+  }
+  
+  return;  
+}
+
+/* Read and report the temperature */
+
+void GetTemperature(double *teltemperature)
+{
+  int nread;
+  double current_temperature;
+  char cmdstr[256];
+  
+  sprintf(cmdstr,"get_temperature  1>/dev/null 2>/dev/null");
+  system(cmdstr);  
+  
+  temperaturefile = (char*) malloc (MAXPATHLEN);
+  strcpy(temperaturefile,TEMPERATUREFILE);
+  fp_temperature = fopen(temperaturefile, "r");
+  if (fp_temperature == NULL)
+  {
+    return;
+  }
+  
+  nread = fscanf(fp_temperature, "%lf", &current_temperature);
+  fclose(fp_temperature);
+  
+  if (nread !=0)
+  {
+    *teltemperature = current_temperature;
+  }
+  
+  return;   
+}
+
+
+/* Time synchronization utilities */
+
+/* Reset the telescope sidereal time */
+
+int  SyncLST(double newTime)
+{		
+  fprintf(stderr,"AUX mode of NexStar uses computer time and site location only \n");
+  return -1;
+}
+
+
+/*  Reset the telescope local time */
+
+int  SyncLocalTime()
+{
+  fprintf(stderr,"AUX mode of NexStar uses computer time only \n");
+  return -1;
+}
+
+
+/* AUX request engine */
+
+/* Test whether request a should take a reply before request b               */
+/* Pass-through replies come back in the order of the commands and carry no  */
+/*   address, so the oldest request takes the next reply even if expired     */
+/* Native replies name their source and message, so requests still waiting   */
+/*   come first and an expired request takes a reply only when none is       */
+/*   waiting, so that a reply that was lost does not cost the requests after */
+/*   it their replies too                                                    */
+
+static int AuxBefore(auxrequest *a, auxrequest *b)
+{
+  if (b == NULL)
+  {
+    return (TRUE);
+  }
+  if ( auxnative && (a->expired != b->expired) )
+  {
+    return (!a->expired);
+  }
+  return (a->seq < b->seq);
+}
+
+
+/* Find the request in flight that the next reply belongs to */
+
+static auxrequest *AuxOldest(void)
+{
+  int i;
+  auxrequest *oldest = NULL;
+
+  for (i = 0; i < AUXWINDOW; i++)
+  {
+    if ( auxtable[i].inuse && AuxBefore(&auxtable[i], oldest) )
+    {
+      oldest = &auxtable[i];
+    }
+  }
+  return (oldest);
+}
+
+
+/* Release a request and report its result to the caller */
+/* A late reply to an expired request is consumed without a report */
+
+static void AuxFinish(auxrequest *req, char *data, int ndata, int status)
+{
+  auxrequest result;
+
+  /* Free the slot first so that the callback may submit a new request */
+
+  result = *req;
+  req->inuse = FALSE;
+
+  /* Late replies count in the histogram too so that it shows the tail */
+
+  if ( (status == AUXDONE) && (result.stat != NULL) )
+  {
+    if (result.sent.tv_sec != 0)
+    {
+      AuxStatRecord(result.stat,
+        (auxreadtime.tv_sec - result.sent.tv_sec)*1000000L +
+        (auxreadtime.tv_usec - result.sent.tv_usec));
+    }
+    result.stat->rxbytes += ndata + (auxnative ? 6 : 1);
+    if (result.expired)
+    {
+      result.stat->late++;
+    }
+    else
+    {
+      result.stat->replies++;
+      if (auxnative && (ndata < result.nreply))
+      {
+        result.stat->shortreplies++;
+      }
+    }
+  }
+
+  if (result.expired)
+  {
+    return;
+  }
+  auxpending--;
+
+  /* A native reply carries its own length */
+
+  if ( (status == AUXDONE) && (result.reply != NULL) )
+  {
+    memset(result.reply, 0, result.nreply);
+    memcpy(result.reply, data, (ndata < result.nreply) ? ndata : result.nreply);
+  }
+  if (result.status != NULL)
+  {
+    *result.status = status;
+  }
+  if (result.done != NULL)
+  {
+    result.done(&result, data, (status == AUXDONE) ? ndata : -1);
+  }
+}
+
+
+/* Report failure of a request whose deadline has passed                    */
+/* The slot is held for another AUXTIMEOUT in case the reply is only late    */
+
+static void AuxExpire(auxrequest *req)
+{
+  auxrequest result;
+
+  if (req->expired)
+  {
+    req->inuse = FALSE;
+    return;
+  }
+
+  fprintf(stderr,"No reply from AUX device 0x%02x to 0x%02x\n",
+    req->dest, req->msgid);
+  if (req->stat != NULL)
+  {
+    req->stat->timeouts++;
+  }
+
+  result = *req;
+  req->expired = TRUE;
+  req->reply = NULL;
+  req->status = NULL;
+  req->done = NULL;
+  req->deadline.tv_sec += AUXTIMEOUT/1000000;
+  req->deadline.tv_usec += AUXTIMEOUT%1000000;
+  if (req->deadline.tv_usec >= 1000000)
+  {
+    req->deadline.tv_sec++;
+    req->deadline.tv_usec -= 1000000;
+  }
+  auxpending--;
+
+  if (result.status != NULL)
+  {
+    *result.status = AUXFAILED;
+  }
+  if (result.done != NULL)
+  {
+    result.done(&result, NULL, -1);
+  }
+}
+
+
+/* Match a reply from device src to message msgid with its request          */
+/* The request for that device and message first in the order of AuxBefore   */
+/*   is completed                                                            */
+/* Returns TRUE if a request was waiting for this reply                     */
+
+static int AuxMatch(int src, int msgid, char *data, int ndata)
+{
+  int i;
+  auxrequest *req = NULL;
+
+  for (i = 0; i < AUXWINDOW; i++)
+  {
+    if ( auxtable[i].inuse && (auxtable[i].dest == src) &&
+      (auxtable[i].msgid == msgid) && AuxBefore(&auxtable[i], req) )
+    {
+      req = &auxtable[i];
+    }
+  }
+
+  if (req == NULL)
+  {
+    return (FALSE);
+  }
+
+  AuxFinish(req, data, ndata, AUXDONE);
+  return (TRUE);
+}
+
+
+/* Submit a command to the AUX request engine                                */
+/*                                                                           */
+/* The command is sent through the hand controller pass-through packet:     */
+/*   0x50, msgLen, destId, msgId, data1-3, responseBytes                     */
+/* or on a native link as an AUX frame from AUXSELF.                        */
+/*                                                                           */
+/* Commands are collected and written together on the next AuxPump or       */
+/* AuxFlush, so that the commands for both axes leave in one write.          */
+/*                                                                           */
+/* Input:                                                                    */
+/*   dest and msgid for the command                                          */
+/*   up to three data bytes                                                  */
+/*   reply buffer for nreply data bytes, or NULL if not needed               */
+/*   status flag set to AUXDONE or AUXFAILED on completion, or NULL          */
+/*   completion callback and its argument, or NULL                           */
+/* Returns 0 if the command was queued and -1 otherwise                      */
+/*                                                                           */
+/* When the window is full this waits for the oldest request to finish.      */
+/* The status flag and reply buffer must remain valid until completion.      */
+
+static int AuxSubmit(int dest, int msgid, char *data, int ndata,
+  char *reply, int nreply, int *status, auxcallback done, void *arg)
+{
+  struct timeval now;
+  auxrequest *req;
+  unsigned char *frame;
+  int i, sum;
+
+  if (status != NULL)
+  {
+    *status = AUXFAILED;
+  }
+
+  if ( (ndata < 0) || (ndata > 3) || (nreply < 0) || (nreply > 4) )
+  {
+    fprintf(stderr,"AUX command 0x%02x outside packet limits\n", msgid);
+    return (-1);
+  }
+
+  /* Take in anything that arrived while the link was idle */
+
+  if (auxpending == 0)
+  {
+    AuxPump(0);
+  }
+
+  /* On a pass-through link a reply still owed to a failed request would  */
+  /* be taken as the reply to this one, so wait until the slots held for   */
+  /* late replies are released and the line has been cleared               */
+
+  for (;;)
+  {
+    req = NULL;
+    for (i = 0; i < AUXWINDOW; i++)
+    {
+      if (auxtable[i].inuse && auxtable[i].expired)
+      {
+        req = &auxtable[i];
+        break;
+      }
+    }
+    if ( auxnative || (req == NULL) )
+    {
+      break;
+    }
+    AuxPump(AUXTIMEOUT);
+  }
+
+  /* Wait for a free slot */
+
+  for (;;)
+  {
+    req = NULL;
+    for (i = 0; i < AUXWINDOW; i++)
+    {
+      if (!auxtable[i].inuse)
+      {
+        req = &auxtable[i];
+        break;
+      }
+    }
+    if (req != NULL)
+    {
+      break;
+    }
+    AuxPump(AUXTIMEOUT);
+  }
+
+  gettimeofday(&now, NULL);
+  req->inuse = TRUE;
+  req->expired = FALSE;
+  req->dest = dest;
+  req->msgid = msgid;
+  req->nreply = nreply;
+  req->reply = reply;
+  req->status = status;
+  req->seq = auxseq++;
+  req->deadline.tv_sec = now.tv_sec + AUXTIMEOUT/1000000;
+  req->deadline.tv_usec = now.tv_usec + AUXTIMEOUT%1000000;
+  if (req->deadline.tv_usec >= 1000000)
+  {
+    req->deadline.tv_sec++;
+    req->deadline.tv_usec -= 1000000;
+  }
+  req->done = done;
+  req->arg = arg;
+  req->sent.tv_sec = 0;
+  req->sent.tv_usec = 0;
+  req->stat = AuxStat(dest, msgid);
+  auxpending++;
+
+  /* Our own goto changes the slew state before any reply says so */
+
+  AuxObserve(AUXSELF, dest, msgid, (unsigned char *) data, ndata);
+
+  if (status != NULL)
+  {
+    *status = AUXPENDING;
+  }
+
+  if (auxntx > (int) sizeof(auxtx) - 16)
+  {
+    AuxFlush();
+  }
+  frame = auxtx + auxntx;
+
+  if (auxnative)
+  {
+
+    /* Frame format:                        */
+    /*   preamble 0x3b                      */
+    /*   length of source through data      */
+    /*   source                             */
+    /*   destination                        */
+    /*   message id                         */
+    /*   message bytes                      */
+    /*   checksum                           */
+
+    frame[0] = 0x3b;
+    frame[1] = ndata + 3;
+    frame[2] = AUXSELF;
+    frame[3] = dest;
+    frame[4] = msgid;
+    for (i = 0; i < ndata; i++)
+    {
+      frame[5+i] = data[i];
+    }
+    sum = 0;
+    for (i = 1; i < ndata + 5; i++)
+    {
+      sum += frame[i];
+    }
+    frame[ndata+5] = (-sum) & 0xff;
+    auxntx += ndata + 6;
+    if (req->stat != NULL)
+    {
+      req->stat->txbytes += ndata + 6;
+    }
+  }
+  else
+  {
+
+    /* Packet format:              */
+    /*   preamble                  */
+    /*   packet length             */
+    /*   destination               */
+    /*   message id                */
+    /*   three message bytes       */
+    /*   number of response bytes  */
+
+    frame[0] = 0x50;
+    frame[1] = ndata + 1;
+    frame[2] = dest;
+    frame[3] = msgid;
+    frame[4] = frame[5] = frame[6] = 0x00;
+    for (i = 0; i < ndata; i++)
+    {
+      frame[4+i] = data[i];
+    }
+    frame[7] = nreply;
+    auxntx += 8;
+    if (req->stat != NULL)
+    {
+      req->stat->txbytes += 8;
+    }
+  }
+
+  return (0);
+}
+
+
+/* Write the commands collected by AuxSubmit */
+/* Requests in flight fail if the link will not take them */
+
+static void AuxFlush(void)
+{
+  struct timeval now;
+  int i;
+
+  if (auxntx == 0)
+  {
+    return;
+  }
+
+  /* Round trips are timed from the write */
+
+  gettimeofday(&now, NULL);
+  for (i = 0; i < AUXWINDOW; i++)
+  {
+    if (auxtable[i].inuse && (auxtable[i].sent.tv_sec == 0))
+    {
+      auxtable[i].sent = now;
+      if (auxtable[i].stat != NULL)
+      {
+        auxtable[i].stat->sent++;
+      }
+    }
+  }
+
+  auxwrites++;
+  auxtxbytes += auxntx;
+  if (TransportWrite(TelPortFD, auxtx, auxntx) != auxntx)
+  {
+    auxwritefail++;
+    fprintf(stderr,"AUX link write failed\n");
+    for (i = 0; i < AUXWINDOW; i++)
+    {
+      if (auxtable[i].inuse && !auxtable[i].expired)
+      {
+        AuxExpire(&auxtable[i]);
+      }
+    }
+  }
+  auxntx = 0;
+}
+
+
+/* Close the link and forget the requests on it                              */
+/* Used when a connection fails as well as on disconnect                     */
+
+static void AuxClose(void)
+{
+  int i;
+
+  TransportUnwatch(TelPortFD);
+  close(TelPortFD);
+  for (i = 0; i < AUXWINDOW; i++)
+  {
+    auxtable[i].inuse = FALSE;
+  }
+  auxpending = 0;
+  auxntx = 0;
+  auxfirst = 0;
+  auxnrx = 0;
+  TelConnectFlag = FALSE;
+}
+
+
+/* Collect replies for requests in flight                                    */
+/* Waits no longer than usec or the earliest deadline for new data           */
+/* Returns the number of requests still in flight                            */
+
+static int AuxPump(long usec)
+{
+  struct timeval now;
+  long wait, left;
+  int nread, i, retire, released;
+  auxrequest *req;
+
+  /* Wait no longer than the earliest deadline */
+
+  wait = usec;
+  gettimeofday(&now, NULL);
+  for (i = 0; i < AUXWINDOW; i++)
+  {
+    if (auxtable[i].inuse)
+    {
+      left = (auxtable[i].deadline.tv_sec - now.tv_sec)*1000000L +
+        (auxtable[i].deadline.tv_usec - now.tv_usec);
+      if (left < wait)
+      {
+        wait = left;
+      }
+    }
+  }
+  if (wait < 0)
+  {
+    wait = 0;
+  }
+
+  AuxFlush();
+
+  /* Frames are decoded where they land in the receive buffer */
+  /* Unframed bytes move to the front only when space runs out */
+
+  if (auxnrx == 0)
+  {
+    auxfirst = 0;
+  }
+  else if (auxfirst + auxnrx > (int) sizeof(auxrx) - 512)
+  {
+    memmove(auxrx, auxrx + auxfirst, auxnrx);
+    auxfirst = 0;
+  }
+
+  if ( (auxfirst + auxnrx < (int) sizeof(auxrx)) &&
+    (TransportWait(TelPortFD, wait) > 0) )
+  {
+    nread = read(TelPortFD, auxrx + auxfirst + auxnrx,
+      sizeof(auxrx) - auxfirst - auxnrx);
+    if (nread > 0)
+    {
+      gettimeofday(&auxreadtime, NULL);
+      auxnrx += nread;
+      auxrxbytes += nread;
+      auxreads++;
+    }
+  }
+
+  AuxFrame();
+
+  /* Expire requests whose deadlines have passed, oldest first */
+
+  gettimeofday(&now, NULL);
+  retire = FALSE;
+  released = FALSE;
+  for (;;)
+  {
+    req = NULL;
+    for (i = 0; i < AUXWINDOW; i++)
+    {
+      if ( auxtable[i].inuse &&
+        ( (now.tv_sec > auxtable[i].deadline.tv_sec) ||
+        ( (now.tv_sec == auxtable[i].deadline.tv_sec) &&
+        (now.tv_usec >= auxtable[i].deadline.tv_usec) ) ) &&
+        ( (req == NULL) || (auxtable[i].seq < req->seq) ) )
+      {
+        req = &auxtable[i];
+      }
+    }
+    if (req == NULL)
+    {
+      break;
+    }
+    if (req->expired)
+    {
+      released = TRUE;
+    }
+    else
+    {
+      retire = !auxnative;
+    }
+    AuxExpire(req);
+  }
+
+  /* Once a pass-through reply is missing the order of the replies behind */
+  /* it is lost, so the requests after it fail with it                    */
+
+  if (retire)
+  {
+    for (i = 0; i < AUXWINDOW; i++)
+    {
+      if (auxtable[i].inuse && !auxtable[i].expired)
+      {
+        AuxExpire(&auxtable[i]);
+      }
+    }
+  }
+
+  /* When the last held slot is released whatever is left of the replies */
+  /* it waited for is discarded with the unread input on the line         */
+
+  if ( released && !auxnative && (AuxOldest() == NULL) )
+  {
+    tcflush(TelPortFD, TCIFLUSH);
+    auxdropped += auxnrx;
+    auxfirst = 0;
+    auxnrx = 0;
+    auxskipped = 0;
+  }
+
+  /* Statistics requested by signal are written outside the handler */
+
+  if (auxstatsrequest)
+  {
+    auxstatsrequest = 0;
+    AuxStatsSave();
+  }
+
+  return (auxpending);
+}
+
+
+/* Split the received byte stream into AUX replies                          */
+/*                                                                           */
+/* Replies come in one of two kinds:                                         */
+/*                                                                           */
+/*   Pass-through replies from the hand controller carry the requested      */
+/*   number of data bytes and a '#' terminator.  They arrive in the order   */
+/*   of the commands and belong to the oldest request in flight.            */
+/*                                                                           */
+/*   Native AUX frames on a network link carry their own addresses and       */
+/*   checksum:                                                               */
+/*     0x3b, length, source, destination, msgId, data, checksum             */
+/*   where length counts source through data and the checksum is the two's  */
+/*   complement of the sum of length through data.                          */
+/*                                                                           */
+/* Only one kind is framed on a link, since a pass-through reply may well    */
+/* begin with 0x3b.                                                          */
+/*                                                                           */
+/* A byte that cannot start either kind of reply is dropped and framing     */
+/* resumes at the next byte, so no good reply behind it is lost.             */
+
+static void AuxFrame(void)
+{
+  auxrequest *req;
+  unsigned char *f;
+  int nframe, sum, i;
+
+  while (auxnrx > 0)
+  {
+    f = auxrx + auxfirst;
+    req = AuxOldest();
+    nframe = 0;
+
+    /* Pass-through reply to the oldest request still waiting */
+
+    if ( !auxnative && (req != NULL) && (auxnrx > req->nreply) &&
+      (f[req->nreply] == '#') )
+    {
+      AuxMatch(req->dest, req->msgid, (char *) f, req->nreply);
+      nframe = req->nreply + 1;
+    }
+
+    /* Native frame */
+
+    else if ( auxnative && (f[0] == 0x3b) )
+    {
+      if (auxnrx < 2)
+      {
+        break;
+      }
+      if ( (f[1] >= 3) && (auxnrx < f[1] + 3) )
+      {
+        break;
+      }
+      else if (f[1] >= 3)
+      {
+        sum = 0;
+        for (i = 1; i < f[1] + 3; i++)
+        {
+          sum += f[i];
+        }
+        if ( (sum & 0xff) == 0 )
+        {
+
+          /* Every frame on the bus tells us something of the drives  */
+          /* Only replies addressed to us complete a request          */
+          /* Echoes of our own commands and traffic between the other */
+          /* devices on the bus are passed over                       */
+
+          AuxObserve(f[2], f[3], f[4], f + 5, f[1] - 3);
+          if (f[3] != AUXSELF)
+          {
+            auxforeign++;
+          }
+          else if (!AuxMatch(f[2], f[4], (char *) f + 5, f[1] - 3))
+          {
+            auxunmatched++;
+          }
+          nframe = f[1] + 3;
+        }
+      }
+    }
+
+    /* Pass-through reply not yet complete */
+
+    else if ( !auxnative && (req != NULL) && (auxnrx <= req->nreply) )
+    {
+      break;
+    }
+
+    if (nframe == 0)
+    {
+      nframe = 1;
+      auxskipped++;
+      auxdropped++;
+    }
+    else if (auxskipped > 0)
+    {
+      fprintf(stderr,"AUX stream resynchronized after %d bytes\n",
+        auxskipped);
+      auxskipped = 0;
+    }
+
+    auxfirst += nframe;
+    auxnrx -= nframe;
+  }
+}
+
+
+/* Wait until the request reporting to this status flag is finished */
+
+static void AuxWait(int *status)
+{
+  struct timeval start, end;
+
+  gettimeofday(&start, NULL);
+  while ( (*status == AUXPENDING) && (auxpending > 0) )
+  {
+    AuxPump(AUXTIMEOUT);
+  }
+  gettimeofday(&end, NULL);
+  auxblocked += (end.tv_sec - start.tv_sec) +
+    1.e-6*(end.tv_usec - start.tv_usec);
+}
+
+
+/* Wait until all requests in flight are finished */
+
+static void AuxDrain(void)
+{
+  struct timeval start, end;
+
+  gettimeofday(&start, NULL);
+  while (auxpending > 0)
+  {
+    AuxPump(AUXTIMEOUT);
+  }
+  gettimeofday(&end, NULL);
+  auxblocked += (end.tv_sec - start.tv_sec) +
+    1.e-6*(end.tv_usec - start.tv_usec);
+}
+
+
+/* Event loop handler for input while no command is waiting */
+
+static void AuxInput(int fd, void *arg)
+{
+  AuxPump(0);
+}
+
+
+/* Send one command and wait for its reply */
+/* Returns the number of reply data bytes or -1 on failure */
+
+static int AuxCommand(int dest, int msgid, char *data, int ndata,
+  char *reply, int nreply)
+{
+  int status;
+
+  if (AuxSubmit(dest, msgid, data, ndata, reply, nreply,
+    &status, NULL, NULL) != 0)
+  {
+    return (-1);
+  }
+  AuxWait(&status);
+
+  return ( (status == AUXDONE) ? nreply : -1 );
+}
+
+
+/* Send a command whose reply is only the acknowledgement                  */
+/*                                                                           */
+/* The command is written at once and the caller goes on.  The reply is     */
+/* collected by the event loop or by the next command on the link, and      */
+/* AuxAcknowledged reports the command by name if its deadline passes.      */
+/* Later commands queue behind it, so the order on the link is kept.        */
+/*                                                                           */
+/* Returns 0 if the command was sent and -1 otherwise                        */
+
+static int AuxSend(int dest, int msgid, char *data, int ndata, char *what)
+{
+  if (AuxSubmit(dest, msgid, data, ndata, NULL, 0, NULL,
+    AuxAcknowledged, what) != 0)
+  {
+    return (-1);
+  }
+  AuxFlush();
+  return (0);
+}
+
+
+/* Completion callback for AuxSend */
 
-  if ( SiteLatitude < 0. )
+static void AuxAcknowledged(auxrequest *req, char *data, int ndata)
+{
+  if (ndata < 0)
   {
-    slewCmd[3] = 0x07;
-  }  
+    fprintf(stderr,"No acknowledgement from telescope %s request\n",
+      (char *) req->arg);
+  }
+}
+
+
+/* Read both drive encoders in one round trip                               */
+/*                                                                           */
+/* The two position queries are sent back to back so that the azimuth and    */
+/* altitude readings belong to the same moment even while slewing.  The     */
+/* sample is taken midway between sending the queries and receiving the      */
+/* last reply, and the time context is taken at that moment.                */
+/*                                                                           */
+/* Returns fixed-point encoder angles and TRUE if both axes were read.       */
+/* An axis that did not reply reads as zero.                                 */
 
-  tcflush(TelPortFD,TCIOFLUSH);
+static int AuxGetPosition(auxangle *encoderaz, auxangle *encoderalt,
+  timecontext *sample)
+{
+  char azstr[4], altstr[4];
+  int azstatus, altstatus;
+  struct timeval sent, received;
+  timecontext now;
+  double delay;
 
-  writen(TelPortFD,slewCmd,8);
+  *encoderaz = 0;
+  *encoderalt = 0;
 
-  /* Look for a '#' acknowledgement of request*/
-  
-  for (;;) 
+  /* Another controller may have just asked for both positions */
+
+  if ( AuxHeard(&auxheard[0].positiontime) &&
+    AuxHeard(&auxheard[1].positiontime) )
   {
-    if ( readn(TelPortFD,inputstr,1,1) ) 
-    {
-      if (inputstr[0] == '#')
-      { 
-        break;
-      }  
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope sidereal track off request\n");
-    }
+    gettimeofday(&received, NULL);
+    TimeClock(&now);
+    delay = ( (received.tv_sec - auxheard[0].positiontime.tv_sec) +
+      (received.tv_sec - auxheard[1].positiontime.tv_sec) ) * 0.5 +
+      ( (received.tv_usec - auxheard[0].positiontime.tv_usec) +
+      (received.tv_usec - auxheard[1].positiontime.tv_usec) ) * 0.5e-6;
+    TimeAt(sample, now.utc - delay);
+    *encoderaz = auxheard[0].position;
+    *encoderalt = auxheard[1].position;
+    auxspared += 2;
+    return (TRUE);
   }
-}
 
+  gettimeofday(&sent, NULL);
+  AuxSubmit(AUXAZM, 0x01, NULL, 0, azstr, 3, &azstatus, NULL, NULL);
+  AuxSubmit(AUXALT, 0x01, NULL, 0, altstr, 3, &altstatus, NULL, NULL);
+  AuxWait(&azstatus);
+  AuxWait(&altstatus);
+  gettimeofday(&received, NULL);
+  TimeClock(&now);
 
-/* Full stop */
+  /* Refer the time context back to the middle of the exchange */
 
-void FullStop(void)
+  delay = 0.5*( (received.tv_sec - sent.tv_sec) +
+    1.e-6*(received.tv_usec - sent.tv_usec) );
+  TimeAt(sample, now.utc - delay);
 
-{  
-  if( GetSlewStatus()==1 )
+  if (azstatus == AUXDONE)
   {
-    StopSlew(NORTH);
-    usleep(250000.);
-    StopSlew(SOUTH);
-    usleep(250000.);
-    StopSlew(EAST);
-    usleep(250000.);
-    StopSlew(WEST);
-    usleep(250000.);
+    *encoderaz = AuxUnpack((unsigned char *) azstr);
   }
-  StopTrack();
+
+  if (altstatus == AUXDONE)
+  {
+    *encoderalt = AuxUnpack((unsigned char *) altstr);
+  }
+
+  return ( (azstatus == AUXDONE) && (altstatus == AUXDONE) );
 }
 
-/* Set slew limits control off or on */
 
-int SetLimits(int limits)
+/* Passive listening                                                         */
+/*                                                                           */
+/* On a native link every frame on the bus reaches us: the replies to our    */
+/* own queries, echoes of our commands, and the traffic of the hand control  */
+/* and of other apps.  Motor replies to their position or slew done queries  */
+/* are kept, and so are the gotos sent to the motors by anyone, including    */
+/* us, since they make a slew state heard earlier out of date.  While both   */
+/* axes have been heard within AUXHEARDAGE our own query is not needed.      */
+/*                                                                           */
+/* Our own replies are not reused, so with no other controller on the bus,   */
+/* or through the hand controller where only our replies are seen, polling   */
+/* behaves as before.                                                        */
+
+static void AuxObserve(int src, int dst, int msgid, unsigned char *data,
+  int ndata)
 {
-  char inputstr[2048];
-  int b0;
-  char limitCmd[] = { 0x50, 0x02, 0x10, 0xef, 0x00, 0x00, 0x00, 0x00 };
+  auxaxis *axis;
 
-  /* 0x50 is pass through code */
-  /* 0x02 is number of data bytes including msgId */
-  /* 0x10 is the destId for the RA drive */
-  /* 0xef is the msgId to set hardstop limits state */
-  /* 0x00 is the limits control data byte */
-  /* 0x00 is the second null data byte */
-  /* 0x00 is the third null data byte */
-  /* 0x00 is a request to send no data back other than the # ack */
-  
-  if ( limits == TRUE )
+  if ( ( (src == AUXAZM) || (src == AUXALT) ) && (dst != AUXSELF) )
   {
-    limitCmd[4] = 0x01;  
-    fprintf(stderr,"Limits enabled\n"); 
+
+    /* Reply from a drive to another controller */
+
+    axis = &auxheard[src - AUXAZM];
+    if ( (msgid == 0x01) && (ndata >= 3) )
+    {
+      axis->position = AuxUnpack(data);
+      axis->positiontime = auxreadtime;
+    }
+    else if ( (msgid == 0x13) && (ndata >= 1) )
+    {
+      axis->slewing = (data[0] == 0x00);
+      axis->slewtime = auxreadtime;
+    }
+    else
+    {
+      return;
+    }
+    auxharvested++;
   }
-  else
+  else if ( (dst == AUXAZM) || (dst == AUXALT) )
   {
-    fprintf(stderr,"Limits disabled\n");   
-  }
-     
-  /* Send the command */
-  writen(TelPortFD,limitCmd,8);
 
-  /* Wait for an acknowledgement */
-  
-  b0 = 1;
-  
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputstr,1,1) ) 
+    /* Command to a drive */
+
+    if ( (msgid == 0x02) || (msgid == 0x17) )
     {
-      if ( inputstr[0] == '#' ) 
-      {
-        b0 = 0;
-        break;
-      }  
+      axis = &auxheard[dst - AUXAZM];
+      axis->slewing = TRUE;
+      gettimeofday(&axis->slewtime, NULL);
     }
-  } 
-  return (b0);
+  }
 }
 
 
-/* Get status of slew limits control */
+/* Test whether a drive state heard at this time may stand for a query */
 
-int GetLimits(int *limits)
+static int AuxHeard(struct timeval *when)
 {
-  char inputstr[2048];
-  int b0, b1;
-  char limitCmd[] = { 0x50, 0x01, 0x10, 0xee, 0x00, 0x00, 0x00, 0x01 };
+  struct timeval now;
+  long age;
 
-  /* 0x50 is pass through code */
-  /* 0x01 is number of data bytes including msgId */
-  /* 0x10 is the destId for the RA drive */
-  /* 0xee is the msgId to get hardstop limit state */
-  /* 0x00 is the first null data byte */
-  /* 0x00 is the second null data byte */
-  /* 0x00 is the third null data byte */
-  /* 0x01 is a request to send one byte data and # ack */
-         
-  /* Send the command */
-  writen(TelPortFD,limitCmd,8);
+  if ( !auxnative || (when->tv_sec == 0) )
+  {
+    return (FALSE);
+  }
+  gettimeofday(&now, NULL);
+  age = (now.tv_sec - when->tv_sec)*1000000L + (now.tv_usec - when->tv_usec);
+  return ( (age >= 0) && (age < AUXHEARDAGE) );
+}
 
-  /* Read a response */
-  readn(TelPortFD,inputstr,2,1);
 
-  /* Mask the bytes */
-  b0 = (0x000EF & inputstr[0]);
-  if ( b0 == 1 )
+/* Open a TCP connection to a WiFi module speaking native AUX frames        */
+/* The address is host or host:port with AUXTCPPORT as the default port    */
+/* Each address is given AUXTIMEOUT to connect so the interface never      */
+/*   waits out the system TCP connect timeout on an unreachable module     */
+/* Returns the socket or -1 on failure                                       */
+
+static int AuxOpenNetwork(char *address)
+{
+  struct addrinfo hints, *result, *rp;
+  struct pollfd pfd;
+  socklen_t len;
+  char host[64];
+  char *port;
+  int fd, flag, flags, err;
+
+  strncpy(host, address, sizeof(host) - 1);
+  host[sizeof(host) - 1] = '\0';
+  port = strchr(host, ':');
+  if (port != NULL)
   {
-    *limits = 1;
+    *port++ = '\0';
   }
   else
   {
-    *limits = 0;
+    port = AUXTCPPORT;
   }
 
-  if (inputstr[1] == '#')
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host, port, &hints, &result) != 0)
   {
-    b1 = 0;
+    return (-1);
   }
-  else
+
+  fd = -1;
+  for (rp = result; rp != NULL; rp = rp->ai_next)
   {
-    b1 = 1;
+    fd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+    if (fd == -1)
+    {
+      continue;
+    }
+    
+    /* Connect without blocking and wait for it no longer than AUXTIMEOUT */
+    
+    flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    if (connect(fd, rp->ai_addr, rp->ai_addrlen) == 0)
+    {
+      fcntl(fd, F_SETFL, flags);
+      break;
+    }
+    if (errno == EINPROGRESS)
+    {
+      pfd.fd = fd;
+      pfd.events = POLLOUT;
+      pfd.revents = 0;
+      err = -1;
+      len = sizeof(err);
+      if ( (poll(&pfd, 1, AUXTIMEOUT/1000) == 1) &&
+        (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0) && (err == 0) )
+      {
+        fcntl(fd, F_SETFL, flags);
+        break;
+      }
+    }
+    close(fd);
+    fd = -1;
   }
-  return (b1);
-}
-  
-
+  freeaddrinfo(result);
 
-/* Control the dew and drive heaters */
+  if (fd == -1)
+  {
+    return (-1);
+  }
 
-void Heater(int heatercmd)
-{
-  char cmdstr[256];
-  sprintf(cmdstr,"setheater %d 1>/dev/null 2>/dev/null", heatercmd);
-  system(cmdstr);   
-}
+  /* Commands are already batched so send each batch at once */
 
-/* Control the telescope fans */
+  flag = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
 
-void Fan(int fancmd)
-{
-  char cmdstr[256];
-  sprintf(cmdstr,"setfan %d 1>/dev/null 2>/dev/null", fancmd);
-  system(cmdstr);    
+  return (fd);
 }
 
 
-/* Adjust the focus using an external routine */
-/* The routine will time out on its own and report through the status file */
-
-void Focus(int focuscmd, int focusspd)
-{
-  char cmdstr[256];
-  sprintf(cmdstr,"setfocus %d %d  1>/dev/null 2>/dev/null", focuscmd, focusspd);
-  system(cmdstr);  
-}
+/* AUX link statistics                                                       */
+/*                                                                           */
+/* Every command is counted under its destination and message id with the    */
+/* bytes it put on the wire, its reply or timeout, and the round trip from   */
+/* the write to the read that brought its reply.  Round trips go into a      */
+/* log-linear histogram in the manner of HdrHistogram: exact below 32 us and */
+/* then 16 buckets for each power of two, so percentiles are good to         */
+/* about 6%.                                                                 */
+/*                                                                           */
+/* The time callers spent blocked waiting on replies is kept as well.  Set   */
+/* against the time connected it shows how much of a goto or of the display  */
+/* update is the link itself.                                                */
+/*                                                                           */
+/* The tables are written to AUXSTATSFILE on SIGUSR1 and on disconnect:      */
+/*                                                                           */
+/*   kill -USR1 `pidof xmtel`                                                */
 
 
-/* Report the current focus reading from the status file */
+/* Find or create the statistics entry for a command */
+/* Returns NULL when the table is full */
 
-void GetFocus(double *telfocus)
+static auxstat *AuxStat(int dest, int msgid)
 {
-  int nread;
-  double current_focus;
-  char cmdstr[256];
-  sprintf(cmdstr,"getfocus 1>/dev/null 2>/dev/null");
-  system(cmdstr);  
-  
-  focusfile = (char*) malloc (MAXPATHLEN);
-  strcpy(focusfile,FOCUSFILE);
-  fp_focus = fopen(focusfile, "r");
-  if (fp_focus == NULL)
+  int i;
+
+  for (i = 0; i < auxnstats; i++)
   {
-    return;
+    if ( (auxstats[i].dest == dest) && (auxstats[i].msgid == msgid) )
+    {
+      return (&auxstats[i]);
+    }
   }
-  
-  nread = fscanf(fp_focus, "%lg", &current_focus);
-  fclose(fp_focus);
-  
-  if (nread !=0)
+  if (auxnstats >= AUXSTATMAX)
   {
-    *telfocus = current_focus;
+    return (NULL);
   }
-  
-  return;  
+  memset(&auxstats[auxnstats], 0, sizeof(auxstat));
+  auxstats[auxnstats].dest = dest;
+  auxstats[auxnstats].msgid = msgid;
+  auxstats[auxnstats].minrtt = -1;
+  return (&auxstats[auxnstats++]);
 }
 
 
-/* Adjust the rotation */
+/* Add a round trip in microseconds to the histogram */
 
-void Rotate(int rotatecmd, int rotatespd)
+static void AuxStatRecord(auxstat *stat, long rtt)
 {
-  char cmdstr[256];
-  sprintf(cmdstr,"setrotate %d %d  1>/dev/null 2>/dev/null", rotatecmd, rotatespd);
-  system(cmdstr);
-}
+  int bucket, msb;
 
-/* Report the rotation setting */
+  if (rtt < 0)
+  {
+    rtt = 0;
+  }
 
-void GetRotate(double *telrotate)
-{
-  int nread;
-  double current_rotate;
-  char cmdstr[256];
-  sprintf(cmdstr,"getrotate 1>/dev/null 2>/dev/null");
-  system(cmdstr);  
-  
-  rotatefile = (char*) malloc (MAXPATHLEN);
-  strcpy(rotatefile,ROTATEFILE);
-  fp_rotate = fopen(rotatefile, "r");
-  if (fp_rotate == NULL)
+  if (rtt < 32)
   {
-    *telrotate = 0.;
-    return;
+    bucket = rtt;
   }
-  
-  nread = fscanf(fp_rotate, "%lg", &current_rotate);
-  fclose(fp_rotate);
-  
-  if (nread !=0)
+  else
   {
-    *telrotate = current_rotate;
+    msb = 5;
+    while ( (rtt >> (msb + 1)) != 0 )
+    {
+      msb++;
+    }
+    bucket = 32 + 16*(msb - 5) + (int) (rtt >> (msb - 4)) - 16;
   }
-  
-  return;  
-}
-
-/* Read and report the temperature */
+  if (bucket >= AUXHISTBUCKETS)
+  {
+    bucket = AUXHISTBUCKETS - 1;
+  }
+  stat->hist[bucket]++;
 
-void GetTemperature(double *teltemperature)
-{
-  int nread;
-  double current_temperature;
-  char cmdstr[256];
-  
-  sprintf(cmdstr,"get_temperature  1>/dev/null 2>/dev/null");
-  system(cmdstr);  
-  
-  temperaturefile = (char*) malloc (MAXPATHLEN);
-  strcpy(temperaturefile,TEMPERATUREFILE);
-  fp_temperature = fopen(temperaturefile, "r");
-  if (fp_temperature == NULL)
+  if ( (stat->minrtt < 0) || (rtt < stat->minrtt) )
   {
-    return;
+    stat->minrtt = rtt;
   }
-  
-  nread = fscanf(fp_temperature, "%lf", &current_temperature);
-  fclose(fp_temperature);
-  
-  if (nread !=0)
+  if (rtt > stat->maxrtt)
   {
-    *teltemperature = current_temperature;
+    stat->maxrtt = rtt;
   }
-  
-  return;   
+  stat->sumrtt += rtt;
 }
 
 
-/* Time synchronization utilities */
+/* Round trip below which the given fraction of replies arrived */
+/* Reported as the upper edge of the histogram bucket in microseconds */
 
-/* Reset the telescope sidereal time */
+static long AuxStatPercentile(auxstat *stat, double fraction)
+{
+  unsigned long total, count, want;
+  long value;
+  int bucket, msb;
 
-int  SyncLST(double newTime)
-{		
-  fprintf(stderr,"AUX mode of NexStar uses computer time and site location only \n");
-  return -1;
+  total = 0;
+  for (bucket = 0; bucket < AUXHISTBUCKETS; bucket++)
+  {
+    total += stat->hist[bucket];
+  }
+  if (total == 0)
+  {
+    return (0);
+  }
+
+  want = (unsigned long) ceil(fraction*total);
+  if (want < 1)
+  {
+    want = 1;
+  }
+  count = 0;
+  for (bucket = 0; bucket < AUXHISTBUCKETS - 1; bucket++)
+  {
+    count += stat->hist[bucket];
+    if (count >= want)
+    {
+      break;
+    }
+  }
+
+  if (bucket < 32)
+  {
+    value = bucket;
+  }
+  else
+  {
+    msb = 5 + (bucket - 32)/16;
+    value = ((long) (16 + (bucket - 32)%16 + 1) << (msb - 4)) - 1;
+  }
+  return ( (value > stat->maxrtt) ? stat->maxrtt : value );
 }
 
 
-/*  Reset the telescope local time */
+/* Clear the statistics at connection */
 
-int  SyncLocalTime()
+static void AuxStatsReset(void)
 {
-  fprintf(stderr,"AUX mode of NexStar uses computer time only \n");
-  return -1;
+  auxnstats = 0;
+  gettimeofday(&auxconnected, NULL);
+  auxblocked = 0.;
+  auxtxbytes = 0;
+  auxrxbytes = 0;
+  auxwrites = 0;
+  auxreads = 0;
+  auxwritefail = 0;
+  auxdropped = 0;
+  auxforeign = 0;
+  auxunmatched = 0;
+  auxharvested = 0;
+  auxspared = 0;
 }
 
 
-/* Serial port utilities */
+/* Write the link and per command statistics */
 
-static int writen(fd, ptr, nbytes)
-int fd;
-char *ptr;
-int nbytes;
+static void AuxStatsWrite(FILE *fp)
 {
-  int nleft, nwritten;
-  nleft = nbytes;
-  while (nleft > 0) 
+  struct timeval now;
+  double elapsed;
+  auxstat *stat;
+  int i;
+
+  gettimeofday(&now, NULL);
+  elapsed = (now.tv_sec - auxconnected.tv_sec) +
+    1.e-6*(now.tv_usec - auxconnected.tv_usec);
+
+  fprintf(fp, "AUX link %s (%s)\n", telserial,
+    auxnative ? "native frames" : "hand controller pass-through");
+  fprintf(fp, "Connected %.1f s, callers blocked %.1f s (%.1f%%)\n",
+    elapsed, auxblocked, (elapsed > 0.) ? 100.*auxblocked/elapsed : 0.);
+  fprintf(fp, "Written %lu bytes in %lu writes, %lu failed\n",
+    auxtxbytes, auxwrites, auxwritefail);
+  fprintf(fp, "Read %lu bytes in %lu reads\n", auxrxbytes, auxreads);
+  fprintf(fp, "Dropped %lu bytes, passed %lu foreign frames, "
+    "%lu unmatched replies\n", auxdropped, auxforeign, auxunmatched);
+  fprintf(fp, "Heard %lu replies to other controllers, spared %lu queries\n",
+    auxharvested, auxspared);
+  fprintf(fp, "\n");
+
+  fprintf(fp, "dest msg     sent  replies timeouts  late short"
+    "   txbytes   rxbytes     min     p50     p90     p99     max    mean\n");
+  for (i = 0; i < auxnstats; i++)
   {
-    nwritten = write (fd, ptr, nleft);
-    if (nwritten <=0 ) break;
-    nleft -= nwritten;
-    ptr += nwritten;
+    stat = &auxstats[i];
+    fprintf(fp, "0x%02x 0x%02x %8lu %8lu %8lu %5lu %5lu %9lu %9lu",
+      stat->dest, stat->msgid, stat->sent, stat->replies, stat->timeouts,
+      stat->late, stat->shortreplies, stat->txbytes, stat->rxbytes);
+    if (stat->minrtt < 0)
+    {
+      fprintf(fp, "\n");
+      continue;
+    }
+    fprintf(fp, " %7ld %7ld %7ld %7ld %7ld %7.0f\n",
+      stat->minrtt, AuxStatPercentile(stat, 0.50),
+      AuxStatPercentile(stat, 0.90), AuxStatPercentile(stat, 0.99),
+      stat->maxrtt, stat->sumrtt/(stat->replies + stat->late));
   }
-  return (nbytes - nleft);
+  fprintf(fp, "\nRound trip times in microseconds from write to reply\n");
 }
 
-static int readn(fd, ptr, nbytes, sec)
-int fd;
-char *ptr;
-int nbytes;
-int sec;
+
+/* Save the statistics in the status file */
+
+static void AuxStatsSave(void)
 {
-  int stat;
-  int nleft, nread;
-  nleft = nbytes;
-  while (nleft > 0) 
+  FILE *fp;
+
+  fp = fopen(AUXSTATSFILE, "w");
+  if (fp == NULL)
   {
-    stat = telstat(fd,sec,0);
-    if (stat <=  0 ) break;
-    nread  = read (fd, ptr, nleft);
-    if (nread <= 0)  break;
-    nleft -= nread;
-    ptr += nread;
+    fprintf(stderr,"Cannot write AUX statistics to %s\n", AUXSTATSFILE);
+    return;
   }
-  return (nbytes - nleft);
+  AuxStatsWrite(fp);
+  fclose(fp);
 }
 
-/* Examines the read status of a file descriptor.                       */
-/* The timeout (sec, usec) specifies a maximum interval to              */
-/* wait for data to be available in the descriptor.                     */
-/* To effect a poll, the timeout (sec, usec) should be 0.               */
-/* Returns non-negative value on data available.                        */
-/* 0 indicates that the time limit referred by timeout expired.         */
-/* On failure, it returns -1 and errno is set to indicate the error.    */
 
-static int telstat(fd,sec,usec)
-register int fd, sec, usec;
-{
-  int ret;
-  int width;
-  struct timeval timeout;
-  telfds readfds;
+/* Request a statistics dump from the next pass through AuxPump */
 
-  memset((char *)&readfds,0,sizeof(readfds));
-  FD_SET(fd, &readfds);
-  width = fd+1;
-  timeout.tv_sec = sec;
-  timeout.tv_usec = usec;
-  ret = select(width,&readfds,NULL_PTR(telfds),NULL_PTR(telfds),&timeout);
-  return(ret);
+static void AuxStatsSignal(int sig)
+{
+  auxstatsrequest = 1;
 }
-
@@ -54,6 +54,10 @@
 #define FOCUSFILE "/usr/local/observatory/status/telfocus"
 #define TEMPERATUREFILE "/usr/local/observatory/status/teltemperature"
 #define ROTATEFILE "/usr/local/observatory/status/rotate"
+
+/* AUX link statistics are written here on SIGUSR1 and on disconnect */
+
+#define AUXSTATSFILE "/usr/local/observatory/status/telauxstats"
 #define MAXPATHLEN 100
 
 /* CDK20 motors are 500 cpr x 5.9 gear x 3 cog x 360 worm = 3,186,000  cpr    */
@@ -63,11 +67,15 @@
 /* Dec: 24 bits = 360 degrees                                                 */
 /* RA: 24 bits = 24 hours                                                     */
 
-#define ALTCOUNTPERDEG 46603.3778      
-#define AZCOUNTPERDEG  46603.3778
+#define AUXTURN        16777216
+#define ALTCOUNTPERDEG (AUXTURN/360.)
+#define AZCOUNTPERDEG  (AUXTURN/360.)
 
 /* The protocol requires 24 bit counters                                      */
-/* Search for 16777    in protocol.c to see where this is used                */
+/* Axis positions are fixed-point angles of AUXTURN counts per turn held     */
+/* signed from -AUXTURN/2 to AUXTURN/2 - 1 so that they wrap as the counters */
+
+typedef int auxangle;
        
 /* Set this for maximum slew rate in degree/sec for some controllers          */
 /* A very safe choice is 2 but it takes a long time to slew at this rate      */
@@ -171,9 +179,120 @@
 
 #define SLEWTOLRA  0.006667  /* 0.1/15 hour    or 24 seconds of time   */
 #define SLEWTOLDEC 0.1       /* 0.1    degree  or  6 minutes of arc    */
-#define SLEWFAST   0         /* Set to 1 for fast slew with caution !! */
+#define SLEWFAST   0         /* 1 for fast, with caution !!, if SLEWTWOPHASE is 0 */
 
 /* Slew software limits                                                       */
 
 #define MINTARGETALT   10.   /* Minimum target altitude in degrees */
 
+/* Slew time model                                                            */
+/* The time for a goto on each axis is predicted from a trapezoidal profile   */
+/* with the top rate and acceleration of the drive and a fixed latency, and   */
+/* the mount is sent to where the target will be when the slower axis         */
+/* arrives.  The top rate of a fast goto is read from the drive.  Each slew   */
+/* that is watched to its end refines the model.                              */
+
+#define SLEWFASTRATE   4.    /* Fast goto rate in deg/s until the drive tells */
+#define SLEWSLOWRATE   1.    /* Slow goto rate in deg/s */
+#define SLEWACCEL      2.    /* Acceleration in deg/s^2 */
+#define SLEWLATENCY    1.    /* Seconds added to every slew */
+#define SLEWLEAD       3     /* Iterations for the time of arrival */
+#define SLEWFORGET     0.8   /* Weight kept by earlier slews at each new one */
+#define SLEWSPREAD     5.    /* Spread in degrees of slews to fit the rate */
+#define SLEWPOLL       2.    /* Longest seconds between polls to time a slew */
+
+/* Two phase goto                                                             */
+/* A fast goto stops short of the target by SLEWSTANDOFF on each axis, on the */
+/* side the drive approaches from, and a slow goto takes up the rest so that  */
+/* the gears are always loaded the same way at the end.  A leg is done when   */
+/* both encoders move slower than SLEWSETTLE.  The fast leg, and any leg to a */
+/* waypoint on a GEM, may place a large inertial load on the gear train, so   */
+/* this is off unless chosen here.  With SLEWTWOPHASE 0 every goto is one of  */
+/* the kind set by SLEWFAST, and SLEWFAST 0 keeps them all slow.              */
+
+#define SLEWTWOPHASE   0     /* Set to 1 for a fast leg with caution !! */
+#define SLEWSTANDOFF   1.    /* Degrees short of the target for the fast leg */
+#define SLEWSETTLE     60.   /* Encoder speed in arcsec/s of a settled axis */
+#define SLEWSETTLEPOLL 0.1   /* Seconds between encoder samples when settling */
+#define SLEWSETTLEMAX  5.    /* Longest seconds for a stopped mount to settle */
+
+/* German equatorial slews                                                    */
+/* A target within GEMMERIDIAN of the meridian may be taken from either side  */
+/* of the pier when the counterweight, rising no more than GEMMERIDIAN above  */
+/* level, leaves GEMMINTRACK of tracking.  The side and route with the        */
+/* shortest predicted time are used from those on which the OTA stays above   */
+/* GEMSAFEALT at GEMSAFESTEPS moments of the slew.  A stop at a waypoint is   */
+/* made only when no direct slew is safe.                                     */
+
+#define GEMMERIDIAN    0.5   /* Hours the counterweight may rise past level */
+#define GEMMINTRACK    0.25  /* Hours of tracking left after a slew */
+#define GEMSAFEALT     -10.  /* Lowest altitude in degrees during a slew */
+#define GEMSAFESTEPS   32    /* Moments of a slew tested for safety */
+#define GEMDETOURPAUSE 2.    /* Seconds lost to the stop at a waypoint */
+
+/* Alt-az tracking engine                                                     */
+/* Both drives are steered with guide rates found from the analytic rates of  */
+/* the target in azimuth and altitude and a correction for the position       */
+/* error read from the encoders.  A change of rate smaller than the deadband  */
+/* is not sent.                                                               */
+
+#define TRACKHZ        4.    /* Rate updates per second from 1 to 10 */
+#define TRACKDEADBAND  0.05  /* Smallest change of rate sent in arcsec/s */
+#define TRACKTIME      4.    /* Seconds to take up a position error */
+#define TRACKMAXCORR   60.   /* Largest correction in arcsec/s */
+#define TRACKMAXRATE   3600. /* Largest guide rate in arcsec/s */
+#define TRACKLOST      0.5   /* Error in degrees when the mount was moved */
+
+/* Satellite tracking                                                         */
+/* An alt-az mount follows a pass tabulated from two-line elements.  A fast   */
+/* goto meets the pass SATACQUIRE seconds after it could arrive, and from     */
+/* then on the drives are steered SATHZ times a second with the rate of the   */
+/* pass over the next update plus a PID correction of the encoder error.      */
+
+#define SATHZ          10.   /* Rate updates per second */
+#define SATACQUIRE     5.    /* Seconds to spare after the goto arrives */
+#define SATKP          2.    /* Proportional gain per second */
+#define SATKI          0.5   /* Integral gain per second squared */
+#define SATKD          0.05  /* Derivative gain */
+#define SATMAXINT      600.  /* Largest integrated error in arcsec s */
+#define SATMAXCORR     1800. /* Largest correction in arcsec/s */
+#define SATMAXRATE     14400. /* Largest guide rate in arcsec/s */
+
+/* AUX device identifiers                                                     */
+
+#define AUXAZM     0x10      /* RA/Azimuth motor controller */
+#define AUXALT     0x11      /* Dec/Altitude motor controller */
+#define AUXSELF    0x20      /* Our source address on a native AUX link */
+
+/* Native AUX link over the network                                           */
+/* A telserial that does not begin with '/' is taken as host or host:port     */
+/* of a SkyQLink or NexStar Evolution WiFi module speaking raw AUX frames.    */
+
+#define AUXTCPPORT "2000"    /* Default AUX port on the WiFi module */
+
+/* AUX request engine                                                         */
+/* Several commands may be in flight on the link at the same time.            */
+/* Replies are matched to their requests by destination and message id.       */
+
+#define AUXWINDOW  4         /* Maximum number of commands in flight */
+#define AUXTIMEOUT 2000000   /* Reply deadline in microseconds */
+
+/* Passive listening on a native link                                         */
+/* The mainboard repeats all AUX traffic on every port.  Positions and slew   */
+/* states in the replies to other controllers are kept, and our own query is  */
+/* skipped while both axes have been heard within AUXHEARDAGE microseconds.   */
+
+#define AUXHEARDAGE 200000
+
+/* Guide rates for MC_SET_POS_GUIDERATE and MC_SET_NEG_GUIDERATE are 24 bit   */
+/* counts of 1/1024 arcsec per second                                         */
+
+#define AUXRATESCALE 1024.
+
+
+/* AUX link statistics                                                        */
+/* Round trip times are kept per destination and message id in log-linear     */
+/* histograms with 16 sub-buckets per octave, about 6% resolution.            */
+
+#define AUXSTATMAX     32    /* Distinct destination and message id pairs */
+#define AUXHISTBUCKETS 384   /* Covers round trips up to 2^27 microseconds */
@@ -8,8 +8,8 @@
 /*                                                                            */
 /* John Kielkopf (kielkopf@louisville.edu)                                    */
 /*                                                                            */
-/* Date: July 22, 2012                                                        */
-/* Version: 6.0                                                               */
+/* Date: October 16, 2026                                                     */
+/* Version: 6.1                                                               */
 /*                                                                            */
 /* History:                                                                   */
 /*                                                                            */
@@ -83,6 +83,11 @@
 /* July 1, 2012                                                               */
 /*   Version 6.0                                                              */
 /*   Leapsecond incremented to 35.0                                           */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 6.1                                                              */
+/*   Serial reads and waits use the shared epoll transport                    */
+/*   Acknowledgements are awaited no longer than ACKTIMEOUT                   */
 
 
 #include <stdio.h>
@@ -99,8 +104,8 @@
 #include <termios.h>
 #include <math.h>
 #include "protocol.h"
+#include "transport.h"
 
-#define NULL_PTR(x) (x *)0
 
 #ifndef TRUE
 #define TRUE 1
@@ -144,6 +149,7 @@ void CenterGuide(double centerra, double centerdec,
   int raflag, int decflag, int pmodel);
 void StopTrack(void);
 void FullStop(void);
+int  TrackSatellite(char *line1, char *line2);
 
 /* Coordinates and time */
 
@@ -205,11 +211,9 @@ char *rotatefile;
 static int TelPortFD;
 static int TelConnectFlag = FALSE;
 
-typedef fd_set telfds;
-
 static int readn(int fd, char *ptr, int nbytes, int sec);
 static int writen(int fd, char *ptr, int nbytes);
-static int telstat(int fd,int sec,int usec);
+static int ReadAck(char *what);
 
 /* End of prototype and variable definitions */
 
@@ -302,6 +306,10 @@ void ConnectTel(void)
 
   tcflush(TelPortFD,TCIOFLUSH);
 
+  /* Stray input between commands is discarded by the event loop */
+
+  TransportWatch(TelPortFD, NULL, NULL);
+
   /* Test connection */
 
   writen(TelPortFD,"Kx",2);
@@ -370,7 +378,6 @@ void SetRate(int newRate)
 void StartSlew(int direction)
 {
   char slewCmd[] = { 0x50, 0x02, 0x11, 0x24, 0x09, 0x00, 0x00, 0x00 };
-  char inputStr[2048];
   
   if(direction == NORTH)
     {
@@ -401,17 +408,7 @@ void StartSlew(int direction)
 
   /* Look for '#' acknowledgement of request*/
 
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StartSlew.\n");
-    }
-  }   
+  ReadAck("StartSlew");
 }
 
 
@@ -420,7 +417,6 @@ void StartSlew(int direction)
 void StopSlew(int direction)
 {
   char slewCmd[] = { 0x50, 0x02, 0x11, 0x24, 0x00, 0x00, 0x00, 0x00 };
-  char inputStr[2048];
   
   if(direction == NORTH)
     {
@@ -447,24 +443,17 @@ void StopSlew(int direction)
 
   /* Look for '#' acknowledgement of request*/
 
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StopSlew.\n");
-    }
-  }  
+  ReadAck("StopSlew");
 }
 
 void DisconnectTel(void)
 {
   /* printf("DisconnectTel\n"); */
   if(TelConnectFlag == TRUE)
+  {
+    TransportUnwatch(TelPortFD);
     close(TelPortFD);
+  }
   TelConnectFlag = FALSE;
 }
 
@@ -805,8 +794,6 @@ void StartTrack(void)
   /* 0x00 is a null byte */
   /* 0x00 is a request to send no data back other than the # ack */
 
-  char inputStr[2048];
-  
   /* Test for southern hemisphere */
   /* Set negative drive rate if we're south of the equator */
 
@@ -819,17 +806,7 @@ void StartTrack(void)
 
   /* Look for '#' acknowledgement of request */
 
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StartTrack.\n");
-    }
-  }  
+  ReadAck("StartTrack");
 
 } 
 
@@ -856,8 +833,6 @@ void StopTrack(void)
   /* 0x00 is a null byte */
   /* 0x00 is a request to send no data back other than the # ack */
     
-  char inputStr[2048]; 
-  
   /* Test for southern hemisphere */
   /* Set negative drive rate if we're south of the equator */
 
@@ -870,17 +845,7 @@ void StopTrack(void)
 
   /* Look for a '#' acknowledgement of request*/
   
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StopTrack.\n");
-    }
-  }
+  ReadAck("StopTrack");
 }
 
 
@@ -905,11 +870,18 @@ void FullStop(void)
   StopTrack();
 }
 
+/* Satellites are tracked with streamed rates only by the AUX driver */
+
+int TrackSatellite(char *line1, char *line2)
+{
+  fprintf(stderr,"NexStar hand controller does not track satellites.\n");
+  return 0;
+}
+
 /* Set slew limits control off or on */
 
 int SetLimits(int limits)
 {
-  char inputStr[2048];
   int b0;
   char limitCmd[] = { 0x50, 0x02, 0x10, 0xef, 0x00, 0x00, 0x00, 0x00 };
 
@@ -939,17 +911,10 @@ int SetLimits(int limits)
   
   b0 = 1;
   
-  for (;;) 
+  if ( ReadAck("SetLimits") )
   {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if ( inputStr[0] == '#' ) 
-      {
-        b0 = 0;
-        break;
-      }  
-    }
-  } 
+    b0 = 0;
+  }
   return (b0);
 }
 
@@ -1139,74 +1104,54 @@ void GetTemperature(double *teltemperature)
 
 
 /* Serial port utilities */
+/* Reads and writes go through the shared transport event loop */
 
 static int writen(fd, ptr, nbytes)
 int fd;
 char *ptr;
 int nbytes;
 {
-  int nleft, nwritten;
-  nleft = nbytes;
-  while (nleft > 0) 
-  {
-    nwritten = write (fd, ptr, nleft);
-    if (nwritten <=0 ) break;
-    nleft -= nwritten;
-    ptr += nwritten;
-  }
-  return (nbytes - nleft);
+  return ( TransportWrite(fd, ptr, nbytes) );
 }
 
+/* Read nbytes allowing at most sec seconds for all of them */
+
 static int readn(fd, ptr, nbytes, sec)
 int fd;
 char *ptr;
 int nbytes;
 int sec;
 {
-  int stat;
-  int nleft, nread;
-  nleft = nbytes;
-  while (nleft > 0) 
-  {
-    stat = telstat(fd,sec,0);
-    if (stat <=  0 ) break;
-    nread  = read (fd, ptr, nleft);
+  return ( TransportRead(fd, ptr, nbytes, sec*1000000L) );
+}
 
-/*  Diagnostic */    
-    
-/*    printf("readn: %d read\n", nread);  */
 
-    if (nread <= 0)  break;
-    nleft -= nread;
-    ptr += nread;
-  }
-  return (nbytes - nleft);
-}
+/* Wait for the '#' acknowledgement of a pass-through command              */
+/* Other bytes before it are skipped                                       */
+/* Gives up ACKTIMEOUT microseconds after the call so a silent mount        */
+/* cannot hold up the caller                                               */
+/* Returns TRUE on acknowledgement and FALSE otherwise                     */
 
-/*
- * Examines the read status of a file descriptor.
- * The timeout (sec, usec) specifies a maximum interval to
- * wait for data to be available in the descriptor.
- * To effect a poll, the timeout (sec, usec) should be 0.
- * Returns non-negative value on data available.
- * 0 indicates that the time limit referred by timeout expired.
- * On failure, it returns -1 and errno is set to indicate the
- * error.
- */
-static int telstat(fd,sec,usec)
-register int fd, sec, usec;
+static int ReadAck(char *what)
 {
-  int ret;
-  int width;
-  struct timeval timeout;
-  telfds readfds;
-
-  memset((char *)&readfds,0,sizeof(readfds));
-  FD_SET(fd, &readfds);
-  width = fd+1;
-  timeout.tv_sec = sec;
-  timeout.tv_usec = usec;
-  ret = select(width,&readfds,NULL_PTR(telfds),NULL_PTR(telfds),&timeout);
-  return(ret);
-}
+  struct timeval start, now;
+  long left;
+  char c;
 
+  gettimeofday(&start, NULL);
+  for (;;)
+  {
+    gettimeofday(&now, NULL);
+    left = ACKTIMEOUT - ( (now.tv_sec - start.tv_sec)*1000000L +
+      (now.tv_usec - start.tv_usec) );
+    if ( (left <= 0) || (TransportRead(TelPortFD, &c, 1, left) != 1) )
+    {
+      fprintf(stderr,"No acknowledgement from telescope in %s.\n", what);
+      return (FALSE);
+    }
+    if (c == '#')
+    {
+      return (TRUE);
+    }
+  }
+}
@@ -65,6 +65,10 @@
 
 #define MAXSLEWRATE	4 	/* 2 for safety; 4 for speed; 8 otherwise. */
 
+/* Longest wait in microseconds for the '#' acknowledgement of a command */
+
+#define ACKTIMEOUT	1000000
+
 /* Site parameters are no longer defined here.  Use the driver program header. */    
 
 /* The difference between terrestrial and ephemeris time is determined */
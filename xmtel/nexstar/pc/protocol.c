@@ -17,6 +17,11 @@
 /*   Version 1.0                                                              */
 /*                                                                            */
 /*   Derived from XmTel 5.0.2 for NexStar HC version 5.0                      */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 1.1                                                              */
+/*   Serial reads and waits use the shared epoll transport                    */
+/*   Acknowledgements are awaited no longer than ACKTIMEOUT                   */
 
 
 #include <stdio.h>
@@ -33,8 +38,8 @@
 #include <termios.h>
 #include <math.h>
 #include "protocol.h"
+#include "transport.h"
 
-#define NULL_PTR(x) (x *)0
 
 #ifndef TRUE
 #define TRUE 1
@@ -62,6 +67,7 @@ void StopSlew(int direction);
 void StartTrack(void);
 void StopTrack(void);
 void FullStop(void);
+int  TrackSatellite(char *line1, char *line2);
 
 /* Coordinates and time */
 
@@ -116,11 +122,9 @@ static int focuscount;      /* Used to keep a focus position count */
 static int TelPortFD;
 static int TelConnectFlag = FALSE;
 
-typedef fd_set telfds;
-
 static int readn(int fd, void *ptr, int nbytes, int sec);
 static int writen(int fd, void *ptr, int nbytes);
-static int telstat(int fd,int sec,int usec);
+static int ReadAck(char *what);
 void checksum(unsigned char* packet, int start, int stop);
 
 /* End of prototype and variable definitions */
@@ -228,6 +232,10 @@ void ConnectTel(void)
 
   tcflush(TelPortFD,TCIOFLUSH);
 
+  /* Stray input between commands is discarded by the event loop */
+
+  TransportWatch(TelPortFD, NULL, NULL);
+
   /* Test connection by asking for the firmware version */
   /* Response for our C20 will be 53.51 for either axis */
   
@@ -318,7 +326,6 @@ void SetRate(int newRate)
 void StartSlew(int direction)
 {
   char slewCmd[] = { 0x50, 0x02, 0x11, 0x24, 0x09, 0x00, 0x00, 0x00 };
-  char inputStr[2048];
   
   if(direction == NORTH)
     {
@@ -349,17 +356,7 @@ void StartSlew(int direction)
 
   /* Look for '#' acknowledgement of request*/
 
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StartSlew.\n");
-    }
-  }   
+  ReadAck("StartSlew");
 }
 
 
@@ -368,7 +365,6 @@ void StartSlew(int direction)
 void StopSlew(int direction)
 {
   char slewCmd[] = { 0x50, 0x02, 0x11, 0x24, 0x00, 0x00, 0x00, 0x00 };
-  char inputStr[2048];
   
   if(direction == NORTH)
     {
@@ -395,24 +391,17 @@ void StopSlew(int direction)
 
   /* Look for '#' acknowledgement of request*/
 
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StopSlew.\n");
-    }
-  }  
+  ReadAck("StopSlew");
 }
 
 void DisconnectTel(void)
 {
   /* printf("DisconnectTel\n"); */
   if(TelConnectFlag == TRUE)
+  {
+    TransportUnwatch(TelPortFD);
     close(TelPortFD);
+  }
   TelConnectFlag = FALSE;
 }
 
@@ -781,8 +770,6 @@ void StartTrack(void)
   /* 0x00 is a null byte */
   /* 0x00 is a request to send no data back other than the # ack */
 
-  char inputStr[2048];
-  
   /* Test for southern hemisphere */
   /* Set negative drive rate if we're south of the equator */
 
@@ -795,17 +782,7 @@ void StartTrack(void)
 
   /* Look for '#' acknowledgement of request */
 
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StartTrack.\n");
-    }
-  }  
+  ReadAck("StartTrack");
 
 } 
 
@@ -826,8 +803,6 @@ void StopTrack(void)
   /* 0x00 is a null byte */
   /* 0x00 is a request to send no data back other than the # ack */
     
-  char inputStr[2048]; 
-  
   /* Test for southern hemisphere */
   /* Set negative drive rate if we're south of the equator */
 
@@ -840,17 +815,7 @@ void StopTrack(void)
 
   /* Look for a '#' acknowledgement of request*/
   
-  for (;;) 
-  {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if (inputStr[0] == '#') break;
-    }
-    else 
-    { 
-      fprintf(stderr,"No acknowledgement from telescope in StopTrack.\n");
-    }
-  }
+  ReadAck("StopTrack");
 }
 
 
@@ -875,11 +840,18 @@ void FullStop(void)
   StopTrack();
 }
 
+/* Satellites are tracked with streamed rates only by the AUX driver */
+
+int TrackSatellite(char *line1, char *line2)
+{
+  fprintf(stderr,"NexStar PC port driver does not track satellites.\n");
+  return 0;
+}
+
 /* Set slew limits control off or on */
 
 int SetLimits(int limits)
 {
-  char inputStr[2048];
   int b0;
   char limitCmd[] = { 0x50, 0x02, 0x10, 0xef, 0x00, 0x00, 0x00, 0x00 };
 
@@ -909,17 +881,10 @@ int SetLimits(int limits)
   
   b0 = 1;
   
-  for (;;) 
+  if ( ReadAck("SetLimits") )
   {
-    if ( readn(TelPortFD,inputStr,1,1) ) 
-    {
-      if ( inputStr[0] == '#' ) 
-      {
-        b0 = 0;
-        break;
-      }  
-    }
-  } 
+    b0 = 0;
+  }
   return (b0);
 }
 
@@ -1237,27 +1202,18 @@ int  SyncLocalTime()
 }
 
 
-/* Write serial port utility */
+/* Serial port utilities */
+/* Reads and writes go through the shared transport event loop */
 
 static int writen(fd, ptr, nbytes)
 int fd;
 void *ptr;
 int nbytes;
 {
-  int nleft, nwritten;
-  nleft = nbytes;
-  while (nleft > 0) 
-  {
-    nwritten = write (fd, ptr, nleft);
-    if (nwritten <=0 ) break;
-    nleft -= nwritten;
-    ptr += nwritten;
-  }
-  return (nbytes - nleft);
+  return ( TransportWrite(fd, ptr, nbytes) );
 }
 
-
-/* Read serial port utility */
+/* Read nbytes allowing at most sec seconds for all of them */
 
 static int readn(fd, ptr, nbytes, sec)
 int fd;
@@ -1265,49 +1221,7 @@ void *ptr;
 int nbytes;
 int sec;
 {
-  int stat;
-  int nleft, nread;
-  nleft = nbytes;
-  while (nleft > 0) 
-  {
-    stat = telstat(fd,sec,0);
-    if (stat <=  0 ) break;
-    nread  = read (fd, ptr, nleft);
-
-/*  Diagnostic */    
-    
-/*    printf("readn: %d read\n", nread);  */
-
-    if (nread <= 0)  break;
-    nleft -= nread;
-    ptr += nread;
-  }
-  return (nbytes - nleft);
-}
-
-
-/* Examines the read status of a file descriptor.                  */
-/* The timeout (sec, usec) specifies a maximum wait interval.      */
-/* To effect a poll, the timeout (sec, usec) should be 0.          */
-/* Returns >0 on data available.                                   */
-/* Returns =0 if timeout expired.                                  */
-/* Returns <0 on failure.                                          */
- 
-static int telstat(fd,sec,usec)
-register int fd, sec, usec;
-{
-  int ret;
-  int width;
-  struct timeval timeout;
-  telfds readfds;
-
-  memset((char *)&readfds,0,sizeof(readfds));
-  FD_SET(fd, &readfds);
-  width = fd+1;
-  timeout.tv_sec = sec;
-  timeout.tv_usec = usec;
-  ret = select(width,&readfds,NULL_PTR(telfds),NULL_PTR(telfds),&timeout);
-  return(ret);
+  return ( TransportRead(fd, ptr, nbytes, sec*1000000L) );
 }
 
 /* Set checksum from packet[start] through packet[stop] in packet[stop+1] */
@@ -1328,3 +1242,34 @@ void  checksum(unsigned char* packet, int start, int stop)
   *packet = -cksum;
   return;
 }
+
+
+/* Wait for the '#' acknowledgement of a pass-through command              */
+/* Other bytes before it are skipped                                       */
+/* Gives up ACKTIMEOUT microseconds after the call so a silent mount        */
+/* cannot hold up the caller                                               */
+/* Returns TRUE on acknowledgement and FALSE otherwise                     */
+
+static int ReadAck(char *what)
+{
+  struct timeval start, now;
+  long left;
+  char c;
+
+  gettimeofday(&start, NULL);
+  for (;;)
+  {
+    gettimeofday(&now, NULL);
+    left = ACKTIMEOUT - ( (now.tv_sec - start.tv_sec)*1000000L +
+      (now.tv_usec - start.tv_usec) );
+    if ( (left <= 0) || (TransportRead(TelPortFD, &c, 1, left) != 1) )
+    {
+      fprintf(stderr,"No acknowledgement from telescope in %s.\n", what);
+      return (FALSE);
+    }
+    if (c == '#')
+    {
+      return (TRUE);
+    }
+  }
+}
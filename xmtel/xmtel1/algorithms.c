@@ -7,8 +7,8 @@
 /*                                                                            */
 /* Distributed under the terms of the General Public License (see LICENSE)    */
 /*                                                                            */
-/* Date: January 24, 2012                                                     */
-/* Version: 1.3                                                               */
+/* Date: October 16, 2026                                                     */
+/* Version: 1.4                                                               */
 /*                                                                            */
 /* History:                                                                   */
 /*                                                                            */
@@ -45,6 +45,15 @@
 /*     Version 1.3                                                            */
 /*     Corrected error in Proper Motion for RA                                */
 /*                                                                            */
+/*   October 16, 2026                                                         */
+/*     Version 1.4                                                            */
+/*     JDNow, LSTNow and UTNow read a time context from a monotonic clock     */
+/*     Apparent holds one moment for precession, nutation and aberration      */
+/*     Apparent applies a rotation and aberration vector kept for an epoch    */
+/*     Batch transformations over arrays of coordinates                       */
+/*     Horizon mask and visibility over arrays of targets                     */
+/*     Nutation from the full IAU 1980 series kept for the last epoch         */
+/*                                                                            */
 /*                                                                            */
 /******************************************************************************/
 /*                                                                            */
@@ -91,7 +100,6 @@
 #include <stdio.h>
 #include <math.h>
 #include <time.h>
-#include <sys/time.h>
 #include "algorithms.h"
 
 
@@ -128,6 +136,8 @@ void ProperMotion(double epoch, double *ra, double *dec,
 
 void Precession(double *ra, double *dec, int dirflag);
 void Apparent(double *ra, double *dec, int dirflag);  
+apparentplace *ApparentPlace(void);
+static void ApparentBuild(apparentplace *ap, double jd);
 
 /* EOD corrections */
 
@@ -138,6 +148,27 @@ void Aberration(double *ra, double *dec, int dirflag);
 
 void EquatorialToHorizontal(double ha, double dec, double *az, double *alt);
 void HorizontalToEquatorial(double az, double alt, double *ha, double *dec);
+
+/* Batch transformations of arrays */
+
+void ApparentBatch(double *ra, double *dec, int n, int dirflag);
+void ProperMotionBatch(double epoch, double *ra, double *dec, 
+  double *pm_ra, double *pm_dec, int n);
+void EquatorialToHorizontalBatch(double *ha, double *dec, 
+  double *az, double *alt, int n);
+void HorizontalToEquatorialBatch(double *az, double *alt, 
+  double *ha, double *dec, int n);
+
+/* Horizon and visibility */
+
+void HorizonClear(void);
+void HorizonPoint(double az, double alt);
+double HorizonAltitude(double az);
+int VisibleBatch(double *ra, double *dec, int n, double lst, 
+  double minalt, unsigned char *visible);
+int ObservableBatch(double *ra, double *dec, int n, double lst, 
+  double hours, double minalt, double *rises);
+static void HorizonBuild(void);
 void CelestialToEcliptical(double ra, double dec, double *lambda, double *beta);
 void EclipticalToCelestial(double lambda, double beta, double *ra, double *dec);
 
@@ -147,6 +178,7 @@ double TrueObliquity(void);
 double MeanObliquity(void);
 double NObliquity(void);
 double NLongitude(void);
+static void NutationSeries(double t, double *dpsi, double *deps);
 double LongitudeSun(void);
 double Eccentricity(void);
 double LongitudePerihelion(void);
@@ -191,64 +223,19 @@ double CalcJD(int ny, int nm, int nd, double ut)
 }
 
 
-/* Calculate the Julian date with millisecond resolution */
+/* Julian date of the current time context */
 
 double JDNow(void)
 {
-  int year, month, day;
-  int hours, minutes, seconds, milliseconds;
-  long int usecs;
-
-  double ut, jd;
-  time_t now;
-  struct timeval t;
-  struct tm *g;
-  
-  /* Use gettimeofday and timeval to capture microseconds */
+  timecontext now;
   
-  gettimeofday(&t,NULL);
-  
-  /* Copy seconds part to convert to UTC */
-  
-  now = t.tv_sec;
-  
-  /* Save microseconds part to handle milliseconds of UTC */
-  
-  usecs = t.tv_usec; 
-
-  /* Convert unix time now to utc */
-  
-  g=gmtime(&now);
-
-  /* Copy values pointed to by g to variables we will use later */
-
-  year = g->tm_year;
-  year = year + 1900;
-  month = g->tm_mon;
-  month = month + 1;
-  day = g->tm_mday;
-  hours = g->tm_hour;
-  minutes = g->tm_min;
-  seconds = g->tm_sec;
-  
-  /* Convert the microseconds part to milliseconds */
-  
-  milliseconds = usecs/1000;
-
-  /* Calculate floating point ut in hours */
-
-  ut = ( (double) milliseconds )/3600000. +
-    ( (double) seconds )/3600. + 
-    ( (double) minutes )/60. + 
-    ( (double) hours );   
-
-  jd = CalcJD(year, month, day, ut);
+  TimeNow(&now);
   
   /* To test for specific jd change this value and uncomment */
   
-  /* jd = 2462088.69;  */
+  /* now.jd = 2462088.69;  */
     
-  return (jd) ;
+  return (now.jd) ;
 }
 
 
@@ -276,114 +263,144 @@ double CalcLST(int year, int month, int day, double ut, double glong)
 }
 
 
-/* Calculate the local sidereal time with millisecond resolution */
+/* Local sidereal time of the current time context */
 
 double LSTNow(void)
 {
+  timecontext now;
+  
+  TimeNow(&now);
+  return (now.lst) ;
+}
 
-  int year, month, day;
-  int hours, minutes, seconds, milliseconds;
-  long int usecs;
 
-  double glong;    
-  double ut, lst;
-  time_t now;
-  struct timeval t;
-  struct tm *g;
-  
-  extern double SiteLongitude;
-  
-  /* Use gettimeofday and timeval to capture microseconds */
-  
-  gettimeofday(&t,NULL);
-  
-  /* Copy seconds part to convert to UTC */
-  
-  now = t.tv_sec;
-  
-  /* Save microseconds part to handle milliseconds of UTC */
-  
-  usecs = t.tv_usec; 
+/* Universal time in hours of the current time context */
 
-  /* Convert unix time now to utc */
+double UTNow(void)
+{
+  timecontext now;
   
-  g=gmtime(&now);
+  TimeNow(&now);
+  return (now.ut) ;
+}
 
-  /* Copy values pointed to by g to variables we will use later */
 
-  year = g->tm_year;
-  year = year + 1900;
-  month = g->tm_mon;
-  month = month + 1;
-  day = g->tm_mday;
-  hours = g->tm_hour;
-  minutes = g->tm_min;
-  seconds = g->tm_sec;
+/* Time context                                                              */
+/*                                                                           */
+/* JDNow, LSTNow and UTNow, and through them the obliquity, nutation and     */
+/* solar longitude series, read the time context in use.  A conversion that  */
+/* calls them several times holds one context for its duration so that all  */
+/* of its steps work with the same moment:                                   */
+/*                                                                           */
+/*   timecontext now, *saved;                                                */
+/*                                                                           */
+/*   TimeNow(&now);                                                          */
+/*   saved = TimeUse(&now);                                                  */
+/*   ...                                                                     */
+/*   TimeUse(saved);                                                         */
+/*                                                                           */
+/* With no context in use they read the clock each time as before.          */
+/*                                                                           */
+/* The clock is the monotonic clock anchored to UTC from the system clock    */
+/* every TIMEANCHOR seconds.  Between anchors a reading costs one system     */
+/* call and a few multiplications, with no calendar conversion.              */
+
+static timecontext *timeinuse = NULL;   /* Context held by the caller */
+
+
+/* Read the clock into a new time context */
+
+void TimeClock(timecontext *tc)
+{
+  static int anchored = 0;
+  static struct timespec anchormono;
+  static double anchorutc;
+  struct timespec mono, real;
+  double elapsed;
   
-  /* Convert the microseconds part to milliseconds */
+  clock_gettime(CLOCK_MONOTONIC, &mono);
+  elapsed = (mono.tv_sec - anchormono.tv_sec) + 
+    1.e-9*(mono.tv_nsec - anchormono.tv_nsec);
   
-  milliseconds = usecs/1000;
-
-  /* Calculate floating point ut in hours */
+  /* Anchor again so that steps of the system clock are followed */
+  
+  if ( !anchored || (elapsed < 0.) || (elapsed > TIMEANCHOR) )
+  {
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    anchorutc = real.tv_sec + 1.e-9*real.tv_nsec;
+    anchormono = mono;
+    anchored = 1;
+    elapsed = 0.;
+  }
+  
+  TimeAt(tc, anchorutc + elapsed);
+}
 
-  ut = ( (double) milliseconds )/3600000. +
-    ( (double) seconds )/3600. + 
-    ( (double) minutes )/60. + 
-    ( (double) hours );
 
-  glong = SiteLongitude; 
+/* The time context in use, or a new reading of the clock if none */
 
-  lst = CalcLST(year, month, day, ut, glong);
-    
-  return (lst) ;
+void TimeNow(timecontext *tc)
+{
+  if (timeinuse != NULL)
+  {
+    *tc = *timeinuse;
+  }
+  else
+  {
+    TimeClock(tc);
+  }
 }
 
-/* Calculate the universal time in hours with millisecond resolution */
 
-double UTNow(void)
+/* Fill a time context for utc in seconds since 1970 January 1.0 */
+/* The sidereal time is for the current SiteLongitude            */
+
+void TimeAt(timecontext *tc, double utc)
 {
-  int hours,minutes,seconds,milliseconds;
-  long int usecs;
+  double days, jd0;
+  double TU, TU2, TU3, T0, gmst;
 
-  double ut;
-  time_t now;
-  struct timeval t;
-  struct tm *g;
+  extern double SiteLongitude;
   
-  /* Use gettimeofday and timeval to capture microseconds */
+  days = floor(utc/86400.);
   
-  gettimeofday(&t,NULL);
+  tc->utc = utc;
+  tc->ut = (utc - 86400.*days)/3600.;
   
-  /* Copy seconds part to convert to UTC */
+  /* JD 2440587.5 is 1970 January 1.0 */
   
-  now = t.tv_sec;
+  jd0 = 2440587.5 + days;
+  tc->jd = jd0 + tc->ut/24.;
+  tc->t = (tc->jd - 2451545.0) / 36525.0;
   
-  /* Save microseconds part to handle milliseconds of UTC */
+  /* Sidereal time as in CalcLST */
   
-  usecs = t.tv_usec; 
-
-  /* Convert unix time now to utc */
-  
-  g=gmtime(&now);
-
-  /* Copy values pointed to by g to variables we will use later */
+  TU = (jd0 - 2451545.0) / 36525.0;
+  TU2 = TU * TU;
+  TU3 = TU2 * TU;
+  T0 =
+      (24110.54841 / 3600.0) +
+      8640184.812866 / 3600.0 * TU + 0.093104 / 3600.0 * TU2 -
+      6.2e-6 / 3600.0 * TU3;
+  T0 = Map24(T0);
 
-  hours = g->tm_hour;
-  minutes = g->tm_min;
-  seconds = g->tm_sec;
-  
-  /* Convert the microseconds part to milliseconds */
-  
-  milliseconds = usecs/1000;
+  gmst = Map24(T0 + tc->ut * 1.002737909);
+  tc->lst = 24.0 * frac((gmst - SiteLongitude / 15.0) / 24.0);
+}
 
-  /* Calculate floating point ut in hours */
 
-  ut = ( (double) milliseconds )/3600000. +
-    ( (double) seconds )/3600. + 
-    ( (double) minutes )/60. + 
-    ( (double) hours );   
+/* Use a time context for JDNow, LSTNow and UTNow until the next call    */
+/* A NULL context returns them to the clock                              */
+/* Returns the context that was in use so that the caller can restore it */
 
-  return (ut) ;
+timecontext *TimeUse(timecontext *tc)
+{
+  timecontext *saved;
+  
+  saved = timeinuse;
+  timeinuse = tc;
+  return (saved);
 }
 
 
@@ -752,6 +769,11 @@ void PrecessToEpoch(double epoch, double *ra, double *dec)
  *   1. Allow for precession by converting from catalog epoch to the EOD
  *   2. Add nutation for the EOD 
  *   3. Add stellar aberration for the EOD
+ *
+ *   Steps 1 and 2 are one rotation of the unit vector to the object and
+ *     step 3 adds the velocity of the Earth to it.  Both are kept by
+ *     ApparentPlace for an epoch and rebuilt every APPARENTREFRESH
+ *     seconds, so a conversion needs no series evaluations.
  *   
  * Additional corrections for atmospheric refraction and
  *   telescope pointing errors should be added if needed 
@@ -764,9 +786,9 @@ void PrecessToEpoch(double epoch, double *ra, double *dec)
  *   Pointers to ra and dec 
  *   Integer flag > 0 for from J2000 to EOD  and < 0 for from EOD to J2000
  *
- *   The forward transformation is exact but the inverse transformation
- *     requires iterating stellar aberration and is done only approximately
- *     in the aberration routine.
+ *   The forward transformation is exact.  The inverse removes aberration
+ *     by iterating the forward transformation, which converges to well
+ *     under a milliarcsecond in two steps.
  * 
  * Output:
  *   In place pointers to modified ra and dec 
@@ -775,58 +797,125 @@ void PrecessToEpoch(double epoch, double *ra, double *dec)
  
 void Apparent(double *ra, double *dec, int dirflag)
 {
+  ApparentBatch(ra, dec, 1, dirflag);
+}
 
-  double tmpra, tmpdec;
-  
-  /* Create local copies of the ra and dec and work on these copies */
 
-  tmpra = *ra;
-  tmpdec = *dec;
-        
-  if(dirflag > 0)
-  {
-      
-    /* Precess ra and dec to the EOD */
+/* The apparent place engine for this moment                        */
+/* Rebuilt when the time in use is more than APPARENTREFRESH seconds */
+/*   from the epoch it was built for                                */
+
+apparentplace *ApparentPlace(void)
+{
+  static apparentplace ap = { 0. };
+  timecontext now, *saved;
   
-    Precession(&tmpra, &tmpdec, 1);
-      
-    /* Include nutation for ra and dec */
-      
-    Nutation(&tmpra, &tmpdec, 1);
-      
-    /* Include aberration for ra and dec */
-     
-    Aberration(&tmpra, &tmpdec, 1);
+  TimeNow(&now);
+  if ( (ap.jd == 0.) || 
+    (fabs(now.jd - ap.jd)*86400. > APPARENTREFRESH) )
+  {
+    saved = TimeUse(&now);
+    ApparentBuild(&ap, now.jd);
+    TimeUse(saved);
+  }
   
-    /* Return the new EOD coordinates that are in the local variables */
+  return (&ap);
+}
 
-    *ra = tmpra;
-    *dec = tmpdec;
-  }
-  else if (dirflag < 0)
+
+/* Build the rotation and aberration vector for the time context in use */
+/* The series are those of PrecessToEOD, Nutation and Aberration        */
+
+static void ApparentBuild(apparentplace *ap, double jd)
+{
+  double zeta, z, theta, t;
+  double dpsi, eps0, eps;
+  double ka, glsun, ec, lp, vx, vy;
+  double p[3][3], n[3][3];
+  double cz, sz, cze, sze, cth, sth;
+  double cp, sp, ce0, se0, ce, se;
+  int i, j, k;
+  
+  /* Precession from J2000 with the angles of PrecessToEOD in radians */
+  
+  t = (jd - 2451545.0) / 36525.0;
+  zeta = (2306.2181*t + 0.30188*t*t + 0.017998*t*t*t) * PI / (180.*3600.);
+  z = (2306.2181*t + 1.09468*t*t + 0.018203*t*t*t) * PI / (180.*3600.);
+  theta = (2004.3109*t - 0.42665*t*t - 0.041833*t*t*t) * PI / (180.*3600.);
+  
+  cze = cos(zeta);
+  sze = sin(zeta);
+  cz = cos(z);
+  sz = sin(z);
+  cth = cos(theta);
+  sth = sin(theta);
+  
+  p[0][0] = cze*cth*cz - sze*sz;
+  p[0][1] = -sze*cth*cz - cze*sz;
+  p[0][2] = -sth*cz;
+  p[1][0] = cze*cth*sz + sze*cz;
+  p[1][1] = -sze*cth*sz + cze*cz;
+  p[1][2] = -sth*sz;
+  p[2][0] = cze*sth;
+  p[2][1] = -sze*sth;
+  p[2][2] = cth;
+  
+  /* Nutation in longitude and obliquity in radians */
+  
+  dpsi = NLongitude()*PI/180.;
+  eps0 = MeanObliquity()*PI/180.;
+  eps = eps0 + NObliquity()*PI/180.;
+  
+  cp = cos(dpsi);
+  sp = sin(dpsi);
+  ce0 = cos(eps0);
+  se0 = sin(eps0);
+  ce = cos(eps);
+  se = sin(eps);
+  
+  n[0][0] = cp;
+  n[0][1] = -sp*ce0;
+  n[0][2] = -sp*se0;
+  n[1][0] = sp*ce;
+  n[1][1] = cp*ce*ce0 + se*se0;
+  n[1][2] = cp*ce*se0 - se*ce0;
+  n[2][0] = sp*se;
+  n[2][1] = cp*se*ce0 - ce*se0;
+  n[2][2] = cp*se*se0 + ce*ce0;
+  
+  /* Combined rotation */
+  
+  for (i = 0; i < 3; i++)
   {
+    for (j = 0; j < 3; j++)
+    {
+      ap->m[i][j] = 0.;
+      for (k = 0; k < 3; k++)
+      {
+        ap->m[i][j] += n[i][k]*p[k][j];
+      }
+    }
+  }
   
-    /* Remove aberration to EOD from J2000 */
-  
-    Aberration(&tmpra, &tmpdec, -1);
+  /* Velocity of the Earth in the ecliptic from the constant of aberration */
+  /*   with the eccentricity term, then turned to the equator             */
   
-    /* Remove nutation to EOD from J2000 */
+  ka = 20.49552 * PI / (180.*3600.);
+  glsun = LongitudeSun()*PI/180.;
+  ec = Eccentricity();
+  lp = LongitudePerihelion()*PI/180.;
   
-    Nutation(&tmpra, &tmpdec, -1);
+  vx = ka*(sin(glsun) - ec*sin(lp));
+  vy = ka*(-cos(glsun) + ec*cos(lp));
   
-    /* Remove precession to EOD from J2000 */
+  ap->v[0] = vx;
+  ap->v[1] = vy*ce0;
+  ap->v[2] = vy*se0;
   
-    Precession(&tmpra, &tmpdec, -1);
-
-    /* Return the J2000 coordinates that are in the local variables */
-  
-    *ra = tmpra;
-    *dec = tmpdec;  
-  }
+  ap->jd = jd;
 }
 
 
-
 /* Evaluate proper motion to EOD for coordinates in the catalog epoch 
  * Call this in the form ProperMotion(epoch,&ra,&dec,pm_ra,pm_dec)
  * Units of 
@@ -1224,6 +1313,434 @@ void EclipticalToCelestial(double lambda, double beta, double *ra, double *dec)
 }
 
 
+/* Batch transformations                                                    */
+/*                                                                           */
+/* These work on structure of arrays buffers, one array for each coordinate, */
+/* so that a whole catalog or observing queue is converted in one call.     */
+/* Quantities that depend only on the time or the site are found once for   */
+/* the batch, and the loops have no calls other than the math library and   */
+/* no data dependent branches, so that the compiler may vectorize them.     */
+/* Output arrays may be the same as the input arrays.                       */
+
+
+/* Map x to 0 <= x < period without a loop */
+
+static double Wrap(double x, double period)
+{
+  x = x - period*floor(x/period);
+  return ( (x >= period) ? x - period : x );
+}
+
+
+/* Apparent coordinates in place for n entries of ra and dec */
+/* Integer flag > 0 for from J2000 to EOD and < 0 for from EOD to J2000 */
+
+void ApparentBatch(double *ra, double *dec, int n, int dirflag)
+{
+  apparentplace *ap;
+  double m00, m01, m02, m10, m11, m12, m20, m21, m22;
+  double v0, v1, v2;
+  double a, d, cd, x, y, z, ux, uy, uz, px, py, pz, wx, wy, wz;
+  double dot, norm;
+  int i, iter;
+  
+  if ((n <= 0) || (dirflag == 0))
+  {
+    return;
+  }
+  
+  ap = ApparentPlace();
+  m00 = ap->m[0][0]; m01 = ap->m[0][1]; m02 = ap->m[0][2];
+  m10 = ap->m[1][0]; m11 = ap->m[1][1]; m12 = ap->m[1][2];
+  m20 = ap->m[2][0]; m21 = ap->m[2][1]; m22 = ap->m[2][2];
+  v0 = ap->v[0];
+  v1 = ap->v[1];
+  v2 = ap->v[2];
+  
+  if (dirflag > 0)
+  {
+    for (i = 0; i < n; i++)
+    {
+      a = ra[i]*PI/12.;
+      d = dec[i]*PI/180.;
+      cd = cos(d);
+      x = cd*cos(a);
+      y = cd*sin(a);
+      z = sin(d);
+      
+      /* Precess and nutate to the EOD */
+      
+      ux = m00*x + m01*y + m02*z;
+      uy = m10*x + m11*y + m12*z;
+      uz = m20*x + m21*y + m22*z;
+      
+      /* Include aberration */
+      
+      dot = ux*v0 + uy*v1 + uz*v2;
+      wx = ux + v0 - dot*ux;
+      wy = uy + v1 - dot*uy;
+      wz = uz + v2 - dot*uz;
+      
+      ra[i] = Wrap(atan2(wy, wx)*12./PI, 24.);
+      dec[i] = atan2(wz, sqrt(wx*wx + wy*wy))*180./PI;
+    }
+  }
+  else
+  {
+    for (i = 0; i < n; i++)
+    {
+      a = ra[i]*PI/12.;
+      d = dec[i]*PI/180.;
+      cd = cos(d);
+      ux = cd*cos(a);
+      uy = cd*sin(a);
+      uz = sin(d);
+      
+      /* Remove aberration to first order and refine on the forward step */
+      
+      dot = ux*v0 + uy*v1 + uz*v2;
+      px = ux - v0 + dot*ux;
+      py = uy - v1 + dot*uy;
+      pz = uz - v2 + dot*uz;
+      for (iter = 0; iter < 2; iter++)
+      {
+        dot = px*v0 + py*v1 + pz*v2;
+        wx = px + v0 - dot*px;
+        wy = py + v1 - dot*py;
+        wz = pz + v2 - dot*pz;
+        norm = 1./sqrt(wx*wx + wy*wy + wz*wz);
+        px = px + ux - wx*norm;
+        py = py + uy - wy*norm;
+        pz = pz + uz - wz*norm;
+      }
+      
+      /* Remove nutation and precession with the transposed rotation */
+      
+      x = m00*px + m10*py + m20*pz;
+      y = m01*px + m11*py + m21*pz;
+      z = m02*px + m12*py + m22*pz;
+      
+      ra[i] = Wrap(atan2(y, x)*12./PI, 24.);
+      dec[i] = atan2(z, sqrt(x*x + y*y))*180./PI;
+    }
+  }
+}
+
+
+/* Proper motion to EOD in place for n entries in the same catalog epoch */
+/* Units as for ProperMotion                                            */
+
+void ProperMotionBatch(double epoch, double *ra, double *dec, 
+  double *pm_ra, double *pm_dec, int n)
+{
+  double jdfixed, T, r, d, over;
+  int i;
+  
+  if (n <= 0)
+  {
+    return;
+  }
+  
+  /* Elapsed JD years from the epoch as in ProperMotion */
+  
+  jdfixed = CalcJD ( (int) epoch, 1, 1, 12.0 ) + frac(epoch)*365.25;
+  T = (JDNow() - jdfixed)/365.25;
+  
+  for (i = 0; i < n; i++)
+  {
+    r = ra[i] + T*pm_ra[i]/3600.;
+    d = dec[i] + T*pm_dec[i]/3600.;
+    
+    /* Reflect through a pole to the other side of the sky */
+    
+    over = ( (d > 90.) || (d < -90.) ) ? 1. : 0.;
+    d = (d > 90.) ? 180. - d : d;
+    d = (d < -90.) ? -180. - d : d;
+    
+    ra[i] = Wrap(r + 12.*over, 24.);
+    dec[i] = d;
+  }
+}
+
+
+/* Local az and alt for n entries of local ha and dec */
+/* As EquatorialToHorizontal with azimuth from north through east */
+
+void EquatorialToHorizontalBatch(double *ha, double *dec, 
+  double *az, double *alt, int n)
+{
+  double sphi, cphi, h, d, sd, cd, ch;
+  int i;
+  extern double SiteLatitude;
+  
+  sphi = sin(SiteLatitude*PI/180.);
+  cphi = cos(SiteLatitude*PI/180.);
+  
+  for (i = 0; i < n; i++)
+  {
+    h = ha[i]*PI/12.;
+    d = dec[i]*PI/180.;
+    sd = sin(d);
+    cd = cos(d);
+    ch = cos(h);
+    alt[i] = asin(sphi*sd + cphi*cd*ch)*180.0/PI;
+    az[i] = Wrap(atan2(-cd*sin(h), sd*cphi - sphi*cd*ch)*180.0/PI, 360.);
+  }
+}
+
+
+/* Local ha and dec for n entries of local az and alt */
+/* As HorizontalToEquatorial with -12 <= ha < 12 */
+
+void HorizontalToEquatorialBatch(double *az, double *alt, 
+  double *ha, double *dec, int n)
+{
+  double sphi, cphi, a, e, h, se, ce, ca;
+  int i;
+  extern double SiteLatitude;
+  
+  sphi = sin(SiteLatitude*PI/180.);
+  cphi = cos(SiteLatitude*PI/180.);
+  
+  for (i = 0; i < n; i++)
+  {
+    a = az[i]*PI/180.;
+    e = alt[i]*PI/180.;
+    se = sin(e);
+    ce = cos(e);
+    ca = cos(a);
+    h = atan2(-sin(a)*ce, cphi*se - sphi*ce*ca)*12./PI;
+    dec[i] = asin(sphi*se + cphi*ce*ca)*180./PI;
+    ha[i] = (h >= 12.) ? h - 24. : h;
+  }
+}
+
+
+/* Horizon mask                                                              */
+/*                                                                           */
+/* The local horizon is given as vertices of altitude at azimuth, joined by  */
+/* straight lines and closed around the sky.  It is tabulated in HORIZONBINS */
+/* bins of azimuth so that a lookup is one index.  With no vertices the      */
+/* horizon is flat at zero altitude.                                         */
+
+static double horizontable[HORIZONBINS];      /* Altitude in each bin */
+static double horizonaz[HORIZONPOINTS];       /* Vertices sorted by azimuth */
+static double horizonalt[HORIZONPOINTS];
+static int horizonpoints = 0;
+
+
+/* Remove all vertices and leave a flat horizon */
+
+void HorizonClear(void)
+{
+  horizonpoints = 0;
+  HorizonBuild();
+}
+
+
+/* Add a vertex to the horizon mask with az and alt in degrees */
+
+void HorizonPoint(double az, double alt)
+{
+  int i;
+  
+  if (horizonpoints >= HORIZONPOINTS)
+  {
+    fprintf(stderr,"Horizon mask is limited to %d points\n", HORIZONPOINTS);
+    return;
+  }
+  
+  /* Insert in order of azimuth */
+  
+  az = Map360(az);
+  i = horizonpoints;
+  while ( (i > 0) && (horizonaz[i-1] > az) )
+  {
+    horizonaz[i] = horizonaz[i-1];
+    horizonalt[i] = horizonalt[i-1];
+    i--;
+  }
+  horizonaz[i] = az;
+  horizonalt[i] = alt;
+  horizonpoints++;
+  
+  HorizonBuild();
+}
+
+
+/* Altitude of the horizon in degrees at az in degrees */
+
+double HorizonAltitude(double az)
+{
+  int bin;
+  
+  bin = (int) (Wrap(az, 360.)*HORIZONBINS/360.);
+  
+  /* Guard against rounding up to the last edge */
+  
+  if (bin >= HORIZONBINS)
+  {
+    bin = HORIZONBINS - 1;
+  }
+  
+  return (horizontable[bin]);
+}
+
+
+/* Tabulate the horizon at the center of each azimuth bin */
+
+static void HorizonBuild(void)
+{
+  double az, az0, az1, alt0, alt1;
+  int bin, j;
+  
+  for (bin = 0; bin < HORIZONBINS; bin++)
+  {
+    if (horizonpoints == 0)
+    {
+      horizontable[bin] = 0.;
+      continue;
+    }
+    
+    az = (bin + 0.5)*360./HORIZONBINS;
+    
+    /* Find the vertices on either side, closing the mask through north */
+    
+    j = 0;
+    while ( (j < horizonpoints) && (horizonaz[j] <= az) )
+    {
+      j++;
+    }
+    if (j == 0)
+    {
+      az0 = horizonaz[horizonpoints-1] - 360.;
+      alt0 = horizonalt[horizonpoints-1];
+    }
+    else
+    {
+      az0 = horizonaz[j-1];
+      alt0 = horizonalt[j-1];
+    }
+    if (j == horizonpoints)
+    {
+      az1 = horizonaz[0] + 360.;
+      alt1 = horizonalt[0];
+    }
+    else
+    {
+      az1 = horizonaz[j];
+      alt1 = horizonalt[j];
+    }
+    
+    if (az1 - az0 > 0.)
+    {
+      horizontable[bin] = alt0 + (alt1 - alt0)*(az - az0)/(az1 - az0);
+    }
+    else
+    {
+      horizontable[bin] = alt0;
+    }
+  }
+}
+
+
+/* Visibility of n targets at apparent ra and dec for this lst            */
+/*                                                                         */
+/* A target is visible when it is above both minalt and the horizon mask. */
+/* Sets visible[i] to 1 or 0 and returns the number visible.             */
+
+#define VISIBLEBLOCK 256
+
+int VisibleBatch(double *ra, double *dec, int n, double lst, 
+  double minalt, unsigned char *visible)
+{
+  double ha[VISIBLEBLOCK], az[VISIBLEBLOCK], alt[VISIBLEBLOCK];
+  double limit;
+  int i, j, m, bin, count;
+  
+  count = 0;
+  for (j = 0; j < n; j += VISIBLEBLOCK)
+  {
+    m = ( (n - j) < VISIBLEBLOCK ) ? n - j : VISIBLEBLOCK;
+    for (i = 0; i < m; i++)
+    {
+      ha[i] = lst - ra[j+i];
+    }
+    EquatorialToHorizontalBatch(ha, dec + j, az, alt, m);
+    for (i = 0; i < m; i++)
+    {
+      bin = (int) (az[i]*HORIZONBINS/360.);
+      bin = (bin < HORIZONBINS) ? bin : HORIZONBINS - 1;
+      limit = horizontable[bin];
+      limit = (limit > minalt) ? limit : minalt;
+      visible[j+i] = (alt[i] >= limit) ? 1 : 0;
+      count += visible[j+i];
+    }
+  }
+  
+  return (count);
+}
+
+
+/* Observability of n targets over the next hours from this lst             */
+/*                                                                          */
+/* Targets are tested as in VisibleBatch every HORIZONSTEP hours of time.   */
+/* Sets rises[i] to the hours until the target is first visible, which is  */
+/*   zero if it is visible now, or -1 if it is not visible in the window.  */
+/* Returns the number that are visible at some time in the window.         */
+
+int ObservableBatch(double *ra, double *dec, int n, double lst, 
+  double hours, double minalt, double *rises)
+{
+  double sd[VISIBLEBLOCK], cd[VISIBLEBLOCK];
+  double sphi, cphi, t, h, ch, alt, az, limit, up;
+  int i, j, m, bin, count;
+  extern double SiteLatitude;
+  
+  sphi = sin(SiteLatitude*PI/180.);
+  cphi = cos(SiteLatitude*PI/180.);
+  
+  count = 0;
+  for (j = 0; j < n; j += VISIBLEBLOCK)
+  {
+    m = ( (n - j) < VISIBLEBLOCK ) ? n - j : VISIBLEBLOCK;
+    for (i = 0; i < m; i++)
+    {
+      sd[i] = sin(dec[j+i]*PI/180.);
+      cd[i] = cos(dec[j+i]*PI/180.);
+      rises[j+i] = -1.;
+    }
+    
+    /* Sidereal time runs 1.00273791 times faster than solar time */
+    
+    for (t = 0.; t <= hours; t += HORIZONSTEP)
+    {
+      for (i = 0; i < m; i++)
+      {
+        h = (lst + 1.00273791*t - ra[j+i])*PI/12.;
+        ch = cos(h);
+        alt = asin(sphi*sd[i] + cphi*cd[i]*ch)*180./PI;
+        az = Wrap(atan2(-cd[i]*sin(h), sd[i]*cphi - sphi*cd[i]*ch)*180./PI, 
+          360.);
+        bin = (int) (az*HORIZONBINS/360.);
+        bin = (bin < HORIZONBINS) ? bin : HORIZONBINS - 1;
+        limit = horizontable[bin];
+        limit = (limit > minalt) ? limit : minalt;
+        up = ( (alt >= limit) && (rises[j+i] < 0.) ) ? 1. : 0.;
+        rises[j+i] = (up > 0.) ? t : rises[j+i];
+      }
+    }
+    
+    for (i = 0; i < m; i++)
+    {
+      count += (rises[j+i] >= 0.) ? 1 : 0;
+    }
+  }
+  
+  return (count);
+}
+
+
 /* True obliquity of the ecliptic for the EOD in degrees*/
 
 double TrueObliquity(void)
@@ -1315,7 +1832,7 @@ double MeanObliquity(void)
 
 double NObliquity(void)
 {
-  double deps, lsun, lmoon, omega;
+  double dpsi, deps;
   double jdnow, dt, t;
   
   dt = LEAPSECONDS;
@@ -1337,25 +1854,9 @@ double NObliquity(void)
   
   t = t + dt ;
     
-  /* Longitude of the ascending node of the Moon's mean orbit in degrees */
-  
-  omega = 125.04452 - 1934.136261*t + 0.0020708*t*t + t*t*t/450000.;
-    
-  /* Mean longitudes of the Sun and the Moon in degrees */
-  
-  lsun = Map360(280.4665 + 3600.7698*t);
-  lmoon = Map360(218.3165 + 481267.8813*t);
-  
-  /* Convert to radians */
-
-  omega = omega*PI/180.;
-  lsun = lsun*PI/180.;
-  lmoon = lmoon*PI/180.;
-  
   /* Nutation of the obliquity in seconds of arc for the EOD */
   
-  deps = 9.20*cos(omega) + 0.57*cos(2.*lsun) + 
-    0.1*cos(2.*lmoon) - 0.09*cos(2.*omega);
+  NutationSeries(t, &dpsi, &deps);
       
   /* Convert to degrees */
  
@@ -1369,7 +1870,7 @@ double NObliquity(void)
 
 double NLongitude(void)
 {
-  double dpsi, lsun, lmoon, omega;
+  double dpsi, deps;
   double jdnow, dt, t;
     
   dt = LEAPSECONDS;
@@ -1391,29 +1892,9 @@ double NLongitude(void)
   
   t = t + dt ;
     
-  /* Longitude of the ascending node of the Moon's mean orbit */
-  
-  omega = Map360(125.04452 - 1934.136261*t + 0.0020708*t*t + t*t*t/450000.);
-
-  /* Mean longitude of the Moon */
-  
-  lmoon = Map360(218.31654591 + 481267.88134236*t
-    - 0.00163*t*t + t*t*t/538841. - t*t*t*t/65194000.);
-    
-  /* Mean longitude of the Sun */
-  
-  lsun = LongitudeSun();    
-      
-  /* Convert to radians */
-  
-  omega = omega*PI/180.;  
-  lsun = lsun*PI/180.;
-  lmoon = lmoon*PI/180.;
-
   /* Nutation in longitude in seconds of arc for the EOD */
   
-  dpsi = -17.20*sin(omega) - 1.32*sin(2.*lsun) - 
-    0.23*sin(2.*lmoon) + 0.21*sin(2.*omega);
+  NutationSeries(t, &dpsi, &deps);
         
   /* Convert to degrees */
     
@@ -1423,6 +1904,132 @@ double NLongitude(void)
 }
 
 
+/* Nutation series of IAU 1980 from Meeus, Table 22.A                       */
+/* Each term gives the multiples of D, M, M', F and omega in its argument,  */
+/*   the coefficient of its sine in longitude and the rate per century, and */
+/*   the coefficient of its cosine in obliquity and the rate, in 0.0001"    */
+
+#define NUTATIONTERMS 63
+
+static const double nutationterms[NUTATIONTERMS][9] =
+{
+  {  0,  0,  0,  0,  1, -171996., -174.2,  92025.,  8.9 },
+  { -2,  0,  0,  2,  2,  -13187.,   -1.6,   5736., -3.1 },
+  {  0,  0,  0,  2,  2,   -2274.,   -0.2,    977., -0.5 },
+  {  0,  0,  0,  0,  2,    2062.,    0.2,   -895.,  0.5 },
+  {  0,  1,  0,  0,  0,    1426.,   -3.4,     54., -0.1 },
+  {  0,  0,  1,  0,  0,     712.,    0.1,     -7.,  0.0 },
+  { -2,  1,  0,  2,  2,    -517.,    1.2,    224., -0.6 },
+  {  0,  0,  0,  2,  1,    -386.,   -0.4,    200.,  0.0 },
+  {  0,  0,  1,  2,  2,    -301.,    0.0,    129., -0.1 },
+  { -2, -1,  0,  2,  2,     217.,   -0.5,    -95.,  0.3 },
+  { -2,  0,  1,  0,  0,    -158.,    0.0,      0.,  0.0 },
+  { -2,  0,  0,  2,  1,     129.,    0.1,    -70.,  0.0 },
+  {  0,  0, -1,  2,  2,     123.,    0.0,    -53.,  0.0 },
+  {  2,  0,  0,  0,  0,      63.,    0.0,      0.,  0.0 },
+  {  0,  0,  1,  0,  1,      63.,    0.1,    -33.,  0.0 },
+  {  2,  0, -1,  2,  2,     -59.,    0.0,     26.,  0.0 },
+  {  0,  0, -1,  0,  1,     -58.,   -0.1,     32.,  0.0 },
+  {  0,  0,  1,  2,  1,     -51.,    0.0,     27.,  0.0 },
+  { -2,  0,  2,  0,  0,      48.,    0.0,      0.,  0.0 },
+  {  0,  0, -2,  2,  1,      46.,    0.0,    -24.,  0.0 },
+  {  2,  0,  0,  2,  2,     -38.,    0.0,     16.,  0.0 },
+  {  0,  0,  2,  2,  2,     -31.,    0.0,     13.,  0.0 },
+  {  0,  0,  2,  0,  0,      29.,    0.0,      0.,  0.0 },
+  { -2,  0,  1,  2,  2,      29.,    0.0,    -12.,  0.0 },
+  {  0,  0,  0,  2,  0,      26.,    0.0,      0.,  0.0 },
+  { -2,  0,  0,  2,  0,     -22.,    0.0,      0.,  0.0 },
+  {  0,  0, -1,  2,  1,      21.,    0.0,    -10.,  0.0 },
+  {  0,  2,  0,  0,  0,      17.,   -0.1,      0.,  0.0 },
+  {  2,  0, -1,  0,  1,      16.,    0.0,     -8.,  0.0 },
+  { -2,  2,  0,  2,  2,     -16.,    0.1,      7.,  0.0 },
+  {  0,  1,  0,  0,  1,     -15.,    0.0,      9.,  0.0 },
+  { -2,  0,  1,  0,  1,     -13.,    0.0,      7.,  0.0 },
+  {  0, -1,  0,  0,  1,     -12.,    0.0,      6.,  0.0 },
+  {  0,  0,  2, -2,  0,      11.,    0.0,      0.,  0.0 },
+  {  2,  0, -1,  2,  1,     -10.,    0.0,      5.,  0.0 },
+  {  2,  0,  1,  2,  2,      -8.,    0.0,      3.,  0.0 },
+  {  0,  1,  0,  2,  2,       7.,    0.0,     -3.,  0.0 },
+  { -2,  1,  1,  0,  0,      -7.,    0.0,      0.,  0.0 },
+  {  0, -1,  0,  2,  2,      -7.,    0.0,      3.,  0.0 },
+  {  2,  0,  0,  2,  1,      -7.,    0.0,      3.,  0.0 },
+  {  2,  0,  1,  0,  0,       6.,    0.0,      0.,  0.0 },
+  { -2,  0,  2,  2,  2,       6.,    0.0,     -3.,  0.0 },
+  { -2,  0,  1,  2,  1,       6.,    0.0,     -3.,  0.0 },
+  {  2,  0, -2,  0,  1,      -6.,    0.0,      3.,  0.0 },
+  {  2,  0,  0,  0,  1,      -6.,    0.0,      3.,  0.0 },
+  {  0, -1,  1,  0,  0,       5.,    0.0,      0.,  0.0 },
+  { -2, -1,  0,  2,  1,      -5.,    0.0,      3.,  0.0 },
+  { -2,  0,  0,  0,  1,      -5.,    0.0,      3.,  0.0 },
+  {  0,  0,  2,  2,  1,      -5.,    0.0,      3.,  0.0 },
+  { -2,  0,  2,  0,  1,       4.,    0.0,      0.,  0.0 },
+  { -2,  1,  0,  2,  1,       4.,    0.0,      0.,  0.0 },
+  {  0,  0,  1, -2,  0,       4.,    0.0,      0.,  0.0 },
+  { -1,  0,  1,  0,  0,      -4.,    0.0,      0.,  0.0 },
+  { -2,  1,  0,  0,  0,      -4.,    0.0,      0.,  0.0 },
+  {  1,  0,  0,  0,  0,      -4.,    0.0,      0.,  0.0 },
+  {  0,  0,  1,  2,  0,       3.,    0.0,      0.,  0.0 },
+  {  0,  0, -2,  2,  2,      -3.,    0.0,      0.,  0.0 },
+  { -1, -1,  1,  0,  0,      -3.,    0.0,      0.,  0.0 },
+  {  0,  1,  1,  0,  0,      -3.,    0.0,      0.,  0.0 },
+  {  0, -1,  1,  2,  2,      -3.,    0.0,      0.,  0.0 },
+  {  2, -1, -1,  2,  2,      -3.,    0.0,      0.,  0.0 },
+  {  0,  0,  3,  2,  2,      -3.,    0.0,      0.,  0.0 },
+  {  2, -1,  0,  2,  2,      -3.,    0.0,      0.,  0.0 }
+};
+
+
+/* Nutation in longitude and obliquity in seconds of arc for Julian          */
+/*   centuries t of dynamical time from J2000.0                              */
+/* The series is summed once for an epoch and kept, since NLongitude and     */
+/*   NObliquity are asked for the same epoch in turn                         */
+
+static void NutationSeries(double t, double *dpsi, double *deps)
+{
+  static double lastt = -1.e9;
+  static double lastdpsi = 0.;
+  static double lastdeps = 0.;
+  double d, m, mp, f, omega, a;
+  int i;
+  
+  if (t != lastt)
+  {
+  
+    /* Mean elongation of the Moon from the Sun, mean anomalies of the Sun */
+    /*   and the Moon, argument of latitude of the Moon, and longitude of  */
+    /*   the ascending node of the Moon's mean orbit in radians             */
+    
+    d = Map360(297.85036 + 445267.111480*t - 0.0019142*t*t + 
+      t*t*t/189474.)*PI/180.;
+    m = Map360(357.52772 + 35999.050340*t - 0.0001603*t*t - 
+      t*t*t/300000.)*PI/180.;
+    mp = Map360(134.96298 + 477198.867398*t + 0.0086972*t*t + 
+      t*t*t/56250.)*PI/180.;
+    f = Map360(93.27191 + 483202.017538*t - 0.0036825*t*t + 
+      t*t*t/327270.)*PI/180.;
+    omega = Map360(125.04452 - 1934.136261*t + 0.0020708*t*t + 
+      t*t*t/450000.)*PI/180.;
+    
+    lastdpsi = 0.;
+    lastdeps = 0.;
+    for (i = 0; i < NUTATIONTERMS; i++)
+    {
+      a = nutationterms[i][0]*d + nutationterms[i][1]*m + 
+        nutationterms[i][2]*mp + nutationterms[i][3]*f + 
+        nutationterms[i][4]*omega;
+      lastdpsi += (nutationterms[i][5] + nutationterms[i][6]*t)*sin(a);
+      lastdeps += (nutationterms[i][7] + nutationterms[i][8]*t)*cos(a);
+    }
+    lastdpsi = lastdpsi*0.0001;
+    lastdeps = lastdeps*0.0001;
+    lastt = t;
+  }
+  
+  *dpsi = lastdpsi;
+  *deps = lastdeps;
+}
+
+
 /* True geometric solar longitude for the EOD in degrees */
 
 double LongitudeSun(void)
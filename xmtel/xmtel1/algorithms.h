@@ -24,6 +24,13 @@
 /*   Version 1.4                                                              */
 /*   Leapsecond increment                                                     */
 /*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 1.5                                                              */
+/*   Time context shared by one conversion or control tick                    */
+/*   Apparent place engine kept for an epoch                                  */
+/*   Batch transformations on arrays of coordinates                           */
+/*   Horizon mask and visibility of arrays of targets                         */
+/*                                                                            */
 
 
  
@@ -39,3 +46,77 @@
 #ifndef PI
 #define PI             3.14159265358
 #endif
+
+/* Time context                                                               */
+/* One sample of the clock with the quantities derived from it, so that all   */
+/* the steps of a conversion work with the same moment.                       */
+
+#ifndef TIMEANCHOR
+#define TIMEANCHOR 60.       /* Seconds between anchoring the monotonic */
+#endif                       /*   clock to UTC again                    */
+
+typedef struct timecontext
+{
+  double utc;       /* Seconds since 1970 January 1.0 UTC */
+  double jd;        /* Julian date */
+  double ut;        /* Universal time in hours */
+  double lst;       /* Local mean sidereal time in hours */
+  double t;         /* Julian centuries from J2000.0 */
+} timecontext;
+
+extern void TimeClock(timecontext *tc);
+extern void TimeNow(timecontext *tc);
+extern void TimeAt(timecontext *tc, double utc);
+extern timecontext *TimeUse(timecontext *tc);
+
+/* Apparent place engine                                                      */
+/* Precession and nutation combined in one rotation from J2000 to the true    */
+/* equator and equinox of date, with the annual aberration as the velocity   */
+/* of the Earth in units of the speed of light, for one epoch.                */
+
+#ifndef APPARENTREFRESH
+#define APPARENTREFRESH 60.  /* Seconds before the engine is rebuilt */
+#endif
+
+typedef struct apparentplace
+{
+  double jd;          /* Julian date of the epoch or 0 if not built */
+  double m[3][3];     /* J2000 to true equator and equinox of date */
+  double v[3];        /* Velocity of the Earth over c in the frame of date */
+} apparentplace;
+
+extern apparentplace *ApparentPlace(void);
+
+/* Batch transformations on structure of arrays buffers */
+
+extern void ApparentBatch(double *ra, double *dec, int n, int dirflag);
+extern void ProperMotionBatch(double epoch, double *ra, double *dec, 
+  double *pm_ra, double *pm_dec, int n);
+extern void EquatorialToHorizontalBatch(double *ha, double *dec, 
+  double *az, double *alt, int n);
+extern void HorizontalToEquatorialBatch(double *az, double *alt, 
+  double *ha, double *dec, int n);
+
+/* Horizon mask                                                               */
+/* Altitude of the local horizon tabulated in bins of azimuth from vertices   */
+/* given in the prefs file, and the visibility of arrays of targets.          */
+
+#ifndef HORIZONBINS
+#define HORIZONBINS 360      /* Azimuth bins in the horizon table */
+#endif
+
+#ifndef HORIZONPOINTS
+#define HORIZONPOINTS 360    /* Vertices of the horizon mask */
+#endif
+
+#ifndef HORIZONSTEP
+#define HORIZONSTEP 0.1      /* Hours between tests over a time window */
+#endif
+
+extern void HorizonClear(void);
+extern void HorizonPoint(double az, double alt);
+extern double HorizonAltitude(double az);
+extern int VisibleBatch(double *ra, double *dec, int n, double lst, 
+  double minalt, unsigned char *visible);
+extern int ObservableBatch(double *ra, double *dec, int n, double lst, 
+  double hours, double minalt, double *rises);
@@ -0,0 +1,716 @@
+/* -------------------------------------------------------------------------- */
+/* -            Benchmark of the pointing and astrometry routines           - */
+/* -------------------------------------------------------------------------- */
+/*                                                                            */
+/* Copyright 2026 John Kielkopf                                               */
+/*                                                                            */
+/* Distributed under the terms of the General Public License (see LICENSE)    */
+/*                                                                            */
+/* John Kielkopf (kielkopf@louisville.edu)                                    */
+/*                                                                            */
+/* Date: October 16, 2026                                                     */
+/* Version: 1.0                                                               */
+/*                                                                            */
+/* History:                                                                   */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 1.0                                                              */
+/*     Accuracy against worked examples and timing in ns per operation        */
+/*                                                                            */
+/* -------------------------------------------------------------------------- */
+
+/* Runs without a telescope.  The accuracy tests come first and compare     */
+/* the routines with the worked examples in Meeus, Astronomical Algorithms  */
+/* (2nd ed., 1998) and with the SGP4 test orbit 88888 of Vallado et al.,    */
+/* with closed round trips through the pointing model and with the encoder  */
+/* mapping of the mount.  The timing runs each routine on a fixed set of    */
+/* targets with one time context in use, as the control loop does, and      */
+/* reports ns per operation and operations per second.                      */
+/*                                                                          */
+/*   benchmark [iterations [telserial]]                                     */
+/*                                                                          */
+/* Given the link of a telescope the AUX driver also reads the limits state */
+/* BENCHLINKREADS times and expects each read to be answered, then sets the */
+/* encoders and reads the position as often and expects it as set.  Against */
+/* the simulator started with                                               */
+/*                                                                          */
+/*   python3 auxsim.py --link /tmp/nexstar --drop 0xee:4 --late 0x01:6      */
+/*                                                                          */
+/* the second limits read loses its reply, and the altitude reply to the    */
+/* second position read comes after its deadline.  The reads after each     */
+/* must succeed, and the late reply must not be taken for another axis.     */
+/*                                                                          */
+/* The exit status is the number of accuracy tests that failed.             */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "protocol.h"
+#include "algorithms.h"
+#include "satellite.h"
+#include "xmtel1.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define BENCHTARGETS 1024       /* Targets cycled through by the timing */
+#define BENCHITERATIONS 200000  /* Default operations timed per routine */
+#define BENCHLINKREADS 4        /* Reads of each kind on a link */
+#define BENCHLINKHA -2.         /* Hour angle set on a link in hours */
+
+/* Globals the routines expect from the main program */
+
+double SiteLatitude = LATITUDE;
+double SiteLongitude = LONGITUDE;
+double SiteAltitude = ALTITUDE;
+double SitePressure = PRESSURE;
+double SiteTemperature = TEMPERATURE;
+double offsetha = 0.;
+double offsetdec = 0.;
+double polaraz = 0.;
+double polaralt = 0.;
+double arcsecperpix = ARCSECPERPIX;
+double modelha0 = 0.;
+double modelha1 = 0.;
+double modeldec0 = 0.;
+double modeldec1 = 0.;
+double homeha = HOMEHA;
+double homedec = HOMEDEC;
+double homera = HOMEHA;
+int  homenow = FALSE;
+int  telmount = GEM;
+char telserial[32];
+
+/* Routines under test */
+
+extern double CalcJD(int ny, int nm, int nd, double ut);
+extern double CalcLST(int year, int month, int day, double ut, double glong);
+extern double JDNow(void);
+extern double LSTNow(void);
+extern double Map24(double hour);
+extern double Map12(double hour);
+extern void Precession(double *ra, double *dec, int dirflag);
+extern void Nutation(double *ra, double *dec, int dirflag);
+extern void Aberration(double *ra, double *dec, int dirflag);
+extern void Apparent(double *ra, double *dec, int dirflag);
+extern void EquatorialToHorizontal(double ha, double dec, double *az,
+  double *alt);
+extern void PointingFromTel (double *telra1, double *teldec1,
+  double telra0, double teldec0, int pmodel);
+extern void PointingToTel (double *telra0, double *teldec0,
+  double telra1, double teldec1, int pmodel);
+extern double RefractionTable(double sa, int dirflag);
+extern void Refraction(double *ha, double *dec, int dirflag);
+extern void Polar(double *ha, double *dec, int dirflag);
+extern void ConnectTel(void);
+extern void DisconnectTel(void);
+extern int  GetLimits(int *limits);
+extern int  SetTelEncoders(double homeha, double homedec);
+extern void GetTel(double *telra, double *teldec, int pmodel);
+
+#ifdef AUXTURN
+extern int EncoderToEquatorial(auxangle encoderaz, auxangle encoderalt,
+  double *telha0, double *teldec0);
+extern int EquatorialToEncoder(double telha0, double teldec0,
+  auxangle *encoderaz, auxangle *encoderalt);
+#endif
+
+/* Targets in ra (hours) and dec (degrees) above the horizon */
+
+static double benchra[BENCHTARGETS];
+static double benchdec[BENCHTARGETS];
+static double benchlst;
+#ifdef AUXTURN
+static auxangle benchaz[BENCHTARGETS];
+static auxangle benchalt[BENCHTARGETS];
+#endif
+static volatile double benchsink;
+static int failures = 0;
+
+
+/* Report one accuracy test and count it if it fails */
+
+static void Check(char *name, double value, double expected,
+  double tolerance, char *units)
+{
+  int ok;
+
+  ok = (fabs(value - expected) <= tolerance);
+  if (!ok)
+  {
+    failures++;
+  }
+  printf("%-44s %16.9f %16.9f %9.3g %-6s %s\n", name, value, expected,
+    value - expected, units, ok ? "ok" : "FAIL");
+}
+
+
+/* Angle in arcseconds between two positions in hours and degrees */
+
+static double Separation(double ra1, double dec1, double ra2, double dec2)
+{
+  double x, y, z;
+
+  /* Chord between the unit vectors keeps the precision at small angles */
+
+  x = cos(dec1*PI/180.)*cos(ra1*PI/12.) - cos(dec2*PI/180.)*cos(ra2*PI/12.);
+  y = cos(dec1*PI/180.)*sin(ra1*PI/12.) - cos(dec2*PI/180.)*sin(ra2*PI/12.);
+  z = sin(dec1*PI/180.) - sin(dec2*PI/180.);
+  return(2.*asin(0.5*sqrt(x*x + y*y + z*z))*648000./PI);
+}
+
+
+/* Fill the targets with a spiral over the sky above 20 degrees */
+
+static void Targets(void)
+{
+  int i, n;
+  double ha, dec, az, alt;
+
+  i = 0;
+  n = 1;
+  while (i < BENCHTARGETS)
+  {
+    ha = Map12(0.618034*24.*n);
+    dec = -30. + 119.*(n % 97)/97.;
+    n++;
+    EquatorialToHorizontal(ha, dec, &az, &alt);
+    if (alt < 20.)
+    {
+      continue;
+    }
+    benchra[i] = Map24(benchlst - ha);
+    benchdec[i] = dec;
+#ifdef AUXTURN
+    benchaz[i] = (auxangle) (ha*(AUXTURN/24.));
+    benchalt[i] = (auxangle) ((dec - 90.)*(AUXTURN/360.));
+#endif
+    i++;
+  }
+}
+
+
+/* SGP4 reference orbit and its TEME vectors at 0 to 1440 minutes */
+
+static char sgp4line1[] =
+  "1 88888U          80275.98708465  .00073094  13844-3  66816-4 0    87";
+static char sgp4line2[] =
+  "2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518  1058";
+static double sgp4r[5][3] =
+{
+  { 2328.96975262, -5995.22051338,  1719.97297192 },
+  { 2456.10706533, -6071.93855503,  1222.89768554 },
+  { 2567.56229695, -6112.50383922,   713.96374435 },
+  { 2663.08964352, -6115.48290885,   196.40072866 },
+  { 2742.55398832, -6079.67009123,  -326.39012649 }
+};
+static double sgp4v[5][3] =
+{
+  { 2.91207328, -0.98341796, -7.09081621 },
+  { 2.67939004, -0.44829081, -7.22879215 },
+  { 2.44024575,  0.09810900, -7.31995926 },
+  { 2.19612156,  0.65241509, -7.36282415 },
+  { 1.94849765,  1.21107268, -7.35619313 }
+};
+
+
+/* Accuracy against worked examples and closed round trips */
+
+static void Accuracy(void)
+{
+  double ra, dec, ra0, dec0, ra1, dec1, ha, err, maxerr;
+#ifdef AUXTURN
+  auxangle az, alt;
+  static char *mountname[] = { "Encoder round trip alt-az", 
+    "Encoder round trip equatorial fork", 
+    "Encoder round trip german equatorial" };
+#endif
+  double savelat, savelong;
+  double r[3], v[3];
+  char name[64];
+  satellite sat;
+  timecontext tc, *saved;
+  int i;
+
+  printf("%-44s %16s %16s %9s %-6s\n", "Accuracy", "value", "expected",
+    "error", "units");
+
+  /* Meeus example 7.a, launch of Sputnik 1 */
+
+  Check("CalcJD 1957 Oct 4.81", CalcJD(1957, 10, 4, 19.44),
+    2436116.31, 1.e-6, "day");
+
+  /* Meeus examples 12.a and 12.b at Greenwich */
+
+  Check("CalcLST 1987 Apr 10 0h", CalcLST(1987, 4, 10, 0., 0.),
+    13. + 10./60. + 46.3668/3600., 0.001/3600., "hour");
+  Check("CalcLST 1987 Apr 10 19h21m", CalcLST(1987, 4, 10,
+    19. + 21./60., 0.), 8. + 34./60. + 57.0896/3600., 0.001/3600., "hour");
+
+  /* The same moment through a time context */
+
+  savelong = SiteLongitude;
+  SiteLongitude = 0.;
+  TimeAt(&tc, (2446895.5 - 2440587.5)*86400. + (19.*60. + 21.)*60.);
+  SiteLongitude = savelong;
+  Check("TimeAt 1987 Apr 10 19h21m lst", tc.lst,
+    8. + 34./60. + 57.0896/3600., 0.001/3600., "hour");
+  Check("TimeAt 1987 Apr 10 19h21m jd", tc.jd,
+    2446896.30625, 1.e-8, "day");
+
+  /* Meeus example 21.b, theta Persei to 2028 Nov 13.19 */
+  /* The J2000 place includes the proper motion to date */
+
+  TimeAt(&tc, (2462088.69 - 2440587.5)*86400.);
+  saved = TimeUse(&tc);
+  ra = 41.054063/15.;
+  dec = 49.227750;
+  Precession(&ra, &dec, 1);
+  Check("Precession theta Per ra", ra*15., 41.547214, 1.e-5, "deg");
+  Check("Precession theta Per dec", dec, 49.348483, 1.e-5, "deg");
+  Precession(&ra, &dec, -1);
+  Check("Precession round trip", Separation(ra, dec, 41.054063/15.,
+    49.227750), 0., 0.001, "arcsec");
+
+  /* Meeus example 23.a, the same star to the apparent place */
+  /* Nutation is held to 0.5% of the value                   */
+
+  ra = 41.547214/15.;
+  dec = 49.348483;
+  Nutation(&ra, &dec, 1);
+  Check("Nutation theta Per ra", (ra*15. - 41.547214)*3600.,
+    15.843, 0.08, "arcsec");
+  Check("Nutation theta Per dec", (dec - 49.348483)*3600.,
+    6.218, 0.03, "arcsec");
+  ra = 41.547214/15.;
+  dec = 49.348483;
+  Aberration(&ra, &dec, 1);
+  Check("Aberration theta Per ra", (ra*15. - 41.547214)*3600.,
+    30.045, 0.1, "arcsec");
+  Check("Aberration theta Per dec", (dec - 49.348483)*3600.,
+    6.697, 0.1, "arcsec");
+  TimeUse(saved);
+
+  /* Refraction at 10 C and 767.6 Torr where the scale factor is 1 */
+
+  SiteTemperature = 10.;
+  SitePressure = 760.*1.01;
+  Check("Refraction apparent 45 deg", RefractionTable(sqrt(0.5), -1),
+    58.294 - 0.0668, 0.001, "arcsec");
+  Check("Refraction apparent horizon (Bennett)", RefractionTable(0., -1),
+    60./tan(7.31/4.4*PI/180.), 0.5, "arcsec");
+  Check("Refraction apparent zenith", RefractionTable(1., -1),
+    0., 0.001, "arcsec");
+  SiteTemperature = TEMPERATURE;
+  SitePressure = PRESSURE;
+
+  /* Pointing model round trips with all corrections in use */
+
+  TimeAt(&tc, 1792119600.);
+  saved = TimeUse(&tc);
+  benchlst = tc.lst;
+  polaraz = 0.05;
+  polaralt = -0.03;
+  offsetha = 0.002;
+  offsetdec = -0.01;
+  maxerr = 0.;
+  for (i = 0; i < BENCHTARGETS; i++)
+  {
+    PointingToTel(&ra0, &dec0, benchra[i], benchdec[i],
+      OFFSET | REFRACT | POLAR);
+    PointingFromTel(&ra1, &dec1, ra0, dec0, OFFSET | REFRACT | POLAR);
+    err = Separation(ra1, dec1, benchra[i], benchdec[i]);
+    if (err > maxerr)
+    {
+      maxerr = err;
+    }
+  }
+  Check("Pointing model round trip", maxerr, 0., 0.01, "arcsec");
+  polaraz = 0.;
+  polaralt = 0.;
+  offsetha = 0.;
+  offsetdec = 0.;
+  TimeUse(saved);
+
+  /* SGP4 test case 88888 of Vallado et al., Revisiting Spacetrack Report */
+  /*   #3 (AIAA 2006-6753), TEME position and velocity every 360 minutes  */
+
+  if (!SatelliteRead(sgp4line1, sgp4line2, &sat))
+  {
+    Check("SGP4 88888 elements", 0., 1., 0., "");
+  }
+  else
+  {
+    for (i = 0; i < 5; i++)
+    {
+      SatellitePropagate(&sat, sat.epoch + 360.*i/1440., r, v);
+      sprintf(name, "SGP4 88888 %4d min position", 360*i);
+      Check(name, sqrt(pow(r[0] - sgp4r[i][0], 2) + pow(r[1] - sgp4r[i][1], 2) +
+        pow(r[2] - sgp4r[i][2], 2)), 0., 1.e-6, "km");
+      sprintf(name, "SGP4 88888 %4d min velocity", 360*i);
+      Check(name, sqrt(pow(v[0] - sgp4v[i][0], 2) + pow(v[1] - sgp4v[i][1], 2) +
+        pow(v[2] - sgp4v[i][2], 2)), 0., 2.e-8, "km/s");
+    }
+  }
+
+#ifdef AUXTURN
+
+  /* German equatorial encoders zero for the OTA over the pier at the pole */
+
+  savelat = SiteLatitude;
+  telmount = GEM;
+  /* Angles of a sixteenth of a turn are exact in counts                   */
+
+  EncoderToEquatorial(0, 0, &ha, &dec);
+  Check("GEM encoders 0 0 dec", dec, 90., 1.e-9, "deg");
+  EncoderToEquatorial(AUXTURN/8, -3*AUXTURN/16, &ha, &dec);
+  Check("GEM encoders 45 -67.5 ha", ha, -3., 1.e-9, "hour");
+  Check("GEM encoders 45 -67.5 dec", dec, 22.5, 1.e-9, "deg");
+  EncoderToEquatorial(-AUXTURN/8, 3*AUXTURN/16, &ha, &dec);
+  Check("GEM encoders -45 67.5 ha", ha, 3., 1.e-9, "hour");
+  Check("GEM encoders -45 67.5 dec", dec, 22.5, 1.e-9, "deg");
+  EncoderToEquatorial(-AUXTURN/4, -AUXTURN/8, &ha, &dec);
+  Check("GEM encoders -90 -45 ha", ha, -12., 1.e-9, "hour");
+  Check("GEM encoders -90 -45 dec", dec, 45., 1.e-9, "deg");
+  EquatorialToEncoder(-3., 22.5, &az, &alt);
+  Check("GEM ha -3 dec 22.5 encoder az", az, AUXTURN/8, 0., "count");
+  Check("GEM ha -3 dec 22.5 encoder alt", alt, -3*AUXTURN/16, 0., "count");
+
+  /* Round trips on each mounting in both hemispheres */
+  /* Encoder angles are rounded to half a count       */
+
+  for (telmount = ALTAZ; telmount <= GEM; telmount++)
+  {
+    maxerr = 0.;
+    for (SiteLatitude = -savelat; SiteLatitude <= savelat;
+      SiteLatitude += 2.*savelat)
+    {
+      for (i = 0; i < BENCHTARGETS; i++)
+      {
+        ha = Map12(0.618034*24.*i + 0.01);
+        dec = -60. + 140.*(i % 89)/89.;
+        if (!EquatorialToEncoder(ha, dec, &az, &alt) ||
+          !EncoderToEquatorial(az, alt, &ra1, &dec1))
+        {
+          maxerr = 648000.;
+          continue;
+        }
+        err = Separation(ra1, dec1, ha, dec);
+        if (err > maxerr)
+        {
+          maxerr = err;
+        }
+      }
+    }
+    Check(mountname[telmount], maxerr, 0., 0.06, "arcsec");
+  }
+  SiteLatitude = savelat;
+  telmount = GEM;
+
+#else
+
+  (void) ha;
+  (void) savelat;
+
+#endif
+
+  printf("\n");
+}
+
+
+#ifdef AUXTURN
+
+/* Read from a telescope on the link and count the reads not answered */
+/* A read that fails must not take the replies of the reads after it   */
+
+static void Link(char *link)
+{
+  int i, limits, failed, after, wrong, wrongafter;
+  double ra, dec;
+
+  strncpy(telserial, link, sizeof(telserial) - 1);
+  telserial[sizeof(telserial) - 1] = '\0';
+  ConnectTel();
+
+  failed = 0;
+  after = 0;
+  for (i = 0; i < BENCHLINKREADS; i++)
+  {
+    if (GetLimits(&limits) != 0)
+    {
+      if (failed > 0)
+      {
+        after++;
+      }
+      failed++;
+    }
+  }
+
+  /* The two axes are set apart so that a reply taken by the wrong query */
+  /* reads as a position other than the one set                          */
+
+  SetTelEncoders(BENCHLINKHA, SiteLatitude);
+  wrong = 0;
+  wrongafter = 0;
+  for (i = 0; i < BENCHLINKREADS; i++)
+  {
+    GetTel(&ra, &dec, RAW);
+    if ( (fabs(Map12(LSTNow() - ra) - BENCHLINKHA) > 0.01) ||
+      (fabs(dec - SiteLatitude) > 0.01) )
+    {
+      if (wrong > 0)
+      {
+        wrongafter++;
+      }
+      wrong++;
+    }
+  }
+  DisconnectTel();
+
+  printf("%-44s %16s %16s %9s %-6s\n", "Link", "value", "expected",
+    "error", "units");
+  printf("%-44s %16d\n", "Link reads not answered", failed);
+  Check("Link reads not answered after the first", after, 0., 0., "read");
+  printf("%-44s %16d\n", "Link positions not as set", wrong);
+  Check("Link positions not as set after the first", wrongafter, 0., 0.,
+    "read");
+  printf("\n");
+}
+
+#endif
+
+
+/* Timed operations on target i */
+
+static void BenchLST(int i)
+{
+  benchsink += LSTNow();
+}
+
+static void BenchJD(int i)
+{
+  benchsink += JDNow();
+}
+
+static void BenchClock(int i)
+{
+  timecontext tc;
+
+  TimeClock(&tc);
+  benchsink += tc.lst;
+}
+
+static void BenchApparent(int i)
+{
+  double ra = benchra[i], dec = benchdec[i];
+
+  Apparent(&ra, &dec, 1);
+  benchsink += ra + dec;
+}
+
+static void BenchPrecession(int i)
+{
+  double ra = benchra[i], dec = benchdec[i];
+
+  Precession(&ra, &dec, 1);
+  benchsink += ra + dec;
+}
+
+static void BenchNutation(int i)
+{
+  double ra = benchra[i], dec = benchdec[i];
+
+  Nutation(&ra, &dec, 1);
+  benchsink += ra + dec;
+}
+
+static void BenchAberration(int i)
+{
+  double ra = benchra[i], dec = benchdec[i];
+
+  Aberration(&ra, &dec, 1);
+  benchsink += ra + dec;
+}
+
+static void BenchToTelRaw(int i)
+{
+  double ra, dec;
+
+  PointingToTel(&ra, &dec, benchra[i], benchdec[i], RAW);
+  benchsink += ra + dec;
+}
+
+static void BenchToTel(int i)
+{
+  double ra, dec;
+
+  PointingToTel(&ra, &dec, benchra[i], benchdec[i],
+    OFFSET | REFRACT | POLAR);
+  benchsink += ra + dec;
+}
+
+static void BenchFromTel(int i)
+{
+  double ra, dec;
+
+  PointingFromTel(&ra, &dec, benchra[i], benchdec[i],
+    OFFSET | REFRACT | POLAR);
+  benchsink += ra + dec;
+}
+
+static void BenchRefraction(int i)
+{
+  double ha = benchlst - benchra[i], dec = benchdec[i];
+
+  Refraction(&ha, &dec, 1);
+  benchsink += ha + dec;
+}
+
+static void BenchPolar(int i)
+{
+  double ha = benchlst - benchra[i], dec = benchdec[i];
+
+  Polar(&ha, &dec, 1);
+  benchsink += ha + dec;
+}
+
+#ifdef AUXTURN
+
+static void BenchEncoderTo(int i)
+{
+  auxangle az, alt;
+
+  EquatorialToEncoder(Map12(benchlst - benchra[i]), benchdec[i], &az, &alt);
+  benchsink += az + alt;
+}
+
+static void BenchEncoderFrom(int i)
+{
+  double ha, dec;
+
+  EncoderToEquatorial(benchaz[i], benchalt[i], &ha, &dec);
+  benchsink += ha + dec;
+}
+
+#endif
+
+typedef struct
+{
+  char *name;
+  void (*op)(int i);
+} benchmark;
+
+static benchmark benchmarks[] =
+{
+  { "LSTNow", BenchLST },
+  { "JDNow", BenchJD },
+  { "TimeClock", BenchClock },
+  { "Apparent", BenchApparent },
+  { "Precession", BenchPrecession },
+  { "Nutation", BenchNutation },
+  { "Aberration", BenchAberration },
+  { "PointingToTel raw", BenchToTelRaw },
+  { "PointingToTel offset refract polar", BenchToTel },
+  { "PointingFromTel offset refract polar", BenchFromTel },
+  { "Refraction", BenchRefraction },
+  { "Polar", BenchPolar },
+#ifdef AUXTURN
+  { "EquatorialToEncoder", BenchEncoderTo },
+  { "EncoderToEquatorial", BenchEncoderFrom },
+#endif
+  { NULL, NULL }
+};
+
+
+/* Seconds on the monotonic clock */
+
+static double Seconds(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec + 1.e-9*ts.tv_nsec);
+}
+
+
+int main(int argc, char *argv[])
+{
+  timecontext tc, *saved;
+  double t0, t1, ns;
+  int i, j, n;
+
+  n = BENCHITERATIONS;
+  if (argc > 1)
+  {
+    n = atoi(argv[1]);
+    if (n < 1)
+    {
+      fprintf(stderr,"Usage: benchmark [iterations [telserial]]\n");
+      return(1);
+    }
+  }
+
+  /* One moment for all the tests, 2026 October 16 3h UT */
+
+  TimeAt(&tc, 1792119600.);
+  saved = TimeUse(&tc);
+  benchlst = tc.lst;
+  Targets();
+  TimeUse(saved);
+
+  Accuracy();
+
+#ifdef AUXTURN
+
+  if (argc > 2)
+  {
+    Link(argv[2]);
+  }
+
+#endif
+
+  /* Timing with the time context in use as in one control tick */
+
+  polaraz = 0.05;
+  polaralt = -0.03;
+  offsetha = 0.002;
+  offsetdec = -0.01;
+  saved = TimeUse(&tc);
+
+  printf("%-44s %12s %14s\n", "Timing", "ns/op", "ops/s");
+  for (j = 0; benchmarks[j].name != NULL; j++)
+  {
+    /* Warm the caches and tables before timing */
+
+    for (i = 0; i < BENCHTARGETS; i++)
+    {
+      benchmarks[j].op(i);
+    }
+
+    t0 = Seconds();
+    for (i = 0; i < n; i++)
+    {
+      benchmarks[j].op(i % BENCHTARGETS);
+    }
+    t1 = Seconds();
+
+    ns = 1.e9*(t1 - t0)/n;
+    printf("%-44s %12.1f %14.0f\n", benchmarks[j].name, ns,
+      (ns > 0.) ? 1.e9/ns : 0.);
+  }
+  TimeUse(saved);
+
+  if (failures > 0)
+  {
+    printf("\n%d accuracy tests failed\n", failures);
+  }
+
+  return(failures);
+}
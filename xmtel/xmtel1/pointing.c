@@ -6,8 +6,8 @@
 /*                                                                            */
 /* Distributed under the terms of the General Public License (see LICENSE)    */
 /*                                                                            */
-/* Date: March 7, 2012                                                        */
-/* Version: 1.4                                                               */
+/* Date: October 16, 2026                                                     */
+/* Version: 1.5                                                               */
 /*                                                                            */
 /* History:                                                                   */
 /*                                                                            */
@@ -63,6 +63,15 @@
 /*   Removed optical axis to be incorporated in dynamic empirical model               */
 /*   Removed flexure axis to be incorporated in dynamic empirical model               */
 /*   Added empirical dynamic model                                         */
+/*                                                                            */
+/*   October 16, 2026                                                         */
+/*   Version 1.5                                                              */
+/*   PointingToTelBatch for arrays of target coordinates                      */
+/*   Corrections fused as rotations of one unit vector                        */
+/*   Paths specialized for each pointing model chosen from a table            */
+/*   PointingFromTel solved as the exact inverse of PointingToTel             */
+/*   Mount model terms fitted incrementally from sync points                  */
+/*   Refraction from tables for the current weather valid to the horizon      */
 
 
 /* References:                                                                */
@@ -87,6 +96,7 @@
 #include <stdio.h>
 #include <math.h>
 #include "protocol.h"
+#include "xmtel1.h"
 
 /* Prototypes */
 
@@ -94,6 +104,46 @@ void PointingFromTel (double *telra1, double *teldec1,
   double telra0, double teldec0, int pmodel);
 void PointingToTel (double *telra0, double *teldec0, 
   double telra1, double teldec1, int pmodel);
+void PointingToTelBatch (double *telra0, double *teldec0, 
+  double *telra1, double *teldec1, int n, int pmodel);
+static void PointingInverse(double *ra, double *dec, double lst, int pmodel);
+void ModelClear(void);
+int  ModelSync(double telra, double teldec, double ra, double dec);
+int  ModelWrite(FILE *outfile);
+int  ModelRead(FILE *infile);
+static void ModelBasis(double sh, double ch, double sd, double cd, 
+  double sphi, double cphi, double *bh, double *bd);
+static void ModelSolve(void);
+double RefractionTable(double sa, int dirflag);
+static void RefractionBuild(void);
+static double RefractionApparent(double altitude);
+static void SmallSinCos(double e, double *s, double *c);
+static double SmallAtan2(double y, double x);
+
+/* Pointing paths specialized for each combination of the model flags     */
+/* The tables are indexed by pmodel & POINTINGMODELS                       */
+
+#define POINTINGMODELS (OFFSET | REFRACT | POLAR | DYNAMIC | TERMS)
+
+/* The fused corrections are expanded into each path so that the tests  */
+/*   on the model flags are resolved when the path is compiled           */
+
+#ifdef __GNUC__
+#define POINTINGINLINE static inline __attribute__((always_inline))
+#else
+#define POINTINGINLINE static
+#endif
+
+typedef void (*pointingpath)(double *ra, double *dec, double lst);
+
+/* Newton iteration for the inverse of the pointing model */
+
+#define POINTINGITERATIONS 6       /* Most steps before first order is used */
+#define POINTINGTOLERANCE 0.001    /* Residual in arcseconds to stop */
+#define POINTINGWARM 0.1           /* Degrees from the last call to start warm */
+
+static pointingpath pointingtotel[POINTINGMODELS + 1];
+static pointingpath pointingfromtel[POINTINGMODELS + 1];
 void Refraction(double *ha, double *dec, int dirflag);
 void Polar(double *ha, double *dec, int dirflag);
 void Decaxis(double *ha, double *dec, int dirflag);
@@ -146,178 +196,1055 @@ extern double arcsecperpix;
 extern double SiteLongitude;  
 extern double SiteLatitude;   
 
+/* Mount model terms: apparent pointing = real pointing + terms x basis    */
+/* The terms are in arcseconds with the signs and basis used by TPOINT:    */
+/*                                                                         */
+/*   dha  = -IH - CH sec(dec) - NP tan(dec) - MA cos(ha) tan(dec)          */
+/*          + ME sin(ha) tan(dec) + TF cos(lat) sin(ha) sec(dec)           */
+/*   ddec = -ID + MA sin(ha) + ME cos(ha) + FO cos(ha)                     */
+/*          + TF (cos(lat) cos(ha) sin(dec) - sin(lat) cos(dec))           */
+/*                                                                         */
+/* They are fitted by least squares to the sync points by QR updating.    */
+/*   Each point rotates two rows into the triangular factor with Givens   */
+/*   rotations, so that a new point costs a fixed small number of         */
+/*   operations however many came before it.  A weak prior keeps terms   */
+/*   the points do not yet determine at zero.                            */
+
+#define MODELPRIOR 0.001     /* Weight of the prior that terms are zero */
+
+double modelterm[MODELTERMS];                     /* Fitted terms */
+static double modelr[MODELTERMS][MODELTERMS];     /* Triangular factor */
+static double modelz[MODELTERMS];                 /* Rotated observations */
+static int modelpoints = -1;                      /* Sync points in the fit */
+
+/* Refraction tables                                                       */
+/* The refraction for apparent altitude is that of the tangent series     */
+/*   above 15 degrees and of Bennett's formula below 10 degrees, blended */
+/*   between them.  The refraction for real altitude is its exact         */
+/*   inverse.  Both are tabulated against the sine of the altitude below */
+/*   45 degrees, which spaces the points most closely near the horizon,  */
+/*   and against the cosine above, where the refraction goes as the      */
+/*   cosine.  They are built again only when the temperature or pressure */
+/*   changes by more than a step.                                        */
+
+#define REFRACTIONPOINTS 1024      /* Intervals in each half of a table */
+#define REFRACTIONLOW -2.0         /* Lowest altitude tabulated (degrees) */
+#define REFRACTIONDT 0.5           /* Temperature step to rebuild (C) */
+#define REFRACTIONDP 1.0           /* Pressure step to rebuild (Torr) */
+
+typedef struct refractiontable
+{
+  int built;                               /* Flag that the tables are in use */
+  double temperature;                      /* Temperature built for (C) */
+  double pressure;                         /* Pressure built for (Torr) */
+  double s0;                               /* Sine of the lowest altitude */
+  double lowscale;                         /* Intervals per unit sine */
+  double highscale;                        /* Intervals per unit cosine */
+  double real[2][REFRACTIONPOINTS + 1];    /* Arcseconds for real altitude */
+  double apparent[2][REFRACTIONPOINTS + 1];/* Arcseconds for apparent altitude */
+} refractiontable;
+
+static refractiontable refraction;
+
 /* Apply corrections to coordinates reported by the telescope              */
 /* Input telescope raw coordinates assumed zero corrected                  */
 /* Return real coordinates corresponding to this raw point                 */
 /* Implemented in order: polar, decaxis, optaxis, flexure, refract, offset */
 /* Note that the order is reversed from that in PointingFromTel            */
+/* The result is the exact inverse of PointingToTel when that is found    */
 
 void PointingFromTel (double *telra1, double *teldec1, 
   double telra0, double teldec0, int pmodel)
 {
-  double tmpra, tmpha, tmpdec, tmplst;
+  double tmpra, tmpdec;
   
-  /* Find the LST for the pointing corrections and save it */
+  /* Find the LST for the pointing corrections once */
   /* Otherwise the lapsed time to do corrections affects the resultant HA and RA */
-    
-  tmplst = LSTNow();
+  
   tmpra = telra0;
-  tmpha = tmplst - tmpra;
-  tmpha = Map12(tmpha);
   tmpdec = teldec0;
-      
-  /* Correct for mounting misalignment */
-  /* For dir = -1 returns the real pointing given the apparent pointing */
+  PointingInverse(&tmpra, &tmpdec, LSTNow(), pmodel);
+  
+  *telra1 = tmpra;
+  *teldec1 = tmpdec;
+
+  return;
+}  
+
+
+/* Find the apparent coordinates to send to the telescope                  */
+/* Input real target coordinates                                           */
+/* Return apparent telescope coordinates to have it point at this target   */
+/* Implemented in order: offset, refract, flexure, optaxis, decaxis, polar */
+/* Note that the order is reversed from that in PointingFromTel            */
+
+void PointingToTel (double *telra0, double *teldec0, 
+  double telra1, double teldec1, int pmodel)
+{
+  double tmpra, tmpdec;
+  
+  tmpra = telra1;
+  tmpdec = teldec1;
+  pointingtotel[pmodel & POINTINGMODELS](&tmpra, &tmpdec, LSTNow());
+       
+  *telra0 = tmpra;
+  *teldec0 = tmpdec;
+
+  return;
+}  
+
+
+/* Find the apparent telescope coordinates for n targets                   */
+/* Input and output arrays as for PointingToTel and may be the same        */
+/* One LST is used for the whole batch                                     */
+
+void PointingToTelBatch (double *telra0, double *teldec0, 
+  double *telra1, double *teldec1, int n, int pmodel)
+{
+  double tmplst, tmpra, tmpdec;
+  pointingpath path;
+  int i;
   
-  if ( pmodel == (pmodel | POLAR) )
+  tmplst = LSTNow();
+  path = pointingtotel[pmodel & POINTINGMODELS];
+  for (i = 0; i < n; i++)
   {
-    Polar( &tmpha,  &tmpdec, -1);
-  } 
+    tmpra = telra1[i];
+    tmpdec = teldec1[i];
+    path(&tmpra, &tmpdec, tmplst);
+    telra0[i] = tmpra;
+    teldec0[i] = tmpdec;
+  }
   
-  /* Correct for actual real time behavior  */
-  /* For dir = -1 returns the real pointing given the apparent pointing */
+  return;
+}
+
+
+/* Real coordinates that PointingToTel takes to the given apparent ones   */
+/*                                                                         */
+/* Newton iteration on the composed model with its Jacobian found by      */
+/*   differences.  If the last call was nearby the iteration starts with  */
+/*   a step from its solution by the inverse Jacobian kept from it, so   */
+/*   that while tracking one evaluation of the model usually confirms    */
+/*   the start is within the tolerance.  A cold start begins from the     */
+/*   first order inverse, which is also returned if the iteration does   */
+/*   not converge.                                                       */
+
+static void PointingInverse(double *ra, double *dec, double lst, int pmodel)
+{
+  static int warmmodel = -1;
+  static double warmra0, warmdec0, warmra1, warmdec1;
+  static double jinv[2][2];
+  double ra0, dec0, ra1, dec1, fra, fdec, rra, rdec, cosdec;
+  double res, lastres, sra, sdec, det, j[2][2];
+  double ra2, dec2, ra3, dec3;
+  int i, m;
+  
+  m = pmodel & POINTINGMODELS;
+  ra0 = *ra;
+  dec0 = *dec;
+  
+  /* Offsets alone are inverted exactly by the direct path */
   
-  if ( pmodel == (pmodel | DYNAMIC) )
+  if ( (m | OFFSET) == OFFSET )
   {
-    Model( &tmpha,  &tmpdec, -1);
-  } 
+    pointingfromtel[m](ra, dec, lst);
+    return;
+  }
 
-  /* Correct for atmospheric refraction */
-  /* For dir = -1 returns the real pointing given the apparent pointing */
+  if ( (m == warmmodel) && (fabs(dec0 - warmdec0) < POINTINGWARM) &&
+    (fabs(Map12(ra0 - warmra0))*15.*cos(dec0*PI/180.) < POINTINGWARM) )
+  {
+    rra = Map12(ra0 - warmra0);
+    rdec = dec0 - warmdec0;
+    ra1 = warmra1 + jinv[0][0]*rra + jinv[0][1]*rdec;
+    dec1 = warmdec1 + jinv[1][0]*rra + jinv[1][1]*rdec;
+  }
+  else
+  {
+    ra1 = ra0;
+    dec1 = dec0;
+    pointingfromtel[m](&ra1, &dec1, lst);
+    warmmodel = -1;
+  }
+  
+  cosdec = 15.*cos(dec0*PI/180.);
+  lastres = 1.e9;
+  for (i = 0; i < POINTINGITERATIONS; i++)
+  {
+    fra = ra1;
+    fdec = dec1;
+    pointingtotel[m](&fra, &fdec, lst);
+    rra = Map12(ra0 - fra);
+    rdec = dec0 - fdec;
+    res = 3600.*sqrt(rra*rra*cosdec*cosdec + rdec*rdec);
+    if (res < POINTINGTOLERANCE)
+    {
+      break;
+    }
+    
+    /* Find the Jacobian again on a cold start or if the step did not   */
+    /*   cut the residual tenfold, stepping in declination away from the */
+    /*   pole                                                           */
+    
+    if ( (warmmodel != m) || (res > 0.1*lastres) )
+    {
+      sra = 1.e-5;
+      sdec = (dec1 > 0.) ? -1.e-4 : 1.e-4;
+      ra2 = ra1 + sra;
+      dec2 = dec1;
+      pointingtotel[m](&ra2, &dec2, lst);
+      ra3 = ra1;
+      dec3 = dec1 + sdec;
+      pointingtotel[m](&ra3, &dec3, lst);
+      j[0][0] = Map12(ra2 - fra)/sra;
+      j[1][0] = (dec2 - fdec)/sra;
+      j[0][1] = Map12(ra3 - fra)/sdec;
+      j[1][1] = (dec3 - fdec)/sdec;
+      det = j[0][0]*j[1][1] - j[0][1]*j[1][0];
+      if (fabs(det) < 1.e-6)
+      {
+        i = POINTINGITERATIONS;
+        break;
+      }
+      jinv[0][0] = j[1][1]/det;
+      jinv[0][1] = -j[0][1]/det;
+      jinv[1][0] = -j[1][0]/det;
+      jinv[1][1] = j[0][0]/det;
+      warmmodel = m;
+    }
     
-  if ( pmodel == (pmodel | REFRACT) )
+    ra1 = ra1 + jinv[0][0]*rra + jinv[0][1]*rdec;
+    dec1 = dec1 + jinv[1][0]*rra + jinv[1][1]*rdec;
+    lastres = res;
+  }
+  
+  if (i == POINTINGITERATIONS)
+  {
+    warmmodel = -1;
+    pointingfromtel[m](ra, dec, lst);
+    return;
+  }
+  
+  if (dec1 > 90.)
+  {
+    dec1 = 180. - dec1;
+    ra1 = ra1 + 12.;
+  }
+  if (dec1 < -90.)
   {
-    Refraction( &tmpha,  &tmpdec, -1);
+    dec1 = -180. - dec1;
+    ra1 = ra1 + 12.;
   }
+  ra1 = Map24(ra1);
+  
+  warmmodel = m;
+  warmra0 = ra0;
+  warmdec0 = dec0;
+  warmra1 = ra1;
+  warmdec1 = dec1;
+  
+  *ra = ra1;
+  *dec = dec1;
+}
+
+
+/* Fused pointing corrections                                              */
+/*                                                                         */
+/* The offset, refraction, dynamic model and polar corrections are those  */
+/*   of the separate routines below, applied in the same order.  Offsets  */
+/*   and the dynamic model add to hour angle and declination.  When      */
+/*   refraction or polar alignment is on, the pointing is carried both as */
+/*   hour angle and declination in radians and as the unit vector in the  */
+/*   local equatorial frame:                                              */
+/*                                                                         */
+/*     x = cos(dec) cos(ha)   y = cos(dec) sin(ha)   z = sin(dec)          */
+/*                                                                         */
+/* Each correction is then a small rotation: in hour angle about the      */
+/*   pole, in declination toward the pole, or in altitude toward the      */
+/*   zenith.  The sines and cosines the corrections need are components   */
+/*   of the vector, and the small changes of the angles follow from the   */
+/*   vector by series.  The only library trigonometry is the sine and     */
+/*   cosine of the hour angle and declination on the way in.  After the   */
+/*   last correction that needs the vector only the angles are changed.   */
+/*                                                                         */
+/* Call with dirflag > 0 for real to apparent as in PointingToTel and     */
+/*   dirflag < 0 for apparent to real as in PointingFromTel.              */
 
-  /* Add offsets to apparent pointing to give real pointing */
+typedef struct pointingstate
+{
+  double u[3];      /* Unit vector */
+  double h;         /* Hour angle in radians */
+  double d;         /* Declination in radians */
+} pointingstate;
+
+POINTINGINLINE void TurnPointing(pointingstate *p, double eh, double ed, 
+  int turn);
+static void RotateHA(pointingstate *p, double e);
+static void RotateDec(pointingstate *p, double e);
+static void RotateAlt(pointingstate *p, double e, double sphi, double cphi,
+  double sa, double ca);
+
+POINTINGINLINE void PointingFused(double *ra, double *dec, double lst, 
+  int pmodel, int dirflag)
+{
+  static double latitude = 0., sphi = 0., cphi = 1.;
+  pointingstate p;
+  double h, d, rho, rho2, sa, ca, dalt;
+  double deltaha, dha, ddec, epsha, epsdec;
+  double bh[MODELTERMS], bd[MODELTERMS];
+  int i;
+  
+  h = lst - *ra;
+  d = *dec;
   
-  if ( pmodel == (pmodel | OFFSET) )
+  /* Offsets are defined as added to apparent pointing to give real pointing */
+  
+  if ( (dirflag > 0) && (pmodel == (pmodel | OFFSET)) )
   {
-    tmpha = tmpha + offsetha;
-    tmpdec = tmpdec + offsetdec;
+    h = h - offsetha;
+    d = d - offsetdec;
   }
 
-  /* Now use celestial coordinates */
+  /* Without refraction, polar alignment or terms the model is added in place */
   
-  tmpra = tmplst - tmpha;
+  if ( (pmodel != (pmodel | REFRACT)) && (pmodel != (pmodel | POLAR)) &&
+    (pmodel != (pmodel | TERMS)) )
+  {
+    if ( pmodel == (pmodel | DYNAMIC) )
+    {
+      deltaha = h - modelha0;
+      deltaha = deltaha - 24.*floor((deltaha + 12.)/24.);
+      dha = deltaha*modelha1*arcsecperpix/54000.;
+      ddec = deltaha*modeldec1*arcsecperpix/3600.;
+      h = (dirflag > 0) ? h - dha : h + dha;
+      d = (dirflag > 0) ? d - ddec : d + ddec;
+    }
+  }
+  else
+  {
+    if (SiteLatitude != latitude)
+    {
+      latitude = SiteLatitude;
+      sphi = sin(latitude*PI/180.);
+      cphi = cos(latitude*PI/180.);
+    }
+    
+    /* Bring an offset over the pole back to the sky                        */
+    /* Reduce the hour angle first so that the library is on its fast path */
+    
+    if (d > 90.)
+    {
+      d = 180. - d;
+      h = h + 12.;
+    }
+    if (d < -90.)
+    {
+      d = -180. - d;
+      h = h + 12.;
+    }
+    h = h - 24.*floor((h + 12.)/24.);
+    p.h = h*PI/12.;
+    p.d = d*PI/180.;
+    p.u[0] = cos(p.d)*cos(p.h);
+    p.u[1] = cos(p.d)*sin(p.h);
+    p.u[2] = sin(p.d);
+    
+    /* Mount model terms are nearest the mount and come first going back */
+    
+    if ( (dirflag < 0) && (pmodel == (pmodel | TERMS)) )
+    {
+      rho = sqrt(p.u[0]*p.u[0] + p.u[1]*p.u[1]);
+      ModelBasis(p.u[1]/rho, p.u[0]/rho, p.u[2], rho, sphi, cphi, bh, bd);
+      epsha = 0.;
+      epsdec = 0.;
+      for (i = 0; i < MODELTERMS; i++)
+      {
+        epsha = epsha + modelterm[i]*bh[i];
+        epsdec = epsdec + modelterm[i]*bd[i];
+      }
+      TurnPointing(&p, -epsha/3600.*PI/180., -epsdec/3600.*PI/180., 
+        (pmodel == (pmodel | POLAR)) || (pmodel == (pmodel | REFRACT)));
+    }
+    
+    /* Polar axis misalignment from apparent to real comes first going back */
+    /* As in Polar with tan(dec) sin(ha) = z y / rho^2 and so on            */
+    /* The vector is turned only if refraction will need it                 */
+    
+    if ( (dirflag < 0) && (pmodel == (pmodel | POLAR)) )
+    {
+      rho2 = 1./(p.u[0]*p.u[0] + p.u[1]*p.u[1]);
+      rho = sqrt(rho2);
+      epsha = (polaralt*p.u[2]*p.u[1] + polaraz*p.u[2]*p.u[0]*cphi)*rho2 - 
+        polaraz*sphi;
+      epsdec = (polaralt*p.u[0] - polaraz*p.u[1]*cphi)*rho;
+      TurnPointing(&p, -epsha*PI/180., -epsdec*PI/180., 
+        pmodel == (pmodel | REFRACT));
+    }
     
-  /* Handle a case that has crossed the 24 hr mark */
+    /* Dynamic model when going back, before refraction */
+    
+    if ( (dirflag < 0) && (pmodel == (pmodel | DYNAMIC)) )
+    {
+      deltaha = p.h*12./PI - modelha0;
+      deltaha = deltaha - 24.*floor((deltaha + 12.)/24.);
+      TurnPointing(&p, deltaha*modelha1*arcsecperpix/54000.*PI/12., 
+        deltaha*modeldec1*arcsecperpix/3600.*PI/180., 
+        pmodel == (pmodel | REFRACT));
+    }
+    
+    /* Atmospheric refraction raises the object toward the zenith    */
+    /* The sine of the altitude is found from the vector for the table */
+    
+    if ( pmodel == (pmodel | REFRACT) )
+    {
+      sa = cphi*p.u[0] + sphi*p.u[2];
+      ca = sqrt(1. - sa*sa);
+      if (dirflag > 0)
+      {
+        dalt = RefractionTable(sa, 1);
+      }
+      else
+      {
+        dalt = -RefractionTable(sa, -1);
+      }
+      RotateAlt(&p, dalt/3600.*PI/180., sphi, cphi, sa, ca);
+    }
+    
+    /* Dynamic model from real to apparent */
+    
+    if ( (dirflag > 0) && (pmodel == (pmodel | DYNAMIC)) )
+    {
+      deltaha = p.h*12./PI - modelha0;
+      deltaha = deltaha - 24.*floor((deltaha + 12.)/24.);
+      TurnPointing(&p, -deltaha*modelha1*arcsecperpix/54000.*PI/12., 
+        -deltaha*modeldec1*arcsecperpix/3600.*PI/180., 
+        (pmodel == (pmodel | POLAR)) || (pmodel == (pmodel | TERMS)));
+    }
+    
+    /* Polar axis misalignment from real to apparent */
+    
+    if ( (dirflag > 0) && (pmodel == (pmodel | POLAR)) )
+    {
+      rho2 = 1./(p.u[0]*p.u[0] + p.u[1]*p.u[1]);
+      rho = sqrt(rho2);
+      epsha = (polaralt*p.u[2]*p.u[1] + polaraz*p.u[2]*p.u[0]*cphi)*rho2 - 
+        polaraz*sphi;
+      epsdec = (polaralt*p.u[0] - polaraz*p.u[1]*cphi)*rho;
+      TurnPointing(&p, epsha*PI/180., epsdec*PI/180., 
+        pmodel == (pmodel | TERMS));
+    }
+    
+    /* Mount model terms from real to apparent */
+    
+    if ( (dirflag > 0) && (pmodel == (pmodel | TERMS)) )
+    {
+      rho = sqrt(p.u[0]*p.u[0] + p.u[1]*p.u[1]);
+      ModelBasis(p.u[1]/rho, p.u[0]/rho, p.u[2], rho, sphi, cphi, bh, bd);
+      epsha = 0.;
+      epsdec = 0.;
+      for (i = 0; i < MODELTERMS; i++)
+      {
+        epsha = epsha + modelterm[i]*bh[i];
+        epsdec = epsdec + modelterm[i]*bd[i];
+      }
+      TurnPointing(&p, epsha/3600.*PI/180., epsdec/3600.*PI/180., 0);
+    }
+    
+    h = p.h*12./PI;
+    d = p.d*180./PI;
+  }
   
-  tmpra = Map24(tmpra);
+  /* Reflect through a pole if the corrections went over it */
+  /* Offsets are added last going back, on the reflected side */
   
-  /* Handle a case that has gone over the south pole */
-  /* Limit set to 0.0001 to avoid inadvertent trip on roundoff error */
- 
-  if (tmpdec < -90.0002)
+  if (d > 90.)
   {
-     tmpdec = -180. - tmpdec;
-     tmpra = tmpra + 12.;
-     Map24(tmpra); 
+    d = 180. - d;
+    h = h + 12.;
+  }
+  if (d < -90.)
+  {
+    d = -180. - d;
+    h = h + 12.;
   }
   
-  /* Handle a case that has gone over the north pole */  
-  /* Limit set to 0.0002 to avoid inadvertent trip on roundoff error */
+  if ( (dirflag < 0) && (pmodel == (pmodel | OFFSET)) )
+  {
+    h = h + offsetha;
+    d = d + offsetdec;
+    if (d > 90.)
+    {
+      d = 180. - d;
+      h = h + 12.;
+    }
+    if (d < -90.)
+    {
+      d = -180. - d;
+      h = h + 12.;
+    }
+  }
+  
+  *ra = Map24(lst - h);
+  *dec = d;
+}
+
+
+/* Sine and cosine of a small angle by series with a library fallback */
+/* Exact to the last bit below 0.05 radian                            */
+
+static void SmallSinCos(double e, double *s, double *c)
+{
+  double e2;
   
-  if (tmpdec > 90.0002)
+  if (fabs(e) > 0.05)
   {
-     tmpdec = 180. - tmpdec;
-     tmpra = tmpra + 12.;
-     Map24(tmpra); 
-  } 
+    *s = sin(e);
+    *c = cos(e);
+    return;
+  }
+  e2 = e*e;
+  *s = e*(1. - e2*(1./6.)*(1. - e2*(1./20.)*(1. - e2*(1./42.))));
+  *c = 1. - e2*0.5*(1. - e2*(1./12.)*(1. - e2*(1./30.)*(1. - e2*(1./56.))));
+}
+
+
+/* Angle of y over x for a small angle by series with a library fallback */
+
+static double SmallAtan2(double y, double x)
+{
+  double t, t2;
   
-  *telra1 = tmpra;
-  *teldec1 = tmpdec;
+  if ( (x <= 0.) || (fabs(y) > 0.05*x) )
+  {
+    return (atan2(y, x));
+  }
+  t = y/x;
+  t2 = t*t;
+  return (t*(1. - t2*((1./3.) - t2*((1./5.) - t2*((1./7.) - t2*(1./9.))))));
+}
 
-  return;
-}  
 
+/* Increase the hour angle by eh and the declination by ed radians */
+/* With turn 0 only the angles change and the vector is left stale  */
 
-/* Find the apparent coordinates to send to the telescope                  */
-/* Input real target coordinates                                           */
-/* Return apparent telescope coordinates to have it point at this target   */
-/* Implemented in order: offset, refract, flexure, optaxis, decaxis, polar */
-/* Note that the order is reversed from that in PointingFromTel            */
+POINTINGINLINE void TurnPointing(pointingstate *p, double eh, double ed, 
+  int turn)
+{
+  if (turn)
+  {
+    RotateHA(p, eh);
+    RotateDec(p, ed);
+  }
+  else
+  {
+    p->h = p->h + eh;
+    p->d = p->d + ed;
+  }
+}
 
-void PointingToTel (double *telra0, double *teldec0, 
-  double telra1, double teldec1, int pmodel)
+
+/* Increase the hour angle by e radians */
+
+static void RotateHA(pointingstate *p, double e)
 {
-  double tmpra, tmpha, tmpdec, tmplst;
+  double s, c, x;
   
-  tmpra = telra1;
-  tmpdec = teldec1;
+  SmallSinCos(e, &s, &c);
+  x = p->u[0];
+  p->u[0] = x*c - p->u[1]*s;
+  p->u[1] = x*s + p->u[1]*c;
+  p->h = p->h + e;
+}
 
 
-  /* Save the LST for later use, find the HA for this LST and finish the model */
+/* Increase the declination by e radians                               */
+/* Past the pole the vector continues down the other side of the sky   */
 
-  tmplst = LSTNow();
-  tmpha = tmplst - tmpra;
-  tmpha = Map12(tmpha); 
+static void RotateDec(pointingstate *p, double e)
+{
+  double s, c, rho, k;
+  
+  rho = sqrt(p->u[0]*p->u[0] + p->u[1]*p->u[1]);
+  if (rho == 0.)
+  {
+    return;
+  }
+  SmallSinCos(e, &s, &c);
+  k = c - p->u[2]*s/rho;
+  p->u[0] = p->u[0]*k;
+  p->u[1] = p->u[1]*k;
+  p->u[2] = p->u[2]*c + rho*s;
+  
+  p->d = p->d + e;
+  if (p->d > PI/2.)
+  {
+    p->d = PI - p->d;
+    p->h = p->h + PI;
+  }
+  else if (p->d < -PI/2.)
+  {
+    p->d = -PI - p->d;
+    p->h = p->h + PI;
+  }
+}
 
 
-  /* Correct for offset */
-  /* Offsets are defined as added to apparent pointing to give real pointing */
+/* Increase the altitude by e radians at constant azimuth           */
+/* Requires the sine and cosine of the latitude and of the altitude */
+
+static void RotateAlt(pointingstate *p, double e, double sphi, double cphi,
+  double sa, double ca)
+{
+  double s, c, k, x, y, z, rho, rho1;
   
-  if ( pmodel == (pmodel | OFFSET) )
+  if (ca == 0.)
   {
-    tmpha = tmpha - offsetha;
-    tmpdec = tmpdec - offsetdec;
-  }  
+    return;
+  }
+  SmallSinCos(e, &s, &c);
+  s = s/ca;
+  k = c - sa*s;
+  x = p->u[0];
+  y = p->u[1];
+  z = p->u[2];
+  p->u[0] = x*k + cphi*s;
+  p->u[1] = y*k;
+  p->u[2] = z*k + sphi*s;
+  
+  /* Changes in hour angle and declination between the two vectors */
+  
+  rho = sqrt(x*x + y*y);
+  rho1 = sqrt(p->u[0]*p->u[0] + p->u[1]*p->u[1]);
+  p->h = p->h + SmallAtan2(x*p->u[1] - y*p->u[0], x*p->u[0] + y*p->u[1]);
+  p->d = p->d + SmallAtan2(rho*p->u[2] - z*rho1, rho*rho1 + z*p->u[2]);
+}
 
-   
-  /* Correct for atmospheric refraction */
-  /* For dir = +1 returns the apparent pointing given the real target pointing */
- 
-  if ( pmodel == (pmodel | REFRACT) )
+
+/* One pair of paths for pointing model m with the flags as constants */
+
+#define POINTINGPATH(m)                                                 \
+static void PointingToTel##m(double *ra, double *dec, double lst)       \
+{                                                                       \
+  PointingFused(ra, dec, lst, m, 1);                                    \
+}                                                                       \
+static void PointingFromTel##m(double *ra, double *dec, double lst)     \
+{                                                                       \
+  PointingFused(ra, dec, lst, m, -1);                                   \
+}
+
+POINTINGPATH(0)
+POINTINGPATH(1)
+POINTINGPATH(2)
+POINTINGPATH(3)
+POINTINGPATH(4)
+POINTINGPATH(5)
+POINTINGPATH(6)
+POINTINGPATH(7)
+POINTINGPATH(8)
+POINTINGPATH(9)
+POINTINGPATH(10)
+POINTINGPATH(11)
+POINTINGPATH(12)
+POINTINGPATH(13)
+POINTINGPATH(14)
+POINTINGPATH(15)
+POINTINGPATH(16)
+POINTINGPATH(17)
+POINTINGPATH(18)
+POINTINGPATH(19)
+POINTINGPATH(20)
+POINTINGPATH(21)
+POINTINGPATH(22)
+POINTINGPATH(23)
+POINTINGPATH(24)
+POINTINGPATH(25)
+POINTINGPATH(26)
+POINTINGPATH(27)
+POINTINGPATH(28)
+POINTINGPATH(29)
+POINTINGPATH(30)
+POINTINGPATH(31)
+
+static pointingpath pointingtotel[POINTINGMODELS + 1] =
+{
+  PointingToTel0,  PointingToTel1,  PointingToTel2,  PointingToTel3,
+  PointingToTel4,  PointingToTel5,  PointingToTel6,  PointingToTel7,
+  PointingToTel8,  PointingToTel9,  PointingToTel10, PointingToTel11,
+  PointingToTel12, PointingToTel13, PointingToTel14, PointingToTel15,
+  PointingToTel16, PointingToTel17, PointingToTel18, PointingToTel19,
+  PointingToTel20, PointingToTel21, PointingToTel22, PointingToTel23,
+  PointingToTel24, PointingToTel25, PointingToTel26, PointingToTel27,
+  PointingToTel28, PointingToTel29, PointingToTel30, PointingToTel31
+};
+
+static pointingpath pointingfromtel[POINTINGMODELS + 1] =
+{
+  PointingFromTel0,  PointingFromTel1,  PointingFromTel2,  PointingFromTel3,
+  PointingFromTel4,  PointingFromTel5,  PointingFromTel6,  PointingFromTel7,
+  PointingFromTel8,  PointingFromTel9,  PointingFromTel10, PointingFromTel11,
+  PointingFromTel12, PointingFromTel13, PointingFromTel14, PointingFromTel15,
+  PointingFromTel16, PointingFromTel17, PointingFromTel18, PointingFromTel19,
+  PointingFromTel20, PointingFromTel21, PointingFromTel22, PointingFromTel23,
+  PointingFromTel24, PointingFromTel25, PointingFromTel26, PointingFromTel27,
+  PointingFromTel28, PointingFromTel29, PointingFromTel30, PointingFromTel31
+};
+
+
+/* Basis of the mount model terms at one hour angle and declination     */
+/* Input the sine and cosine of each and of the site latitude          */
+/* Output the change of hour angle and of declination per unit term    */
+
+static void ModelBasis(double sh, double ch, double sd, double cd, 
+  double sphi, double cphi, double *bh, double *bd)
+{
+  double secd, tand;
+  
+  secd = 1./cd;
+  tand = sd*secd;
+  
+  bh[TERMIH] = -1.;
+  bd[TERMIH] = 0.;
+  bh[TERMID] = 0.;
+  bd[TERMID] = -1.;
+  bh[TERMCH] = -secd;
+  bd[TERMCH] = 0.;
+  bh[TERMNP] = -tand;
+  bd[TERMNP] = 0.;
+  bh[TERMMA] = -ch*tand;
+  bd[TERMMA] = sh;
+  bh[TERMME] = sh*tand;
+  bd[TERMME] = ch;
+  bh[TERMTF] = cphi*sh*secd;
+  bd[TERMTF] = cphi*ch*sd - sphi*cd;
+  bh[TERMFO] = 0.;
+  bd[TERMFO] = ch;
+}
+
+
+/* Start the mount model fit again with all terms zero */
+
+void ModelClear(void)
+{
+  int i, j;
+  
+  for (i = 0; i < MODELTERMS; i++)
+  {
+    for (j = 0; j < MODELTERMS; j++)
+    {
+      modelr[i][j] = 0.;
+    }
+    modelr[i][i] = MODELPRIOR;
+    modelz[i] = 0.;
+    modelterm[i] = 0.;
+  }
+  modelpoints = 0;
+}
+
+
+/* Add a sync point to the mount model fit                             */
+/*                                                                     */
+/* Input:                                                              */
+/*   Raw telescope coordinates telra and teldec                        */
+/*   Apparent coordinates ra and dec of the target from PointingToTel  */
+/*     with every correction in use except the terms                   */
+/* Output:                                                             */
+/*   Updated terms and the number of sync points in the fit            */
+
+int ModelSync(double telra, double teldec, double ra, double dec)
+{
+  double row[2][MODELTERMS + 1];
+  double bh[MODELTERMS], bd[MODELTERMS];
+  double ha, sh, ch, sd, cd, sphi, cphi, r, c, s, t;
+  int i, j, k;
+  
+  if (modelpoints < 0)
   {
-    Refraction( &tmpha,  &tmpdec, 1);
+    ModelClear();
   }
+  
+  ha = (LSTNow() - ra)*PI/12.;
+  sh = sin(ha);
+  ch = cos(ha);
+  sd = sin(dec*PI/180.);
+  cd = cos(dec*PI/180.);
+  sphi = sin(SiteLatitude*PI/180.);
+  cphi = cos(SiteLatitude*PI/180.);
+  ModelBasis(sh, ch, sd, cd, sphi, cphi, bh, bd);
+  
+  /* Hour angle residual weighted by cos(dec) as an angle on the sky */
+  /* The last column holds the observed change in arcseconds         */
+  
+  for (j = 0; j < MODELTERMS; j++)
+  {
+    row[0][j] = bh[j]*cd;
+    row[1][j] = bd[j];
+  }
+  row[0][MODELTERMS] = Map12(ra - telra)*54000.*cd;
+  row[1][MODELTERMS] = (teldec - dec)*3600.;
+  
+  /* Rotate each row into the triangular factor */
+  
+  for (k = 0; k < 2; k++)
+  {
+    for (i = 0; i < MODELTERMS; i++)
+    {
+      if (row[k][i] == 0.)
+      {
+        continue;
+      }
+      r = sqrt(modelr[i][i]*modelr[i][i] + row[k][i]*row[k][i]);
+      c = modelr[i][i]/r;
+      s = row[k][i]/r;
+      modelr[i][i] = r;
+      for (j = i + 1; j < MODELTERMS; j++)
+      {
+        t = modelr[i][j];
+        modelr[i][j] = c*t + s*row[k][j];
+        row[k][j] = c*row[k][j] - s*t;
+      }
+      t = modelz[i];
+      modelz[i] = c*t + s*row[k][MODELTERMS];
+      row[k][MODELTERMS] = c*row[k][MODELTERMS] - s*t;
+    }
+  }
+  modelpoints++;
+  
+  ModelSolve();
+  
+  return(modelpoints);
+}
 
-  /* Correct for real time behavior */
-  /* For dir = +1 returns the apparent pointing given the real pointing */
-   
-  if ( pmodel == (pmodel | DYNAMIC) )
+
+/* Find the terms from the triangular factor by back substitution */
+
+static void ModelSolve(void)
+{
+  double sum;
+  int i, j;
+  
+  for (i = MODELTERMS - 1; i >= 0; i--)
   {
-    Model( &tmpha,  &tmpdec, 1);
-  } 
+    sum = modelz[i];
+    for (j = i + 1; j < MODELTERMS; j++)
+    {
+      sum = sum - modelr[i][j]*modelterm[j];
+    }
+    modelterm[i] = sum/modelr[i][i];
+  }
+}
+
 
-  /* Correct for mounting misalignment */
-  /* For dir = +1 returns the apparent pointing given the real pointing */
+/* Write the mount model fit                                           */
+/* The terms are followed by the factor so that a recalled fit can     */
+/*   take more sync points                                             */
+
+int ModelWrite(FILE *outfile)
+{
+  int i, j;
   
-  if ( pmodel == (pmodel | POLAR) )
+  if (modelpoints < 0)
   {
-    Polar( &tmpha,  &tmpdec, 1);
-  } 
+    ModelClear();
+  }
   
-  tmpra = tmplst - tmpha;
+  fprintf(outfile, "%d", modelpoints);
+  for (i = 0; i < MODELTERMS; i++)
+  {
+    fprintf(outfile, " %.6f", modelterm[i]);
+  }
+  fprintf(outfile, "\n");
+  for (i = 0; i < MODELTERMS; i++)
+  {
+    for (j = i; j < MODELTERMS; j++)
+    {
+      fprintf(outfile, " %.12g", modelr[i][j]);
+    }
+    fprintf(outfile, " %.12g\n", modelz[i]);
+  }
+  
+  return(modelpoints);
+}
 
-  /* Handle a case that has crossed the 24 hr mark */
+
+/* Read a mount model fit written by ModelWrite                        */
+/* Returns the number of sync points or -1 if none was read            */
+
+int ModelRead(FILE *infile)
+{
+  double r[MODELTERMS][MODELTERMS], z[MODELTERMS], term[MODELTERMS];
+  int i, j, n;
   
-  tmpra = Map24(tmpra);
+  if (fscanf(infile, "%d", &n) != 1)
+  {
+    return(-1);
+  }
+  for (i = 0; i < MODELTERMS; i++)
+  {
+    if (fscanf(infile, "%lf", &term[i]) != 1)
+    {
+      return(-1);
+    }
+  }
+  for (i = 0; i < MODELTERMS; i++)
+  {
+    for (j = 0; j < MODELTERMS; j++)
+    {
+      r[i][j] = 0.;
+    }
+    for (j = i; j < MODELTERMS; j++)
+    {
+      if (fscanf(infile, "%lf", &r[i][j]) != 1)
+      {
+        return(-1);
+      }
+    }
+    if (fscanf(infile, "%lf", &z[i]) != 1)
+    {
+      return(-1);
+    }
+  }
   
-  /* Handle a case that has gone over the south pole */
+  for (i = 0; i < MODELTERMS; i++)
+  {
+    for (j = 0; j < MODELTERMS; j++)
+    {
+      modelr[i][j] = r[i][j];
+    }
+    modelz[i] = z[i];
+    modelterm[i] = term[i];
+  }
+  modelpoints = n;
   
-  if (tmpdec < -90.)
+  return(modelpoints);
+}
+
+
+/* Refraction in arcseconds for the sine of the altitude              */
+/* Call with dirflag > 0 for real altitude and dirflag < 0 for         */
+/*   apparent altitude                                                 */
+/* The tables follow SiteTemperature and SitePressure                  */
+
+double RefractionTable(double sa, int dirflag)
+{
+  double x, *table;
+  int i;
+  extern double SiteTemperature;
+  extern double SitePressure;
+  
+  if ( (!refraction.built) || 
+    (fabs(SiteTemperature - refraction.temperature) > REFRACTIONDT) ||
+    (fabs(SitePressure - refraction.pressure) > REFRACTIONDP) )
   {
-     tmpdec = -180. - tmpdec;
-     tmpra = tmpra + 12.;
-     Map24(tmpra); 
+    RefractionBuild();
   }
   
-  /* Handle a case that has gone over the north pole */  
+  /* Below 45 degrees by the sine from the lowest altitude */
   
-  if (tmpdec > 90.)
+  if (sa < sqrt(0.5))
   {
-     tmpdec = 180. - tmpdec;
-     tmpra = tmpra + 12.;
-     Map24(tmpra); 
-  } 
-       
-  *telra0 = tmpra;
-  *teldec0 = tmpdec;
+    table = (dirflag > 0) ? refraction.real[0] : refraction.apparent[0];
+    x = (sa - refraction.s0)*refraction.lowscale;
+    if (x <= 0.)
+    {
+      return(table[0]);
+    }
+  }
+  
+  /* Above 45 degrees by the cosine from the zenith */
+  
+  else
+  {
+    table = (dirflag > 0) ? refraction.real[1] : refraction.apparent[1];
+    x = sqrt(1. - sa*sa)*refraction.highscale;
+  }
+  
+  i = (int) x;
+  if (i >= REFRACTIONPOINTS)
+  {
+    return(table[REFRACTIONPOINTS]);
+  }
+  
+  return(table[i] + (x - i)*(table[i + 1] - table[i]));
+}
 
-  return;
-}  
+
+/* Build the refraction tables for the current weather */
+
+static void RefractionBuild(void)
+{
+  double k, altitude, apparent, dalt;
+  int i, j, n;
+  extern double SiteTemperature;
+  extern double SitePressure;
+  
+  refraction.temperature = SiteTemperature;
+  refraction.pressure = SitePressure;
+  refraction.s0 = sin(REFRACTIONLOW*PI/180.);
+  refraction.lowscale = REFRACTIONPOINTS/(sqrt(0.5) - refraction.s0);
+  refraction.highscale = REFRACTIONPOINTS/sqrt(0.5);
+  k = (SitePressure/(760.*1.01))*(283./(273.+SiteTemperature));
+  
+  for (n = 0; n < 2; n++)
+  {
+    for (i = 0; i <= REFRACTIONPOINTS; i++)
+    {
+      if (n == 0)
+      {
+        altitude = asin(refraction.s0 + i/refraction.lowscale)*180./PI;
+      }
+      else
+      {
+        altitude = acos(i/refraction.highscale)*180./PI;
+      }
+      refraction.apparent[n][i] = k*RefractionApparent(altitude);
+    
+      /* Solve apparent = real + refraction(apparent) by iteration */
+    
+      apparent = altitude;
+      for (j = 0; j < 8; j++)
+      {
+        dalt = k*RefractionApparent(apparent);
+        apparent = altitude + dalt/3600.;
+      }
+      refraction.real[n][i] = dalt;
+    }
+  }
+  refraction.built = 1;
+}
+
+
+/* Refraction in arcseconds at standard conditions for apparent altitude */
+
+static double RefractionApparent(double altitude)
+{
+  double t, high, low, w;
+  
+  if (altitude < REFRACTIONLOW)
+  {
+    altitude = REFRACTIONLOW;
+  }
+  
+  high = 0.;
+  if (altitude > 10.)
+  {
+    t = tan((90.0 - altitude)*PI/180.0);
+    high = 58.294 * t - 0.0668 * t * t * t;
+  }
+  if (altitude >= 15.)
+  {
+    return(high);
+  }
+  
+  low = 60./tan((altitude + 7.31/(altitude + 4.4))*PI/180.);
+  if (altitude <= 10.)
+  {
+    return(low);
+  }
+  
+  w = (altitude - 10.)/5.;
+  return(w*high + (1. - w)*low);
+}
 
 
 /* Correct ha and dec for atmospheric refraction                       */
@@ -328,7 +1255,8 @@ void PointingToTel (double *telra0, double *teldec0,
 /*   Pointers to ha and dec                                            */
 /*   Integer dirflag >=0 for add (real to apparent)                    */
 /*   Integer dirflag <0  for subtract (apparent to real)               */
-/*   Valid above 15 degrees.  Below 15 degrees uses 15 degree value.   */
+/*   Valid down to the horizon.  Below 2 degrees under it uses the     */
+/*     value for -2 degrees.                                           */
 /*   Global local barometric SitePressure (Torr)                       */
 /*   Global local air temperature SiteTemperature (C)                  */
 /* Output:                                                             */
@@ -336,13 +1264,8 @@ void PointingToTel (double *telra0, double *teldec0,
 
 void Refraction(double *ha, double *dec, int dirflag)
 {
-  double altitude, azimuth, dalt, arg;
+  double altitude, azimuth, dalt;
   double hourangle, declination;
-  extern double SiteTemperature;
-  extern double SitePressure;
-
-  /* Calculate the change in apparent altitude due to refraction */
-  /* Uses 15 degree value for altitudes below 15 degrees */
 
   /* Real to apparent */
   /* Object appears to be higher due to refraction */
@@ -353,22 +1276,7 @@ void Refraction(double *ha, double *dec, int dirflag)
 
   if (dirflag >= 0)
   {  
-    if (altitude >= 15.)
-    {
-      arg = (90.0 - altitude)*PI/180.0;
-      dalt = tan(arg);
-      dalt = 58.276 * dalt - 0.0824 * dalt * dalt * dalt;
-      dalt = dalt / 3600.;
-      dalt = dalt * (SitePressure/(760.*1.01))*(283./(273.+SiteTemperature));
-    }
-   else
-    {
-      arg = (90.0 - 15.0)*PI/180.0;
-      dalt = tan(arg);
-      dalt = 58.276 * dalt - 0.0824 * dalt * dalt * dalt;
-      dalt = dalt / 3600.;
-      dalt = dalt * (SitePressure/(760.*1.01))*(283./(273.+SiteTemperature));
-    }
+    dalt = RefractionTable(sin(altitude*PI/180.), 1)/3600.;
     altitude = altitude + dalt;
   }
   
@@ -377,23 +1285,7 @@ void Refraction(double *ha, double *dec, int dirflag)
   
   else if (dirflag < 0)
   {
-    if (altitude >= 15.)
-    {
-      arg = (90.0 - altitude)*PI/180.0;
-      dalt = tan(arg);
-      dalt = 58.294 * dalt - 0.0668 * dalt * dalt * dalt;
-      dalt = dalt / 3600.;
-      dalt = dalt * (SitePressure/(760.*1.01))*(283./(273.+SiteTemperature));
-    }
-   else
-    {
-      arg = (90.0 - 15.0)*PI/180.0;
-      dalt = tan(arg);
-      dalt = 58.294 * dalt - 0.0668 * dalt * dalt * dalt;
-      dalt = dalt / 3600.;
-      dalt = dalt * (SitePressure/(760.*1.01))*(283./(273.+SiteTemperature));
-    }
-
+    dalt = RefractionTable(sin(altitude*PI/180.), -1)/3600.;
     altitude = altitude - dalt;
   }
    HorizontalToEquatorial(azimuth, altitude, &hourangle, &declination);
@@ -0,0 +1,859 @@
+/* -------------------------------------------------------------------------- */
+/* -                 Artificial satellite ephemerides                       - */
+/* -------------------------------------------------------------------------- */
+/*                                                                            */
+/* Copyright 2026 John Kielkopf                                               */
+/*                                                                            */
+/* Distributed under the terms of the General Public License (see LICENSE)    */
+/*                                                                            */
+/* John Kielkopf (kielkopf@louisville.edu)                                    */
+/*                                                                            */
+/* Date: October 16, 2026                                                     */
+/* Version: 1.0                                                               */
+/*                                                                            */
+/* History:                                                                   */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 1.0                                                              */
+/*     Two-line elements propagated with SGP4 for near Earth orbits           */
+/*     Topocentric azimuth and altitude with refraction                       */
+/*     Passes above the horizon mask tabulated for the mount with splines     */
+/*                                                                            */
+/* -------------------------------------------------------------------------- */
+
+/* The propagator is SGP4 as revised by Vallado, Crawford, Hujsak and        */
+/* Kelso (AIAA 2006-6753) with the WGS72 constants the elements are fitted   */
+/* with.  Orbits with periods of 225 minutes or more need the deep space     */
+/* terms of SDP4 and are refused.                                            */
+/*                                                                           */
+/* Positions are in the TEME frame of the elements, which is turned to the   */
+/* Earth by the mean sidereal time.  The difference from the true equator    */
+/* and equinox of date is under an arcsecond.                                */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "algorithms.h"
+#include "satellite.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/* WGS72 constants for SGP4 */
+
+#define SATMU      398600.8          /* Earth gravitational constant km^3/s^2 */
+#define SATRE      6378.135          /* Equatorial radius in km */
+#define SATJ2      0.001082616
+#define SATJ3     -0.00000253881
+#define SATJ4     -0.00000165597
+#define SATFLAT    (1./298.26)       /* Flattening of the ellipsoid */
+#define SATTWOPI   6.283185307179586
+#define SATDEEP    225.              /* Shortest period in minutes of SDP4 */
+
+extern double SiteLatitude;
+extern double SiteLongitude;
+extern double SiteAltitude;
+
+extern double CalcJD(int ny, int nm, int nd, double ut);
+extern double Map180(double angle);
+extern double RefractionTable(double sa, int dirflag);
+
+int  SatelliteRead(char *line1, char *line2, satellite *sat);
+int  SatellitePropagate(satellite *sat, double jd, double *r, double *v);
+int  SatelliteHorizontal(satellite *sat, timecontext *tc,
+  double *az, double *alt);
+int  SatellitePass(satellite *sat, double utc, satpass *pass);
+int  SatellitePosition(satpass *pass, double utc, double *az,
+  double *alt, double *azrate, double *altrate);
+static int SatelliteChecksum(char *line);
+static double SatelliteField(char *line, int col, int len);
+static double SatelliteExponent(char *line, int col);
+static void SatelliteInit(satellite *sat);
+static int SatelliteVisible(satellite *sat, double utc,
+  double *az, double *alt);
+static void SatelliteKeyhole(satpass *pass);
+static double SatelliteSlope(double *y, int n, int i, int side);
+static void SatelliteHermite(double p1, double v1, double p2, double v2,
+  double t, double s, double *p, double *v);
+static double SatelliteBridgeRate(double d, double v1, double v2, double t);
+static void SatelliteSpline(double *y, double *y2, int n);
+
+
+/* Read the elements from the two lines of a TLE */
+/* Returns FALSE if the lines are not valid or the orbit is deep space */
+
+int SatelliteRead(char *line1, char *line2, satellite *sat)
+{
+  double year, day, deg;
+
+  deg = SATTWOPI/360.;
+
+  if ( (line1 == NULL) || (line2 == NULL) ||
+    (strlen(line1) < 69) || (strlen(line2) < 69) ||
+    (line1[0] != '1') || (line2[0] != '2') ||
+    (strncmp(line1 + 2, line2 + 2, 5) != 0) )
+  {
+    return(FALSE);
+  }
+
+  if ( !SatelliteChecksum(line1) || !SatelliteChecksum(line2) )
+  {
+    return(FALSE);
+  }
+
+  memset(sat, 0, sizeof(satellite));
+  strncpy(sat->name, line1 + 2, 5);
+  sat->name[5] = '\0';
+
+  /* Epoch from a two digit year and the day of the year */
+
+  year = SatelliteField(line1, 18, 2);
+  day = SatelliteField(line1, 20, 12);
+  year = (year < 57.) ? year + 2000. : year + 1900.;
+  sat->epoch = CalcJD((int) year, 1, 1, 0.) + day - 1.;
+
+  sat->bstar = SatelliteExponent(line1, 53);
+  sat->inclo = SatelliteField(line2, 8, 8)*deg;
+  sat->nodeo = SatelliteField(line2, 17, 8)*deg;
+  sat->ecco = SatelliteField(line2, 26, 7)*1.e-7;
+  sat->argpo = SatelliteField(line2, 34, 8)*deg;
+  sat->mo = SatelliteField(line2, 43, 8)*deg;
+  sat->no = SatelliteField(line2, 52, 11)*SATTWOPI/1440.;
+
+  if ( (sat->no <= 0.) || (sat->ecco >= 1.) )
+  {
+    return(FALSE);
+  }
+
+  SatelliteInit(sat);
+
+  if (SATTWOPI/sat->no >= SATDEEP)
+  {
+    return(FALSE);
+  }
+
+  return(TRUE);
+}
+
+
+/* Modulo 10 checksum in the last column with a minus sign counted as 1 */
+
+static int SatelliteChecksum(char *line)
+{
+  int i, sum;
+
+  sum = 0;
+  for (i = 0; i < 68; i++)
+  {
+    if ( (line[i] >= '0') && (line[i] <= '9') )
+    {
+      sum += line[i] - '0';
+    }
+    else if (line[i] == '-')
+    {
+      sum++;
+    }
+  }
+
+  return( (line[68] - '0') == (sum % 10) );
+}
+
+
+/* Number in len columns starting at col counted from 0 */
+
+static double SatelliteField(char *line, int col, int len)
+{
+  char field[16];
+
+  strncpy(field, line + col, len);
+  field[len] = '\0';
+
+  return(atof(field));
+}
+
+
+/* Number written as a signed mantissa with an assumed decimal point */
+/*   followed by a signed power of ten, as " 66816-4" for 0.66816e-4 */
+
+static double SatelliteExponent(char *line, int col)
+{
+  double mantissa, power;
+
+  mantissa = SatelliteField(line, col + 1, 5)*1.e-5;
+  power = SatelliteField(line, col + 6, 2);
+  if (line[col] == '-')
+  {
+    mantissa = -mantissa;
+  }
+
+  return(mantissa*pow(10., power));
+}
+
+
+/* Coefficients of SGP4 that depend only on the elements */
+
+static void SatelliteInit(satellite *sat)
+{
+  double xke, j3oj2, x2o3;
+  double eccsq, omeosq, rteosq, cosio, cosio2, cosio4, sinio;
+  double ak, d1, del, adel, po, posq, pinvsq, rp, perige;
+  double ss, qzms2t, sfour, qzms24, tsi, etasq, eeta, psisq;
+  double coef, coef1, cc2, cc3, con42, xhdot1, temp, temp1, temp2, temp3;
+  double cc1sq;
+
+  xke = 60./sqrt(SATRE*SATRE*SATRE/SATMU);
+  j3oj2 = SATJ3/SATJ2;
+  x2o3 = 2./3.;
+
+  /* Recover the mean motion and semimajor axis from the Kozai mean motion */
+
+  eccsq = sat->ecco*sat->ecco;
+  omeosq = 1. - eccsq;
+  rteosq = sqrt(omeosq);
+  cosio = cos(sat->inclo);
+  cosio2 = cosio*cosio;
+  sinio = sin(sat->inclo);
+
+  ak = pow(xke/sat->no, x2o3);
+  d1 = 0.75*SATJ2*(3.*cosio2 - 1.)/(rteosq*omeosq);
+  del = d1/(ak*ak);
+  adel = ak*(1. - del*del - del*(1./3. + 134.*del*del/81.));
+  del = d1/(adel*adel);
+  sat->no = sat->no/(1. + del);
+
+  sat->ao = pow(xke/sat->no, x2o3);
+  po = sat->ao*omeosq;
+  posq = po*po;
+  pinvsq = 1./posq;
+  rp = sat->ao*(1. - sat->ecco);
+  con42 = 1. - 5.*cosio2;
+  sat->con41 = -con42 - cosio2 - cosio2;
+
+  /* Drag from the atmospheric density above a perigee of 98 to 156 km */
+
+  sat->isimp = (rp < (220./SATRE + 1.));
+  ss = 78./SATRE + 1.;
+  qzms2t = pow((120. - 78.)/SATRE, 4.);
+  sfour = ss;
+  qzms24 = qzms2t;
+  perige = (rp - 1.)*SATRE;
+  if (perige < 156.)
+  {
+    sfour = (perige < 98.) ? 20. : perige - 78.;
+    qzms24 = pow((120. - sfour)/SATRE, 4.);
+    sfour = sfour/SATRE + 1.;
+  }
+
+  tsi = 1./(sat->ao - sfour);
+  sat->eta = sat->ao*sat->ecco*tsi;
+  etasq = sat->eta*sat->eta;
+  eeta = sat->ecco*sat->eta;
+  psisq = fabs(1. - etasq);
+  coef = qzms24*pow(tsi, 4.);
+  coef1 = coef/pow(psisq, 3.5);
+  cc2 = coef1*sat->no*(sat->ao*(1. + 1.5*etasq + eeta*(4. + etasq)) +
+    0.375*SATJ2*tsi/psisq*sat->con41*(8. + 3.*etasq*(8. + etasq)));
+  sat->cc1 = sat->bstar*cc2;
+  cc3 = 0.;
+  if (sat->ecco > 1.e-4)
+  {
+    cc3 = -2.*coef*tsi*j3oj2*sat->no*sinio/sat->ecco;
+  }
+  sat->x1mth2 = 1. - cosio2;
+  sat->cc4 = 2.*sat->no*coef1*sat->ao*omeosq*
+    (sat->eta*(2. + 0.5*etasq) + sat->ecco*(0.5 + 2.*etasq) -
+    SATJ2*tsi/(sat->ao*psisq)*(-3.*sat->con41*(1. - 2.*eeta +
+    etasq*(1.5 - 0.5*eeta)) + 0.75*sat->x1mth2*(2.*etasq -
+    eeta*(1. + etasq))*cos(2.*sat->argpo)));
+  sat->cc5 = 2.*coef1*sat->ao*omeosq*
+    (1. + 2.75*(etasq + eeta) + eeta*etasq);
+
+  /* Secular rates from the zonal harmonics */
+
+  cosio4 = cosio2*cosio2;
+  temp1 = 1.5*SATJ2*pinvsq*sat->no;
+  temp2 = 0.5*temp1*SATJ2*pinvsq;
+  temp3 = -0.46875*SATJ4*pinvsq*pinvsq*sat->no;
+  sat->mdot = sat->no + 0.5*temp1*rteosq*sat->con41 +
+    0.0625*temp2*rteosq*(13. - 78.*cosio2 + 137.*cosio4);
+  sat->argpdot = -0.5*temp1*con42 +
+    0.0625*temp2*(7. - 114.*cosio2 + 395.*cosio4) +
+    temp3*(3. - 36.*cosio2 + 49.*cosio4);
+  xhdot1 = -temp1*cosio;
+  sat->nodedot = xhdot1 + (0.5*temp2*(4. - 19.*cosio2) +
+    2.*temp3*(3. - 7.*cosio2))*cosio;
+
+  sat->omgcof = sat->bstar*cc3*cos(sat->argpo);
+  sat->xmcof = 0.;
+  if (sat->ecco > 1.e-4)
+  {
+    sat->xmcof = -x2o3*coef*sat->bstar/eeta;
+  }
+  sat->nodecf = 3.5*omeosq*xhdot1*sat->cc1;
+  sat->t2cof = 1.5*sat->cc1;
+  temp = (fabs(cosio + 1.) > 1.5e-12) ? 1. + cosio : 1.5e-12;
+  sat->xlcof = -0.25*j3oj2*sinio*(3. + 5.*cosio)/temp;
+  sat->aycof = -0.5*j3oj2*sinio;
+  sat->delmo = pow(1. + sat->eta*cos(sat->mo), 3.);
+  sat->sinmao = sin(sat->mo);
+  sat->x7thm1 = 7.*cosio2 - 1.;
+
+  /* Higher order drag terms unless the perigee is very low */
+
+  if (!sat->isimp)
+  {
+    cc1sq = sat->cc1*sat->cc1;
+    sat->d2 = 4.*sat->ao*tsi*cc1sq;
+    temp = sat->d2*tsi*sat->cc1/3.;
+    sat->d3 = (17.*sat->ao + sfour)*temp;
+    sat->d4 = 0.5*temp*sat->ao*tsi*(221.*sat->ao + 31.*sfour)*sat->cc1;
+    sat->t3cof = sat->d2 + 2.*cc1sq;
+    sat->t4cof = 0.25*(3.*sat->d3 + sat->cc1*(12.*sat->d2 + 10.*cc1sq));
+    sat->t5cof = 0.2*(3.*sat->d4 + 12.*sat->cc1*sat->d3 +
+      6.*sat->d2*sat->d2 + 15.*cc1sq*(2.*sat->d2 + cc1sq));
+  }
+}
+
+
+/* Position r in km and velocity v in km/s in TEME at Julian date jd */
+/* Returns FALSE if the orbit has decayed or the elements failed     */
+
+int SatellitePropagate(satellite *sat, double jd, double *r, double *v)
+{
+  double xke, vkmpersec, t, t2, t3, t4;
+  double xmdf, argpdf, nodedf, argpm, mm, nodem, tempa, tempe, templ;
+  double delomg, delm, temp, am, nm, em, xlm, sinim, cosim;
+  double axnl, aynl, xl, u, eo1, sineo1, coseo1, tem5;
+  double ecose, esine, el2, pl, rl, rdotl, rvdotl, betal;
+  double sinu, cosu, su, sin2u, cos2u, temp1, temp2;
+  double mrt, xnode, xinc, mvt, rvdot;
+  double sinsu, cossu, snod, cnod, sini, cosi, xmx, xmy;
+  double ux, uy, uz, vx, vy, vz;
+  int ktr;
+
+  xke = 60./sqrt(SATRE*SATRE*SATRE/SATMU);
+  vkmpersec = SATRE*xke/60.;
+
+  /* Minutes from the epoch of the elements */
+
+  t = (jd - sat->epoch)*1440.;
+
+  /* Secular gravity and drag */
+
+  xmdf = sat->mo + sat->mdot*t;
+  argpdf = sat->argpo + sat->argpdot*t;
+  nodedf = sat->nodeo + sat->nodedot*t;
+  argpm = argpdf;
+  mm = xmdf;
+  t2 = t*t;
+  nodem = nodedf + sat->nodecf*t2;
+  tempa = 1. - sat->cc1*t;
+  tempe = sat->bstar*sat->cc4*t;
+  templ = sat->t2cof*t2;
+
+  if (!sat->isimp)
+  {
+    delomg = sat->omgcof*t;
+    delm = sat->xmcof*(pow(1. + sat->eta*cos(xmdf), 3.) - sat->delmo);
+    temp = delomg + delm;
+    mm = xmdf + temp;
+    argpm = argpdf - temp;
+    t3 = t2*t;
+    t4 = t3*t;
+    tempa = tempa - sat->d2*t2 - sat->d3*t3 - sat->d4*t4;
+    tempe = tempe + sat->bstar*sat->cc5*(sin(mm) - sat->sinmao);
+    templ = templ + sat->t3cof*t3 + t4*(sat->t4cof + t*sat->t5cof);
+  }
+
+  am = pow(xke/sat->no, 2./3.)*tempa*tempa;
+  if (am <= 0.)
+  {
+    return(FALSE);
+  }
+  nm = xke/pow(am, 1.5);
+  em = sat->ecco - tempe;
+  if ( (em >= 1.) || (em < -0.001) )
+  {
+    return(FALSE);
+  }
+  if (em < 1.e-6)
+  {
+    em = 1.e-6;
+  }
+
+  mm = mm + sat->no*templ;
+  xlm = mm + argpm + nodem;
+  nodem = fmod(nodem, SATTWOPI);
+  argpm = fmod(argpm, SATTWOPI);
+  xlm = fmod(xlm, SATTWOPI);
+  mm = fmod(xlm - argpm - nodem, SATTWOPI);
+  sinim = sin(sat->inclo);
+  cosim = cos(sat->inclo);
+
+  /* Long period periodics */
+
+  axnl = em*cos(argpm);
+  temp = 1./(am*(1. - em*em));
+  aynl = em*sin(argpm) + temp*sat->aycof;
+  xl = mm + argpm + nodem + temp*sat->xlcof*axnl;
+
+  /* Kepler's equation */
+
+  u = fmod(xl - nodem, SATTWOPI);
+  eo1 = u;
+  tem5 = 9999.9;
+  sineo1 = 0.;
+  coseo1 = 1.;
+  for (ktr = 0; (ktr < 10) && (fabs(tem5) >= 1.e-12); ktr++)
+  {
+    sineo1 = sin(eo1);
+    coseo1 = cos(eo1);
+    tem5 = 1. - coseo1*axnl - sineo1*aynl;
+    tem5 = (u - aynl*coseo1 + axnl*sineo1 - eo1)/tem5;
+    if (fabs(tem5) >= 0.95)
+    {
+      tem5 = (tem5 > 0.) ? 0.95 : -0.95;
+    }
+    eo1 = eo1 + tem5;
+  }
+
+  /* Short period periodics */
+
+  ecose = axnl*coseo1 + aynl*sineo1;
+  esine = axnl*sineo1 - aynl*coseo1;
+  el2 = axnl*axnl + aynl*aynl;
+  pl = am*(1. - el2);
+  if (pl < 0.)
+  {
+    return(FALSE);
+  }
+
+  rl = am*(1. - ecose);
+  rdotl = sqrt(am)*esine/rl;
+  rvdotl = sqrt(pl)/rl;
+  betal = sqrt(1. - el2);
+  temp = esine/(1. + betal);
+  sinu = am/rl*(sineo1 - aynl - axnl*temp);
+  cosu = am/rl*(coseo1 - axnl + aynl*temp);
+  su = atan2(sinu, cosu);
+  sin2u = (cosu + cosu)*sinu;
+  cos2u = 1. - 2.*sinu*sinu;
+  temp = 1./pl;
+  temp1 = 0.5*SATJ2*temp;
+  temp2 = temp1*temp;
+
+  mrt = rl*(1. - 1.5*temp2*betal*sat->con41) +
+    0.5*temp1*sat->x1mth2*cos2u;
+  su = su - 0.25*temp2*sat->x7thm1*sin2u;
+  xnode = nodem + 1.5*temp2*cosim*sin2u;
+  xinc = sat->inclo + 1.5*temp2*cosim*sinim*cos2u;
+  mvt = rdotl - nm*temp1*sat->x1mth2*sin2u/xke;
+  rvdot = rvdotl + nm*temp1*(sat->x1mth2*cos2u + 1.5*sat->con41)/xke;
+
+  /* Orientation vectors */
+
+  sinsu = sin(su);
+  cossu = cos(su);
+  snod = sin(xnode);
+  cnod = cos(xnode);
+  sini = sin(xinc);
+  cosi = cos(xinc);
+  xmx = -snod*cosi;
+  xmy = cnod*cosi;
+  ux = xmx*sinsu + cnod*cossu;
+  uy = xmy*sinsu + snod*cossu;
+  uz = sini*sinsu;
+  vx = xmx*cossu - cnod*sinsu;
+  vy = xmy*cossu - snod*sinsu;
+  vz = sini*cossu;
+
+  r[0] = mrt*ux*SATRE;
+  r[1] = mrt*uy*SATRE;
+  r[2] = mrt*uz*SATRE;
+  v[0] = (mvt*ux + rvdot*vx)*vkmpersec;
+  v[1] = (mvt*uy + rvdot*vy)*vkmpersec;
+  v[2] = (mvt*uz + rvdot*vz)*vkmpersec;
+
+  /* Below the surface of the Earth */
+
+  if (mrt < 1.)
+  {
+    return(FALSE);
+  }
+
+  return(TRUE);
+}
+
+
+/* Apparent azimuth and altitude in degrees seen from the site at the time */
+/*   of tc, with azimuth from north through east                          */
+
+int SatelliteHorizontal(satellite *sat, timecontext *tc,
+  double *az, double *alt)
+{
+  double r[3], v[3], site[3], rho[3];
+  double gmst, sg, cg, lat, lon, sphi, cphi, slam, clam, e2, n, h;
+  double x, y, south, east, zenith, range, sa;
+
+  if (!SatellitePropagate(sat, tc->jd, r, v))
+  {
+    return(FALSE);
+  }
+
+  /* Turn TEME to the Earth by the mean sidereal time at Greenwich */
+
+  gmst = (tc->lst + SiteLongitude/15.)*SATTWOPI/24.;
+  sg = sin(gmst);
+  cg = cos(gmst);
+  x = cg*r[0] + sg*r[1];
+  y = -sg*r[0] + cg*r[1];
+
+  /* Site on the ellipsoid with longitude east */
+
+  lat = SiteLatitude*SATTWOPI/360.;
+  lon = -SiteLongitude*SATTWOPI/360.;
+  sphi = sin(lat);
+  cphi = cos(lat);
+  slam = sin(lon);
+  clam = cos(lon);
+  e2 = SATFLAT*(2. - SATFLAT);
+  n = SATRE/sqrt(1. - e2*sphi*sphi);
+  h = SiteAltitude/1000.;
+  site[0] = (n + h)*cphi*clam;
+  site[1] = (n + h)*cphi*slam;
+  site[2] = (n*(1. - e2) + h)*sphi;
+
+  rho[0] = x - site[0];
+  rho[1] = y - site[1];
+  rho[2] = r[2] - site[2];
+
+  south = sphi*clam*rho[0] + sphi*slam*rho[1] - cphi*rho[2];
+  east = -slam*rho[0] + clam*rho[1];
+  zenith = cphi*clam*rho[0] + cphi*slam*rho[1] + sphi*rho[2];
+  range = sqrt(south*south + east*east + zenith*zenith);
+
+  sa = zenith/range;
+  *alt = asin(sa)*360./SATTWOPI;
+  *az = atan2(east, -south)*360./SATTWOPI;
+  if (*az < 0.)
+  {
+    *az += 360.;
+  }
+
+  /* Refraction from real to apparent above the horizon */
+
+  if (*alt > 0.)
+  {
+    *alt += RefractionTable(sa, 1)/3600.;
+  }
+
+  return(TRUE);
+}
+
+
+/* Satellite above the minimum altitude and the horizon mask at utc */
+
+static int SatelliteVisible(satellite *sat, double utc,
+  double *az, double *alt)
+{
+  timecontext tc;
+
+  TimeAt(&tc, utc);
+  if (!SatelliteHorizontal(sat, &tc, az, alt))
+  {
+    return(FALSE);
+  }
+
+  return( (*alt >= SATMINALT) && (*alt >= HorizonAltitude(*az)) );
+}
+
+
+/* Tabulate the pass in progress at utc or the next one within SATSEARCH */
+/* Returns FALSE if there is none                                        */
+
+int SatellitePass(satellite *sat, double utc, satpass *pass)
+{
+  double t, tend, az, alt;
+  int i;
+
+  /* Search ahead in coarse steps and then back to the first node */
+
+  t = utc;
+  tend = utc + SATSEARCH*3600.;
+  if (!SatelliteVisible(sat, t, &az, &alt))
+  {
+    while (!SatelliteVisible(sat, t, &az, &alt))
+    {
+      t += SATCOARSE;
+      if (t > tend)
+      {
+        return(FALSE);
+      }
+    }
+    t -= SATCOARSE;
+    while (!SatelliteVisible(sat, t, &az, &alt))
+    {
+      t += SATSTEP;
+    }
+  }
+
+  /* Nodes until it sets with the azimuth unwrapped */
+
+  pass->rise = t;
+  pass->maxalt = alt;
+  pass->n = 0;
+  while (pass->n < SATNODES)
+  {
+    i = pass->n;
+    pass->az[i] = (i == 0) ? az :
+      pass->az[i - 1] + Map180(az - pass->az[i - 1]);
+    pass->alt[i] = alt;
+    if (alt > pass->maxalt)
+    {
+      pass->maxalt = alt;
+    }
+    pass->n++;
+    t += SATSTEP;
+    if (!SatelliteVisible(sat, t, &az, &alt))
+    {
+      break;
+    }
+  }
+
+  if (pass->n < 2)
+  {
+    return(FALSE);
+  }
+
+  pass->set = pass->rise + (pass->n - 1)*SATSTEP;
+
+  SatelliteKeyhole(pass);
+  SatelliteSpline(pass->az, pass->az2, pass->n);
+  SatelliteSpline(pass->alt, pass->alt2, pass->n);
+
+  return(TRUE);
+}
+
+
+/* Bridge the nodes the azimuth drive cannot follow near the zenith       */
+/* The bridge is a cubic that joins the pass with its rates at both ends */
+/*   so that the drives need not turn around at once                     */
+
+static void SatelliteKeyhole(satpass *pass)
+{
+  double maxstep, da, db, v1, v2, ra, rb, t, offset, p, v, *y;
+  int i, i1, i2, flip, axis;
+
+  pass->flip = pass->n;
+  pass->keyin = 0;
+  pass->keyout = 0;
+
+  /* First and last step faster than the drive */
+
+  maxstep = SATMAXAZRATE*SATSTEP;
+  i1 = -1;
+  i2 = -1;
+  for (i = 0; i < pass->n - 1; i++)
+  {
+    if (fabs(pass->az[i + 1] - pass->az[i]) > maxstep)
+    {
+      if (i1 < 0)
+      {
+        i1 = i;
+      }
+      i2 = i + 1;
+    }
+  }
+
+  if (i1 < 0)
+  {
+    return;
+  }
+
+  /* Widen the bridge until the drive can cross it the shorter way */
+
+  flip = FALSE;
+  da = 0.;
+  db = 0.;
+  for (;;)
+  {
+    t = (i2 - i1)*SATSTEP;
+    v1 = SatelliteSlope(pass->az, pass->n, i1, -1);
+    v2 = SatelliteSlope(pass->az, pass->n, i2, 1);
+    da = pass->az[i2] - pass->az[i1];
+    db = Map180(pass->az[i2] + 180. - pass->az[i1]);
+    ra = SatelliteBridgeRate(da, v1, v2, t);
+    rb = SatelliteBridgeRate(db, v1, v2, t);
+    flip = (SATOVERZENITH && (rb < ra));
+    if ( ((flip ? rb : ra) <= SATMAXAZRATE) ||
+      ((i1 == 0) && (i2 == pass->n - 1)) )
+    {
+      break;
+    }
+    if (i1 > 0)
+    {
+      i1--;
+    }
+    if (i2 < pass->n - 1)
+    {
+      i2++;
+    }
+  }
+
+  /* Over the top from the end of the bridge */
+
+  if (flip)
+  {
+    offset = pass->az[i1] + db - pass->az[i2];
+    for (i = i2; i < pass->n; i++)
+    {
+      pass->az[i] += offset;
+      pass->alt[i] = 180. - pass->alt[i];
+    }
+    pass->flip = i2;
+  }
+
+  t = (i2 - i1)*SATSTEP;
+  for (axis = 0; axis < 2; axis++)
+  {
+    y = (axis == 0) ? pass->az : pass->alt;
+    v1 = SatelliteSlope(y, pass->n, i1, -1);
+    v2 = SatelliteSlope(y, pass->n, i2, 1);
+    for (i = i1 + 1; i < i2; i++)
+    {
+      SatelliteHermite(y[i1], v1, y[i2], v2, t, 
+        (double) (i - i1)/(double) (i2 - i1), &p, &v);
+      y[i] = p;
+    }
+  }
+
+  pass->keyin = i1;
+  pass->keyout = i2;
+}
+
+
+/* Rate at node i from the side of the pass away from a bridge */
+/* The side is -1 for the nodes before i and 1 for those after */
+
+static double SatelliteSlope(double *y, int n, int i, int side)
+{
+  if ( ((side < 0) && (i > 0)) || (i == n - 1) )
+  {
+    return( (y[i] - y[i - 1])/SATSTEP );
+  }
+  return( (y[i + 1] - y[i])/SATSTEP );
+}
+
+
+/* Cubic from p1 with rate v1 to p2 with rate v2 in time t */
+/* Position p and rate v at the fraction s of the way      */
+
+static void SatelliteHermite(double p1, double v1, double p2, double v2,
+  double t, double s, double *p, double *v)
+{
+  double s2, s3;
+
+  s2 = s*s;
+  s3 = s2*s;
+  *p = (2.*s3 - 3.*s2 + 1.)*p1 + (s3 - 2.*s2 + s)*t*v1 +
+    (-2.*s3 + 3.*s2)*p2 + (s3 - s2)*t*v2;
+  *v = 6.*(s - s2)*(p2 - p1)/t + (3.*s2 - 4.*s + 1.)*v1 + 
+    (3.*s2 - 2.*s)*v2;
+}
+
+
+/* Fastest rate on a bridge that changes the angle by d in time t */
+
+static double SatelliteBridgeRate(double d, double v1, double v2, double t)
+{
+  double p, v, rate;
+  int i;
+
+  rate = 0.;
+  for (i = 0; i <= 32; i++)
+  {
+    SatelliteHermite(0., v1, d, v2, t, i/32., &p, &v);
+    if (fabs(v) > rate)
+    {
+      rate = fabs(v);
+    }
+  }
+
+  return(rate);
+}
+
+
+/* Second derivatives of the natural cubic spline through n values of y */
+/*   at SATSTEP                                                          */
+
+static void SatelliteSpline(double *y, double *y2, int n)
+{
+  static double c[SATNODES];
+  double m;
+  int i;
+
+  /* Tridiagonal system with 1 4 1 on the diagonals */
+
+  y2[0] = 0.;
+  c[0] = 0.;
+  for (i = 1; i < n - 1; i++)
+  {
+    m = 4. - c[i - 1];
+    c[i] = 1./m;
+    y2[i] = (6.*(y[i + 1] - 2.*y[i] + y[i - 1])/(SATSTEP*SATSTEP) -
+      y2[i - 1])/m;
+  }
+  y2[n - 1] = 0.;
+  for (i = n - 2; i > 0; i--)
+  {
+    y2[i] = y2[i] - c[i]*y2[i + 1];
+  }
+}
+
+
+/* Mount azimuth and altitude in degrees and their rates in deg/s at utc */
+/* Returns FALSE outside of the pass with the nearest end and zero rates */
+
+int SatellitePosition(satpass *pass, double utc, double *az,
+  double *alt, double *azrate, double *altrate)
+{
+  double x, a, b, h;
+  int i;
+
+  h = SATSTEP;
+  x = (utc - pass->rise)/h;
+  if ( (x < 0.) || (x > pass->n - 1) )
+  {
+    i = (x < 0.) ? 0 : pass->n - 1;
+    *az = pass->az[i];
+    *alt = pass->alt[i];
+    *azrate = 0.;
+    *altrate = 0.;
+    return(FALSE);
+  }
+
+  i = (int) x;
+  if (i > pass->n - 2)
+  {
+    i = pass->n - 2;
+  }
+  a = (i + 1) - x;
+  b = x - i;
+
+  *az = a*pass->az[i] + b*pass->az[i + 1] +
+    ((a*a*a - a)*pass->az2[i] + (b*b*b - b)*pass->az2[i + 1])*h*h/6.;
+  *alt = a*pass->alt[i] + b*pass->alt[i + 1] +
+    ((a*a*a - a)*pass->alt2[i] + (b*b*b - b)*pass->alt2[i + 1])*h*h/6.;
+  *azrate = (pass->az[i + 1] - pass->az[i])/h -
+    (3.*a*a - 1.)*h*pass->az2[i]/6. + (3.*b*b - 1.)*h*pass->az2[i + 1]/6.;
+  *altrate = (pass->alt[i + 1] - pass->alt[i])/h -
+    (3.*a*a - 1.)*h*pass->alt2[i]/6. + (3.*b*b - 1.)*h*pass->alt2[i + 1]/6.;
+
+  return(TRUE);
+}
@@ -0,0 +1,107 @@
+/* -----------------------------------------------------------                */
+/* -         Header for artificial satellite ephemerides     -                */
+/* -----------------------------------------------------------                */
+/*                                                                            */
+/* Copyright 2026 John Kielkopf                                               */
+/* kielkopf@louisville.edu                                                    */
+/*                                                                            */
+/* Distributed under the terms of the General Public License (see LICENSE)    */
+/*                                                                            */
+/* Date: October 16, 2026                                                     */
+/* Version: 1.0                                                               */
+/*                                                                            */
+/* History:                                                                   */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 1.0                                                              */
+/*   SGP4 propagation of two-line elements for near Earth orbits              */
+/*   Passes tabulated in mount azimuth and altitude with cubic splines        */
+/*                                                                            */
+
+
+/* Passes                                                                     */
+/* A pass is tabulated every SATSTEP seconds from the time the satellite      */
+/* rises above SATMINALT and the horizon mask until it sets, and the mount    */
+/* azimuth and altitude between the nodes are found from cubic splines.       */
+
+#ifndef SATSTEP
+#define SATSTEP       1.     /* Seconds between nodes of a pass */
+#endif
+
+#ifndef SATNODES
+#define SATNODES      3600   /* Most nodes in one pass */
+#endif
+
+#ifndef SATCOARSE
+#define SATCOARSE     20.    /* Seconds between tests in the search */
+#endif
+
+#ifndef SATSEARCH
+#define SATSEARCH     24.    /* Hours ahead to search for the next pass */
+#endif
+
+#ifndef SATMINALT
+#define SATMINALT     10.    /* Lowest altitude of a pass in degrees */
+#endif
+
+/* Zenith passes                                                              */
+/* Near the zenith an alt-az mount must turn in azimuth as fast as the        */
+/* satellite moves divided by its distance from the zenith.  Where a pass     */
+/* needs more than SATMAXAZRATE the nodes are bridged by a smooth move of the */
+/* mount that the drive can follow.  When the altitude axis can go past       */
+/* the zenith, the mount leaves the bridge at 180 degrees minus the altitude  */
+/* with the azimuth turned by 180 degrees if that is the shorter way round,   */
+/* and carries on over the top to the end of the pass.                        */
+
+#ifndef SATOVERZENITH
+#define SATOVERZENITH 1      /* Set to 0 if the altitude axis stops at 90 */
+#endif
+
+#ifndef SATMAXAZRATE
+#define SATMAXAZRATE  3.     /* Fastest azimuth rate in deg/s to follow */
+#endif
+
+/* Elements and the SGP4 coefficients found from them */
+
+typedef struct satellite
+{
+  char name[8];     /* Catalog number */
+  double epoch;     /* Julian date of the elements */
+  double no;        /* Mean motion in radians per minute */
+  double ecco;      /* Eccentricity */
+  double inclo;     /* Inclination in radians */
+  double nodeo;     /* Right ascension of the ascending node in radians */
+  double argpo;     /* Argument of perigee in radians */
+  double mo;        /* Mean anomaly in radians */
+  double bstar;     /* Drag term in inverse Earth radii */
+  int isimp;        /* Perigee low enough for the simplified drag terms */
+  double ao, con41, cc1, cc4, cc5, d2, d3, d4, delmo, eta;
+  double argpdot, omgcof, sinmao, t2cof, t3cof, t4cof, t5cof;
+  double x1mth2, x7thm1, mdot, nodedot, xlcof, xmcof, nodecf, aycof;
+} satellite;
+
+/* Tabulated pass in mount coordinates */
+
+typedef struct satpass
+{
+  double rise;                 /* Time of the first node in utc seconds */
+  double set;                  /* Time of the last node */
+  double maxalt;               /* Highest altitude in degrees */
+  int n;                       /* Number of nodes */
+  int flip;                    /* First node over the zenith or n */
+  int keyin;                   /* First and last node of the bridge */
+  int keyout;                  /*   across the keyhole, both 0 if none */
+  double az[SATNODES];         /* Mount azimuth in degrees without wraps */
+  double alt[SATNODES];        /* Mount altitude in degrees */
+  double az2[SATNODES];        /* Second derivatives of the splines */
+  double alt2[SATNODES];
+} satpass;
+
+extern int  SatelliteRead(char *line1, char *line2, satellite *sat);
+extern int  SatellitePropagate(satellite *sat, double jd, double *r,
+  double *v);
+extern int  SatelliteHorizontal(satellite *sat, timecontext *tc,
+  double *az, double *alt);
+extern int  SatellitePass(satellite *sat, double utc, satpass *pass);
+extern int  SatellitePosition(satpass *pass, double utc, double *az,
+  double *alt, double *azrate, double *altrate);
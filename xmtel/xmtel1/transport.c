@@ -0,0 +1,493 @@
+/* -------------------------------------------------------------------------- */
+/* -              Shared transport for telescope control links              - */
+/* -------------------------------------------------------------------------- */
+/*                                                                            */
+/* Copyright 2026 John Kielkopf                                               */
+/*                                                                            */
+/* Distributed under the terms of the General Public License (see LICENSE)    */
+/*                                                                            */
+/* John Kielkopf (kielkopf@louisville.edu)                                    */
+/*                                                                            */
+/* Date: October 16, 2026                                                     */
+/* Version: 1.0                                                               */
+/*                                                                            */
+/* History:                                                                   */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 1.0                                                              */
+/*     Replaces the select() based telstat and readn in the protocols         */
+/*     One epoll event loop for serial ports, XEphem fifos and sockets        */
+/*     Deadlines kept on a timerfd with microsecond resolution                */
+/*                                                                            */
+/* -------------------------------------------------------------------------- */
+
+/* All descriptors are watched by one epoll instance.  Its own descriptor    */
+/* is returned by TransportOpen so that a user interface main loop may call  */
+/* TransportDispatch when any of them is ready.                              */
+/*                                                                           */
+/* A protocol waiting on its link with TransportWait uses the same epoll     */
+/* instance with a timerfd armed at the deadline.  Other descriptors that    */
+/* become ready meanwhile are set aside without calling their handlers, so   */
+/* a handler never runs in the middle of a telescope command.  They are      */
+/* enabled again before TransportWait returns and are serviced by the next   */
+/* TransportDispatch.                                                        */
+/*                                                                           */
+/* A descriptor watched without a handler has unsolicited input read and     */
+/* discarded by TransportDispatch.                                           */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "transport.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+typedef struct
+{
+  int fd;                      /* Watched descriptor or -1 */
+  transporthandler handler;    /* Called when input is ready or NULL */
+  void *arg;                   /* Handler argument */
+  int deferred;                /* Set aside during a TransportWait */
+} transportwatch;
+
+static transportwatch watchlist[TRANSPORTMAXFD];
+static int epollfd = -1;                /* Event loop */
+static int timerfd = -1;                /* Deadline timer */
+
+static transportwatch *TransportFind(int fd);
+static void TransportResume(void);
+static void TransportDeadline(struct timespec *deadline, long usec);
+
+
+/* Create the event loop if needed */
+/* Returns the epoll descriptor or -1 on failure */
+
+int TransportOpen(void)
+{
+  struct epoll_event ev;
+  int i;
+
+  if (epollfd >= 0)
+  {
+    return (epollfd);
+  }
+
+  epollfd = epoll_create1(EPOLL_CLOEXEC);
+  if (epollfd < 0)
+  {
+    fprintf(stderr,"Transport event loop not available ...\n");
+    return (-1);
+  }
+
+  timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timerfd < 0)
+  {
+    fprintf(stderr,"Transport deadline timer not available ...\n");
+    close(epollfd);
+    epollfd = -1;
+    return (-1);
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = timerfd;
+  epoll_ctl(epollfd, EPOLL_CTL_ADD, timerfd, &ev);
+
+  for (i = 0; i < TRANSPORTMAXFD; i++)
+  {
+    watchlist[i].fd = -1;
+  }
+
+  return (epollfd);
+}
+
+
+/* Release the event loop */
+
+void TransportClose(void)
+{
+  int i;
+
+  if (epollfd < 0)
+  {
+    return;
+  }
+  for (i = 0; i < TRANSPORTMAXFD; i++)
+  {
+    watchlist[i].fd = -1;
+  }
+  close(timerfd);
+  close(epollfd);
+  timerfd = -1;
+  epollfd = -1;
+}
+
+
+/* Watch a descriptor for input                                            */
+/* The handler is called from TransportDispatch when input is ready        */
+/* Watching a descriptor again replaces its handler                        */
+/* Returns 0 on success and -1 on failure                                  */
+
+int TransportWatch(int fd, transporthandler handler, void *arg)
+{
+  struct epoll_event ev;
+  transportwatch *w;
+  int i;
+
+  if ( (fd < 0) || (TransportOpen() < 0) )
+  {
+    return (-1);
+  }
+
+  w = TransportFind(fd);
+  if (w == NULL)
+  {
+    for (i = 0; i < TRANSPORTMAXFD; i++)
+    {
+      if (watchlist[i].fd < 0)
+      {
+        w = &watchlist[i];
+        break;
+      }
+    }
+    if (w == NULL)
+    {
+      fprintf(stderr,"Too many descriptors for the transport event loop\n");
+      return (-1);
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if ( (epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &ev) < 0) &&
+      (errno != EEXIST) )
+    {
+      fprintf(stderr,"Transport cannot watch descriptor %d\n", fd);
+      return (-1);
+    }
+    w->fd = fd;
+    w->deferred = FALSE;
+  }
+
+  w->handler = handler;
+  w->arg = arg;
+  return (0);
+}
+
+
+/* Stop watching a descriptor */
+/* Call before closing it */
+
+void TransportUnwatch(int fd)
+{
+  transportwatch *w;
+
+  w = TransportFind(fd);
+  if (w == NULL)
+  {
+    return;
+  }
+  epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, NULL);
+  w->fd = -1;
+}
+
+
+/* Service watched descriptors that are ready                              */
+/* Waits no longer than usec for the first one, or not at all if usec is 0 */
+/* Returns the number of handlers called                                   */
+
+int TransportDispatch(long usec)
+{
+  struct epoll_event ev[TRANSPORTMAXFD + 1];
+  transportwatch *w;
+  char discard[256];
+  unsigned long long expirations;
+  int nev, i, ncalled;
+
+  if (TransportOpen() < 0)
+  {
+    return (0);
+  }
+
+  TransportResume();
+
+  nev = epoll_wait(epollfd, ev, TRANSPORTMAXFD + 1,
+    (usec > 0) ? (int) ((usec + 999)/1000) : 0);
+
+  ncalled = 0;
+  for (i = 0; i < nev; i++)
+  {
+    if (ev[i].data.fd == timerfd)
+    {
+
+      /* Clear a deadline that passed while no one was waiting */
+
+      if (read(timerfd, &expirations, sizeof(expirations)) < 0)
+      {
+        expirations = 0;
+      }
+      continue;
+    }
+
+    w = TransportFind(ev[i].data.fd);
+    if (w == NULL)
+    {
+      continue;
+    }
+
+    if (w->handler != NULL)
+    {
+      w->handler(w->fd, w->arg);
+      ncalled++;
+    }
+    else if (read(w->fd, discard, sizeof(discard)) <= 0)
+    {
+
+      /* Closed or failed without being unwatched */
+
+      TransportUnwatch(ev[i].data.fd);
+    }
+  }
+
+  return (ncalled);
+}
+
+
+/* Wait for input on a link                                                */
+/* The timeout usec is in microseconds and 0 effects a poll                */
+/* Returns 1 when data are available, 0 on timeout and -1 on error         */
+
+int TransportWait(int fd, long usec)
+{
+  struct epoll_event ev[TRANSPORTMAXFD + 1];
+  struct itimerspec its;
+  struct timespec deadline, now;
+  transportwatch *w;
+  unsigned long long expirations;
+  int nev, i, ready;
+
+  if (TransportFind(fd) == NULL)
+  {
+    if (TransportWatch(fd, NULL, NULL) < 0)
+    {
+      return (-1);
+    }
+  }
+
+  /* Arm the timer at the deadline */
+
+  TransportDeadline(&deadline, usec);
+  if (usec > 0)
+  {
+    memset(&its, 0, sizeof(its));
+    its.it_value = deadline;
+    timerfd_settime(timerfd, TFD_TIMER_ABSTIME, &its, NULL);
+  }
+
+  ready = 0;
+  for (;;)
+  {
+    nev = epoll_wait(epollfd, ev, TRANSPORTMAXFD + 1, (usec > 0) ? -1 : 0);
+    if (nev < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      ready = -1;
+      break;
+    }
+    if (nev == 0)
+    {
+      break;
+    }
+
+    for (i = 0; i < nev; i++)
+    {
+      if (ev[i].data.fd == fd)
+      {
+        ready = 1;
+      }
+      else if (ev[i].data.fd == timerfd)
+      {
+        if (read(timerfd, &expirations, sizeof(expirations)) < 0)
+        {
+          expirations = 0;
+        }
+      }
+      else
+      {
+
+        /* Another descriptor is ready: leave it for the main loop */
+
+        w = TransportFind(ev[i].data.fd);
+        if ( (w != NULL) && !w->deferred )
+        {
+          ev[i].events = 0;
+          epoll_ctl(epollfd, EPOLL_CTL_MOD, w->fd, &ev[i]);
+          w->deferred = TRUE;
+        }
+      }
+    }
+
+    if (ready != 0)
+    {
+      break;
+    }
+
+    /* The timer may hold an expiration from an earlier deadline */
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if ( (usec <= 0) || (now.tv_sec > deadline.tv_sec) ||
+      ( (now.tv_sec == deadline.tv_sec) && (now.tv_nsec >= deadline.tv_nsec) ) )
+    {
+      break;
+    }
+  }
+
+  TransportResume();
+  return (ready);
+}
+
+
+/* Read nbytes from a link before a deadline usec microseconds from now */
+/* Returns the number of bytes read */
+
+int TransportRead(int fd, void *ptr, int nbytes, long usec)
+{
+  struct timespec deadline, now;
+  char *p;
+  long left;
+  int nleft, nread;
+
+  TransportDeadline(&deadline, usec);
+  p = (char *) ptr;
+  nleft = nbytes;
+  while (nleft > 0)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    left = (deadline.tv_sec - now.tv_sec)*1000000L +
+      (deadline.tv_nsec - now.tv_nsec)/1000L;
+    if (left < 0)
+    {
+      left = 0;
+    }
+    if (TransportWait(fd, left) <= 0)
+    {
+      break;
+    }
+    nread = read(fd, p, nleft);
+    if (nread <= 0)
+    {
+      break;
+    }
+    nleft -= nread;
+    p += nread;
+  }
+  return (nbytes - nleft);
+}
+
+
+/* Write nbytes to a link */
+/* Returns the number of bytes written */
+
+int TransportWrite(int fd, void *ptr, int nbytes)
+{
+  char *p;
+  int nleft, nwritten;
+
+  p = (char *) ptr;
+  nleft = nbytes;
+  while (nleft > 0)
+  {
+    nwritten = write(fd, p, nleft);
+    if (nwritten < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      if (errno == EAGAIN)
+      {
+        usleep(1000);
+        continue;
+      }
+    }
+    if (nwritten <= 0)
+    {
+      break;
+    }
+    nleft -= nwritten;
+    p += nwritten;
+  }
+  return (nbytes - nleft);
+}
+
+
+/* Find the watch entry for a descriptor */
+
+static transportwatch *TransportFind(int fd)
+{
+  int i;
+
+  if (epollfd < 0)
+  {
+    return (NULL);
+  }
+  for (i = 0; i < TRANSPORTMAXFD; i++)
+  {
+    if (watchlist[i].fd == fd)
+    {
+      return (&watchlist[i]);
+    }
+  }
+  return (NULL);
+}
+
+
+/* Enable descriptors set aside during a wait */
+
+static void TransportResume(void)
+{
+  struct epoll_event ev;
+  int i;
+
+  for (i = 0; i < TRANSPORTMAXFD; i++)
+  {
+    if ( (watchlist[i].fd >= 0) && watchlist[i].deferred )
+    {
+      memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN;
+      ev.data.fd = watchlist[i].fd;
+      epoll_ctl(epollfd, EPOLL_CTL_MOD, watchlist[i].fd, &ev);
+      watchlist[i].deferred = FALSE;
+    }
+  }
+}
+
+
+/* Monotonic time usec microseconds from now */
+
+static void TransportDeadline(struct timespec *deadline, long usec)
+{
+  clock_gettime(CLOCK_MONOTONIC, deadline);
+  deadline->tv_sec += usec/1000000L;
+  deadline->tv_nsec += (usec%1000000L)*1000L;
+  if (deadline->tv_nsec >= 1000000000L)
+  {
+    deadline->tv_sec++;
+    deadline->tv_nsec -= 1000000000L;
+  }
+}
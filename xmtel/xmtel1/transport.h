@@ -0,0 +1,43 @@
+/* -----------------------------------------------------------                */
+/* -         Header for the shared telescope transport       -                */
+/* -----------------------------------------------------------                */
+/*                                                                            */
+/* Copyright 2026 John Kielkopf                                               */
+/* kielkopf@louisville.edu                                                    */
+/*                                                                            */
+/* Distributed under the terms of the General Public License (see LICENSE)    */
+/*                                                                            */
+/* Date: October 16, 2026                                                     */
+/* Version: 1.0                                                               */
+/*                                                                            */
+/* History:                                                                   */
+/*                                                                            */
+/* October 16, 2026                                                           */
+/*   Version 1.0                                                              */
+/*   Event loop on epoll with timerfd deadlines for all protocols             */
+/*                                                                            */
+
+
+/* Largest number of file descriptors the event loop will watch */
+
+#ifndef TRANSPORTMAXFD
+#define TRANSPORTMAXFD 16
+#endif
+
+/* Handler called when a watched descriptor has data to read */
+
+typedef void (*transporthandler)(int fd, void *arg);
+
+/* Event loop */
+
+extern int  TransportOpen(void);
+extern void TransportClose(void);
+extern int  TransportWatch(int fd, transporthandler handler, void *arg);
+extern void TransportUnwatch(int fd);
+extern int  TransportDispatch(long usec);
+
+/* Link input and output with microsecond deadlines */
+
+extern int  TransportWait(int fd, long usec);
+extern int  TransportRead(int fd, void *ptr, int nbytes, long usec);
+extern int  TransportWrite(int fd, void *ptr, int nbytes);
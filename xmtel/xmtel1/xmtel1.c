@@ -45,6 +45,7 @@
 #include <Xm/List.h>
 
 #include "protocol.h"
+#include "transport.h"
 #include "xmtel1.h"
 
 /* Motif GUI */ 
@@ -59,6 +60,7 @@ Widget file_menu;
 Widget newqueue_item;
 Widget newlog_item;
 Widget newconfig_item;
+Widget satellite_item;
 Widget exit_item;
 Widget edit_menu;
 Widget editqueue_item;
@@ -84,6 +86,7 @@ Widget model_clear_item;
 Widget model_save_item;
 Widget model_recall_item;
 Widget model_default_item;
+Widget model_sync_item;
 
 
 
@@ -116,6 +119,7 @@ Widget get_targetepoch;
 Widget select_logfile;
 Widget read_queuefile;
 Widget select_configfile;
+Widget read_tlefile;
 
 Widget queue_area;
 Widget message_area;
@@ -197,6 +201,7 @@ void selectlogCB();        /* Callback function for selecting the log file    */
 void readqueueCB();        /* Callback function for opening the queue file    */
 void selectconfigCB();     /* Callback function for reading a new config file */
 void selectqueueCB();      /* Callback function for selecting a queue entry   */
+void readtleCB();          /* Callback function for tracking a satellite      */
 
 /* Telescope functions */
 
@@ -222,6 +227,7 @@ void clear_telescope_model(void);   /* Set model parameters to zero */
 void recall_telescope_model(void);  /* Recall saved model from the status directory */
 void save_telescope_model(void);    /* Save model in the status directory */
 void default_telescope_model(void); /* Use the default model */
+void sync_telescope_model(void);    /* Add a sync point to the model terms */
 
 /* Message area display */
 
@@ -232,6 +238,9 @@ void show_message();                  /* Update message area with string message
 void save_coordinates();                /* Save a log entry and add to the history */
 void recall_coordinates();              /* Read the next previous history entry */
 void read_queue();                      /* Read queue file into memory */
+void show_queue();                      /* Label the queue list */
+int  check_queue(int window);           /* Find observable queue entries */
+void read_weather(void);                /* Update temperature and pressure */
 
 /* User interface RA and Dec direct entry */
 
@@ -244,6 +253,8 @@ void link_fifos();                      /* Startup fifo link routine */
 void unlink_fifos();                    /* Shutdown fifo link routine */
 void mark_xephem_telescope();           /* Export telescope coordinates to XEphem */
 void read_xephem_target();              /* Read target coordinates from XEphem goto fifo */
+void xephem_target_input(int fd, void *arg);  /* Event loop handler for the goto fifo */
+void transport_input(XtPointer client_data, int *source, XtInputId *id);
 void mark_xephem_target();              /* Export target coordinates to XEphem */
 
 /* Startup and shutdown */
@@ -273,6 +284,7 @@ extern void CenterGuide(double centerra, double centerdec,
   int raflag, int decflag, int pmodel);
 extern void StopTrack(void);
 extern void FullStop(void);
+extern int  TrackSatellite(char *line1, char *line2);
 
 /* Celestial coordinate read, write, and go to */
 
@@ -280,6 +292,14 @@ extern void GetTel(double *telra, double *teldec, int pmodel);
 extern int  GoToCoords(double newRA, double newDec, int pmodel);
 extern int  CheckGoTo(double desRA, double desDec, int pmodel);
 
+/* Pointing corrections and the fit of the mount model terms */
+
+extern void PointingToTel(double *telra0, double *teldec0, 
+  double telra1, double teldec1, int pmodel);
+extern void ModelClear(void);
+extern int  ModelSync(double telra, double teldec, double ra, double dec);
+extern int  ModelWrite(FILE *outfile);
+extern int  ModelRead(FILE *infile);
 
 /* Corrections for proper motion, precession, aberration, and nutation */
 
@@ -289,6 +309,16 @@ extern void PrecessToEpoch(double epoch, double  *ra, double  *dec);
 extern void ProperMotion(double epoch, double *ra, double *dec, 
   double pm_ra, double pm_dec); 
 extern void TestAlgorithms(void);
+extern void ApparentBatch(double *ra, double *dec, int n, int dirflag);
+
+/* Horizon mask and visibility of the queue */
+
+extern void HorizonClear(void);
+extern void HorizonPoint(double az, double alt);
+extern int  VisibleBatch(double *ra, double *dec, int n, double lst, 
+  double minalt, unsigned char *visible);
+extern int  ObservableBatch(double *ra, double *dec, int n, double lst, 
+  double hours, double minalt, double *rises);
 
 /* Time from the computer system processed by the algorithms package */
 
@@ -426,6 +456,19 @@ typedef struct                         /* catalog structure assuming EOD */
 /* History is indexed from 1 for first entry, so 0th entry is not used. */
 
 catalog queue[10001];                  /* This holds the observing queue */
+double queuera[10001];                 /* Queue ra as an array for batch use */
+double queuedec[10001];                /* Queue dec as an array for batch use */
+
+/* Observability of the queue entries */
+/* Apparent coordinates are updated with the window every minute */
+
+double queueappra[10001];              /* Apparent ra of the queue entries */
+double queueappdec[10001];             /* Apparent dec of the queue entries */
+double queuerises[10001];              /* Hours until visible or -1 */
+unsigned char queuenow[10001];         /* Visible now */
+char queuemark[10001];                 /* Mark shown in the queue list */
+double queueminalt = QUEUEMINALT;      /* Lowest observable altitude */
+double queuehours = QUEUEHOURS;        /* Window ahead for rising targets */
 catalog history[101];                  /* This holds the saved coordinates */
 
 /* Flags */
@@ -1026,15 +1069,31 @@ int main(argc,argv)
   XtUnmanageChild(XmSelectionBoxGetChild(select_configfile,
     XmDIALOG_HELP_BUTTON));
 
+  /* Create a dialog to select two-line elements but leave it unmanaged */
+
+  ac=0;
+  XtSetArg(al[ac],XmNmustMatch,True); ac++;
+  XtSetArg(al[ac],XmNautoUnmanage,False); ac++;
+  read_tlefile=XmCreateFileSelectionDialog(toplevel,"read_tlefile",al,ac);
+  XtAddCallback (read_tlefile, XmNokCallback, readtleCB, (XtPointer) OK);
+  XtAddCallback (read_tlefile, XmNcancelCallback, readtleCB, (XtPointer) CANCEL);
+  XtUnmanageChild(XmSelectionBoxGetChild(read_tlefile,
+    XmDIALOG_HELP_BUTTON));
+
   /* Create the menubar */
   
   create_menus(menu_bar);  
   
-  /* Connect to XEphem's goto fifo */
+  /* Connect to XEphem's goto fifo through the transport event loop */
 
   if (fd_fifo_in > 0)
-      XtAppAddInput (context, fd_fifo_in, (XtPointer)XtInputReadMask,
-        read_xephem_target, NULL);          
+      TransportWatch(fd_fifo_in, xephem_target_input, NULL);
+
+  /* Service the event loop whenever one of its descriptors is ready */
+
+  if (TransportOpen() >= 0)
+      XtAppAddInput (context, TransportOpen(), (XtPointer)XtInputReadMask,
+        transport_input, NULL);
 
   /* Create unmanaged control panels */
 
@@ -1123,6 +1182,7 @@ void create_menus(Widget menu_bar)
   newqueue_item=make_menu_item("New Queue",NEWQUEUE,file_menu); 
   newlog_item=make_menu_item("New Log",NEWLOG,file_menu); 
   newconfig_item=make_menu_item("New Config",NEWCONFIG,file_menu);
+  satellite_item=make_menu_item("Track Satellite",TRACKSATELLITE,file_menu);
   exit_item=make_menu_item("Exit XmTel",EXIT,file_menu);
 
   /* Create the edit menu */
@@ -1137,6 +1197,7 @@ void create_menus(Widget menu_bar)
   p_options_toggle_2  = make_menu_toggle("Refraction",POINTOPTION2,pointing_menu);
   p_options_toggle_4  = make_menu_toggle("Polar",POINTOPTION4,pointing_menu);
   p_options_toggle_8  = make_menu_toggle("Model",POINTOPTION8,pointing_menu);
+  p_options_toggle_16 = make_menu_toggle("Terms",POINTOPTION16,pointing_menu);
 
   /* Create the reference pull-down menu */
   ref_menu            = make_menu("Reference",menu_bar);
@@ -1154,6 +1215,7 @@ void create_menus(Widget menu_bar)
   model_save_item       = make_menu_item("Save",MODELSAVE,model_menu);
   model_recall_item     = make_menu_item("Recall",MODELRECALL,model_menu);
   model_default_item    = make_menu_item("Default",MODELDEFAULT,model_menu);
+  model_sync_item       = make_menu_item("Sync",MODELSYNC,model_menu);
  
 }
 
@@ -1191,6 +1253,15 @@ void menuCB(w,client_data,call_data)
     
     XtManageChild(select_configfile);
   }     
+
+  /* if request to track a satellite detected, then select its elements */
+
+  if (client_data==TRACKSATELLITE)
+  {
+    /* make the elements file dialog appear */
+    
+    XtManageChild(read_tlefile);
+  }
   
   /* if exit detected, then save last location and exit cleanly */
   
@@ -1299,6 +1370,21 @@ void menuCB(w,client_data,call_data)
     mark_xephem_telescope();
   }         
 
+  if (client_data==POINTOPTION16)
+  {
+    if( XmToggleButtonGetState(p_options_toggle_16) )
+    {
+      pmodel=(pmodel | TERMS);
+    }
+    else
+    {
+      pmodel=(pmodel & ~(TERMS));
+    }  
+    fetch_telescope_coordinates(); 
+    show_telescope_coordinates(); 
+    mark_xephem_telescope();
+  }         
+
   /* If reference to target detected, then update offset */
 
   if (client_data==REFTARGET)
@@ -1416,6 +1502,16 @@ void menuCB(w,client_data,call_data)
     show_telescope_coordinates(); 
     mark_xephem_telescope();
   } 
+
+  /* If model sync detected, add the target as a sync point */
+
+  if (client_data==MODELSYNC)
+  {
+    sync_telescope_model();
+    fetch_telescope_coordinates(); 
+    show_telescope_coordinates(); 
+    mark_xephem_telescope();
+  } 
   
            
   /* Else noop */   
@@ -2086,6 +2182,70 @@ void readqueueCB(w,client_data,call_data)
 }    
 
 
+/* Callback function for selecting two-line elements and tracking the pass */
+/* The first lines in the file that begin with 1 and 2 are the elements    */
+
+void readtleCB(w,client_data,call_data)
+  Widget w;
+  int client_data;
+  XmAnyCallbackStruct *call_data;
+{
+  XmFileSelectionBoxCallbackStruct *s =
+      (XmFileSelectionBoxCallbackStruct *) call_data;
+  char *tlefile;
+  char line[128], line1[128], line2[128];
+  FILE *fp_tle;
+  
+  /* Do nothing if cancel is selected. */
+  if (client_data==CANCEL) 
+  {
+    XtUnmanageChild(read_tlefile);
+    return;
+  }
+
+  /* Get the filename from the file selection box */
+  XmStringGetLtoR(s->value, char_set, &tlefile);
+  XtUnmanageChild(read_tlefile);
+
+  fp_tle = fopen(tlefile, "r");
+  XtFree(tlefile);
+  if (fp_tle == NULL)
+  {
+    strcpy(message,"Cannot read the satellite elements\n");
+    show_message();
+    return;
+  }
+  
+  line1[0] = '\0';
+  line2[0] = '\0';
+  while (fgets(line, sizeof(line), fp_tle) != NULL)
+  {
+    if ( (line[0] == '1') && (line[1] == ' ') && (line1[0] == '\0') )
+    {
+      strcpy(line1, line);
+    }
+    else if ( (line[0] == '2') && (line[1] == ' ') && (line1[0] != '\0') )
+    {
+      strcpy(line2, line);
+      break;
+    }
+  }
+  fclose(fp_tle);
+  
+  /* The driver finds the next pass, goes to it, and tracks it to the end */
+
+  if ( (line2[0] != '\0') && TrackSatellite(line1, line2) )
+  {
+    strcpy(message,"Tracking the satellite pass\n");
+  }
+  else
+  {
+    strcpy(message,"No satellite pass to track\n");
+  }
+  show_message();
+}
+
+
 /* Callback function for selecting a queue entry */
 
 void selectqueueCB(w,client_data,call_data)
@@ -2271,6 +2431,17 @@ void poll_interval_handler(XtPointer client_data_ptr, XtIntervalId *client_id)
      check_slew_status();
   } 
   
+  /* Mark observable queue entries and look ahead once a minute */
+  
+  check_queue(tcount == 2);
+  
+  /* Follow the weather for refraction once a minute */
+  
+  if (tcount == 3)
+  {
+    read_weather();
+  }
+  
   /* Update the precision guiding option */
   
   if ( guideflag == TRUE )
@@ -2531,6 +2702,7 @@ void save_telescope_model()
     return;
   }
   fprintf(outfile, "%lf %lf\n", modelha1, modeldec1);      
+  ModelWrite(outfile);
   fclose(outfile);
 }
  
@@ -2554,6 +2726,13 @@ void recall_telescope_model()
     modelha0 = (LSTNow() - telra);    
     modeldec0 = teldec;
   }
+  
+  /* Files from before the model terms end here */
+  
+  if (ModelRead(infile) >= 0)
+  {
+    fprintf(stderr, "Recalled mount model terms\n");
+  }
   fclose(infile);
 }
   
@@ -2577,11 +2756,66 @@ void clear_telescope_model(void)
   modelha1  = 0.;
   modeldec0 = 0.;
   modeldec1 = 0.;
+  ModelClear();
   
   fprintf(stderr,"Model parameters cleared\n");
   return;
 }
 
+/* Update the site temperature and pressure from the status files      */
+/* The refraction tables are rebuilt when they change enough           */
+
+void read_weather(void)
+{
+  FILE* infile;
+  double tmpvalue;
+  
+  infile = fopen(WEATHERTEMPERATUREFILE, "r");
+  if ( infile != NULL )
+  {
+    if (fscanf(infile, "%lf", &tmpvalue) == 1)
+    {
+      SiteTemperature = tmpvalue;
+    }
+    fclose(infile);
+  }
+  
+  infile = fopen(PRESSUREFILE, "r");
+  if ( infile != NULL )
+  {
+    if (fscanf(infile, "%lf", &tmpvalue) == 1)
+    {
+      SitePressure = tmpvalue;
+    }
+    fclose(infile);
+  }
+}
+
+/* Add the current target as a sync point for the mount model terms    */
+/* The telescope is assumed to be centered on the target              */
+/* The terms are fitted to the raw coordinates against the pointing    */
+/*   the target would have with the other corrections in use          */
+
+void sync_telescope_model(void)
+{
+  double rawra, rawdec, tmpra, tmpdec;
+  int npoints;
+  
+  if (CheckConnectTel() == FALSE)
+  {
+    return;
+  }
+  
+  GetTel(&rawra, &rawdec, RAW);
+  PointingToTel(&tmpra, &tmpdec, targetra, targetdec, (pmodel & ~(TERMS)));
+  npoints = ModelSync(rawra, rawdec, tmpra, tmpdec);
+  
+  sprintf(message, "Sync point %d added to the mount model\n", npoints);
+  show_message();
+  fprintf(stderr, "Sync: Raw RA %lf  Dec %lf  Target RA %lf  Dec %lf\n",
+    rawra, rawdec, targetra, targetdec);
+}
+
 
 /* Export current telescope coordinates to XEphem */
 
@@ -2644,6 +2878,20 @@ void mark_xephem_target()
   write(fd_fifo_out, outbuf, strlen(outbuf));
 }
 
+/* Dispatch ready descriptors from the Xt main loop */
+
+void transport_input(XtPointer client_data, int *source, XtInputId *id)
+{
+  TransportDispatch(0);
+}
+
+/* Event loop handler for the XEphem goto fifo */
+
+void xephem_target_input(int fd, void *arg)
+{
+  read_xephem_target();
+}
+
 /* Read XEphem goto fifo and parse target coordinates */
 
 void read_xephem_target() 
@@ -2975,9 +3223,6 @@ void read_queue()
   int success;
   double rahr,ramin,rasec;
   double decdeg,decmin,decsec;
-
-  Arg al[10];
-  int ac;
   
   strcpy(message,"Reading the queue ");
   strcat(message,queuefile);
@@ -3151,12 +3396,42 @@ void read_queue()
   /* Increment nqueue so that it now reads the number of entries to the queue */
   
   nqueue++;
+  
+  /* Keep the coordinates as arrays for whole queue transformations */
+  
+  for (i=0; i < nqueue; i++)
+  {
+    queuera[i] = queue[i].ra;
+    queuedec[i] = queue[i].dec;
+    queuemark[i] = ' ';
+  }
+
+  /* Find what is observable and label the list if that has not been done */
+  
+  if (!check_queue(TRUE))
+  {
+    show_queue();
+  }
+}
+
+
+/* Label the queue list with a mark for observability */
+/*   '*' is above the horizon now                     */
+/*   '+' rises within queuehours                      */
 
+void show_queue()
+{
+  char buf[100];
+  int i;
+  Arg al[10];
+  int ac;
+  
   XmStringTable queue_list =
         (XmStringTable) XtMalloc ( nqueue * sizeof (XmString) ); 
   for (i=0; i < nqueue; i++)
   {
-    queue_list[i] = XmStringCreateLocalized (queue[i].name); 
+    snprintf(buf, sizeof(buf), "%c %s", queuemark[i], queue[i].name);
+    queue_list[i] = XmStringCreateLocalized (buf); 
   }
   ac=0; 
   XtSetArg(al[ac],XmNitemCount,nqueue); ac++; 
@@ -3167,7 +3442,64 @@ void read_queue()
     XmStringFree(queue_list[i]);
   }
   free(queue_list);
+}
+
 
+/* Find the observable queue entries against the horizon mask       */
+/* Visibility now is found on every call for the whole queue        */
+/* With window TRUE also update the apparent coordinates and look   */
+/*   ahead queuehours for entries that will rise                    */
+/* Relabel the list only when a mark has changed and return TRUE   */
+
+int check_queue(int window)
+{
+  double lst;
+  char mark;
+  int i, changed;
+  
+  if (nqueue <= 0)
+  {
+    return (FALSE);
+  }
+  
+  lst = LSTNow();
+  
+  if (window)
+  {
+    memcpy(queueappra, queuera, nqueue*sizeof(double));
+    memcpy(queueappdec, queuedec, nqueue*sizeof(double));
+    ApparentBatch(queueappra, queueappdec, nqueue, 1);
+    ObservableBatch(queueappra, queueappdec, nqueue, lst, 
+      queuehours, queueminalt, queuerises);
+  }
+  
+  VisibleBatch(queueappra, queueappdec, nqueue, lst, queueminalt, queuenow);
+  
+  changed = FALSE;
+  for (i = 0; i < nqueue; i++)
+  {
+    mark = ' ';
+    if (queuenow[i])
+    {
+      mark = '*';
+    }
+    else if (queuerises[i] >= 0.)
+    {
+      mark = '+';
+    }
+    if (mark != queuemark[i])
+    {
+      queuemark[i] = mark;
+      changed = TRUE;
+    }
+  }
+  
+  if (changed)
+  {
+    show_queue();
+  }
+  
+  return (changed);
 }
 
 
@@ -3301,7 +3633,10 @@ void link_fifos()
 void unlink_fifos()
 {
   if (fd_fifo_in!=-1)
+  {
+    TransportUnwatch(fd_fifo_in);
     close(fd_fifo_in);
+  }
   if (fd_fifo_out!=-1)
     close(fd_fifo_out);  
 }
@@ -3395,6 +3730,8 @@ void dtodms (char *outstr, double *dmsp)
 /*   parkha                                      */
 /*   parkdec                                     */
 /*   telserial                                   */
+/*   horizon mask                                */
+/*   queue minimum altitude and hours ahead      */
 
 /* Requires configfile defined and allocated     */
 
@@ -3404,6 +3741,8 @@ void read_config(void)
   char configstr[121];
   char *configptr = configstr;
   int n;
+  int horizonread = FALSE;
+  double horizonaz, horizonalt;
       
   fp_config = fopen(configfile, "r");
 
@@ -3647,6 +3986,54 @@ void read_config(void)
       }
     }
     
+    /* Each site.horizon line adds a vertex az alt to the horizon mask */
+    /* The first one in this file replaces any mask read before       */
+    
+    configptr = strstr(configstr,"site.horizon");
+    if ( configptr != NULL)
+    {
+      configptr = strstr(configstr,"=");
+      if ( configptr != NULL)
+      {
+        configptr = configptr + 1;
+        if (sscanf(configptr,"%lf %lf",&horizonaz,&horizonalt) == 2)
+        {
+          if (!horizonread)
+          {
+            HorizonClear();
+            horizonread = TRUE;
+          }
+          HorizonPoint(horizonaz, horizonalt);
+          fprintf(stderr,"Horizon at azimuth %lf: %lf\n",
+            horizonaz,horizonalt);
+        }
+      }
+    }
+    
+    configptr = strstr(configstr,"queue.minalt");
+    if ( configptr != NULL)
+    {
+      configptr = strstr(configstr,"=");
+      if ( configptr != NULL)
+      {
+        configptr = configptr + 1;
+        sscanf(configptr,"%lf",&queueminalt);
+        fprintf(stderr,"Queue minimum altitude: %lf\n",queueminalt);
+      }
+    }
+    
+    configptr = strstr(configstr,"queue.hours");
+    if ( configptr != NULL)
+    {
+      configptr = strstr(configstr,"=");
+      if ( configptr != NULL)
+      {
+        configptr = configptr + 1;
+        sscanf(configptr,"%lf",&queuehours);
+        fprintf(stderr,"Queue hours ahead: %lf\n",queuehours);
+      }
+    }
+    
     configptr = strstr(configstr,"ccd.arcsecperpix");
     if ( configptr != NULL)
     {
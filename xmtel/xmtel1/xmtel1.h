@@ -55,12 +55,31 @@
 #define MODELSAVE      20
 #define MODELRECALL    21
 #define MODELDEFAULT   22
+#define POINTOPTION16  23
+#define MODELSYNC      24
+#define TRACKSATELLITE 25
 
 /* Target input flags */
 
 #define RA        1               
 #define DEC       2               
 
+/* Pointing model of the fitted mount terms, added to those of the driver */
+
+#define TERMS    16      /* Correct with the fitted mount model terms */
+
+/* Mount model terms fitted from sync points, in arcseconds with TPOINT signs */
+
+#define MODELTERMS 8     /* Number of terms */
+#define TERMIH    0      /* Index error in hour angle */
+#define TERMID    1      /* Index error in declination */
+#define TERMCH    2      /* Collimation error */
+#define TERMNP    3      /* Non-perpendicularity of the axes */
+#define TERMMA    4      /* Polar axis misalignment left to right */
+#define TERMME    5      /* Polar axis misalignment vertically */
+#define TERMTF    6      /* Tube flexure */
+#define TERMFO    7      /* Fork flexure */
+
 /* Configuration file */
 
 #define CONFIGFILE "/usr/local/observatory/prefs/prefs.tel"
@@ -93,6 +112,17 @@
 #define TELSERIAL     "/dev/ttyUSB0"
 #define ARCSECPERPIX  0.54
 
+/* Weather for refraction read once a minute when these files are present */
+/* The temperature is of the outside air and not of the telescope sensor  */
+
+#define WEATHERTEMPERATUREFILE "/usr/local/observatory/status/weathertemperature"
+#define PRESSUREFILE "/usr/local/observatory/status/telpressure"
+
+/* Queue observability shown in the queue list and modified by prefs file */
+
+#define QUEUEMINALT    10.0    /* Lowest altitude counted as observable */
+#define QUEUEHOURS      4.0    /* Hours ahead to look for rising targets */
+
 
 
 /* Moore Observatory - Louisville, Kentucky USA */